@@ -1,61 +1,9 @@
 #include "Public/2D/Vector2D.h"
 
-//--------------------- Basic Operator overloads ----------------------------
+//--------------------- Explicit instantiations -----------------------------
+// Everything is defined in the header. Instantiating both precisions here
+// makes sure every member compiles for each of them
+//---------------------------------------------------------------------------
 
-const Vector2D& Vector2D::operator+=(const Vector2D& rhs)
-{
-	x += rhs.x;
-	y += rhs.y;
-
-	return *this;
-}
-
-const Vector2D& Vector2D::operator-=(const Vector2D& rhs)
-{
-	x -= rhs.x;
-	y -= rhs.y;
-
-	return *this;
-}
-
-const Vector2D& Vector2D::operator*=(const double& rhs)
-{
-	x *= rhs;
-	y *= rhs;
-
-	return *this;
-}
-
-const Vector2D& Vector2D::operator/=(const double& rhs)
-{
-	x /= rhs;
-	y /= rhs;
-
-	return *this;
-}
-
-const Vector2D& Vector2D::operator/=(const Vector2D& rhs)
-{
-	x /= rhs.x;
-	y /= rhs.y;
-
-	return *this;
-}
-
-const Vector2D& Vector2D::operator*=(const Vector2D& rhs)
-{
-	x *= rhs.x;
-	y *= rhs.y;
-
-	return *this;
-}
-
-bool Vector2D::operator==(const Vector2D& rhs)
-{
-	return IsEqual(x, rhs.x) && IsEqual(y, rhs.y);
-}
-
-bool Vector2D::operator!=(const Vector2D& rhs)
-{
-	return (x != rhs.x) && (y != rhs.y);
-}
+template struct Vector2DT<double>;
+template struct Vector2DT<float>;
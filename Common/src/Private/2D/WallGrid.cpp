@@ -0,0 +1,175 @@
+#include "Public/2D/WallGrid.h"
+#include "Public/Misc/Utils.h"
+
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+
+//----------------------------- SegmentTouchesBox ------------------------
+// Liang-Barsky clipping: true if any part of the segment from a to b lies
+// inside the box
+//------------------------------------------------------------------------
+
+static bool SegmentTouchesBox(const Vector2D& a, const Vector2D& b, double left, double top, double right, double bottom)
+{
+	const double d[2] = { b.x - a.x, b.y - a.y };
+	const double lo[2] = { left - a.x, top - a.y };
+	const double hi[2] = { right - a.x, bottom - a.y };
+
+	double tMin = 0.0;
+	double tMax = 1.0;
+
+	for (int axis = 0; axis < 2; ++axis)
+	{
+		if (d[axis] == 0.0)
+		{
+			// Parallel to this pair of sides, so it's either between them or not
+			if (lo[axis] > 0.0 || hi[axis] < 0.0) return false;
+		}
+		else
+		{
+			double t0 = lo[axis] / d[axis];
+			double t1 = hi[axis] / d[axis];
+
+			if (t0 > t1) std::swap(t0, t1);
+
+			tMin = std::max(tMin, t0);
+			tMax = std::min(tMax, t1);
+
+			if (tMin > tMax) return false;
+		}
+	}
+
+	return true;
+}
+
+//----------------------------- ctor -------------------------------------
+
+WallGrid::WallGrid()
+	:m_iNumCellsX(1),
+	m_iNumCellsY(1),
+	m_dCellSize(1.0),
+	m_cellStart(2, 0)
+{
+}
+
+//----------------------------- CellCoord --------------------------------
+
+int WallGrid::CellCoord(double coord, int numCells) const
+{
+	int c = (int)std::floor(coord / m_dCellSize);
+
+	if (c < 0) return 0;
+	if (c > numCells - 1) return numCells - 1;
+
+	return c;
+}
+
+//----------------------------- CellRange --------------------------------
+
+void WallGrid::CellRange(const Vector2D& a, const Vector2D& b, int& minX, int& maxX, int& minY, int& maxY) const
+{
+	minX = CellCoord(std::min(a.x, b.x), m_iNumCellsX);
+	maxX = CellCoord(std::max(a.x, b.x), m_iNumCellsX);
+	minY = CellCoord(std::min(a.y, b.y), m_iNumCellsY);
+	maxY = CellCoord(std::max(a.y, b.y), m_iNumCellsY);
+}
+
+//----------------------------- Build ------------------------------------
+// A counting sort, as in CellSpacePartition::Rebuild. The first pass counts
+// the walls in each cell and the second writes them out, so walls are
+// listed in ascending order within every cell
+//------------------------------------------------------------------------
+
+void WallGrid::Build(const std::vector<Wall2D>& walls, double width, double height, double cellSize)
+{
+	assert(cellSize > 0.0 && "<WallGrid::Build>: the cells must have a size");
+
+	m_dCellSize = cellSize;
+	m_iNumCellsX = std::max(1, (int)std::ceil(width / cellSize));
+	m_iNumCellsY = std::max(1, (int)std::ceil(height / cellSize));
+
+	const size_t numCells = (size_t)m_iNumCellsX * m_iNumCellsY;
+
+	// The cells a wall passes through, as pairs of wall and cell. A long
+	// diagonal wall misses most of the cells in its bounding box
+	std::vector<std::pair<int, int>> entries;
+
+	// Leave some slack so walls lying along a cell boundary go in both cells
+	const double slack = cellSize * 1e-6;
+
+	for (unsigned int w = 0; w < walls.size(); ++w)
+	{
+		const Vector2D& from = walls[w].From();
+		const Vector2D& to = walls[w].To();
+
+		int minX, maxX, minY, maxY;
+		CellRange(from, to, minX, maxX, minY, maxY);
+
+		for (int y = minY; y <= maxY; ++y)
+		{
+			for (int x = minX; x <= maxX; ++x)
+			{
+				// The edge cells also hold anything beyond the grid
+				const double left = x == 0 ? -MaxDouble : x * cellSize - slack;
+				const double right = x == m_iNumCellsX - 1 ? MaxDouble : (x + 1) * cellSize + slack;
+				const double top = y == 0 ? -MaxDouble : y * cellSize - slack;
+				const double bottom = y == m_iNumCellsY - 1 ? MaxDouble : (y + 1) * cellSize + slack;
+
+				if (SegmentTouchesBox(from, to, left, top, right, bottom))
+				{
+					entries.push_back(std::make_pair((int)w, x + y * m_iNumCellsX));
+				}
+			}
+		}
+	}
+
+	m_cellStart.assign(numCells + 1, 0);
+
+	for (unsigned int e = 0; e < entries.size(); ++e)
+	{
+		++m_cellStart[entries[e].second + 1];
+	}
+
+	for (size_t c = 0; c < numCells; ++c)
+	{
+		m_cellStart[c + 1] += m_cellStart[c];
+	}
+
+	m_walls.resize(entries.size());
+
+	std::vector<int> next(m_cellStart.begin(), m_cellStart.end() - 1);
+
+	for (unsigned int e = 0; e < entries.size(); ++e)
+	{
+		m_walls[next[entries[e].second]++] = entries[e].first;
+	}
+}
+
+//----------------------------- Candidates -------------------------------
+//------------------------------------------------------------------------
+
+void WallGrid::Candidates(const Vector2D& a, const Vector2D& b, std::vector<int>& candidates) const
+{
+	candidates.clear();
+
+	int minX, maxX, minY, maxY;
+	CellRange(a, b, minX, maxX, minY, maxY);
+
+	for (int y = minY; y <= maxY; ++y)
+	{
+		for (int x = minX; x <= maxX; ++x)
+		{
+			const int c = x + y * m_iNumCellsX;
+
+			candidates.insert(candidates.end(), m_walls.begin() + m_cellStart[c], m_walls.begin() + m_cellStart[c + 1]);
+		}
+	}
+
+	// A wall crossing several of the cells is listed in each of them
+	if (minX != maxX || minY != maxY)
+	{
+		std::sort(candidates.begin(), candidates.end());
+		candidates.erase(std::unique(candidates.begin(), candidates.end()), candidates.end());
+	}
+}
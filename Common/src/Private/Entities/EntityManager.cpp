@@ -8,27 +8,112 @@ EntityManager* EntityManager::Instance()
 	return &instance;
 }
 
-void EntityManager::RegisterEntity(BaseGameEntity* pNewEntity)
+void EntityManager::GrowTo(int index)
 {
-	assert(pNewEntity && "<EntityManager::RegisterEntity>: pNewEntity is null");
+	assert((index <= IndexMask) && "<EntityManager::GrowTo>: out of entity IDs");
+
+	const int oldSize = (int)m_slots.size();
 
-	m_EntityMap.insert(std::make_pair(pNewEntity->ID(), pNewEntity));
+	m_slots.resize(index + 1);
+
+	// Pushed in reverse, so the lowest index comes off the free list first
+	for (int i = index; i >= oldSize; --i)
+	{
+		m_slots[i].m_iNextFree = m_iFreeList;
+		m_iFreeList = i;
+	}
 }
 
-BaseGameEntity * EntityManager::GetEntityFromID(int id) const
+int EntityManager::CreateID()
 {
-	// Find the entity
-	EntityMap::const_iterator it = m_EntityMap.find(id);
+	if (m_iFreeList < 0)
+	{
+		GrowTo((int)m_slots.size());
+	}
+
+	const int index = m_iFreeList;
+	Slot& slot = m_slots[index];
+
+	m_iFreeList = slot.m_iNextFree;
+
+	slot.m_iNextFree = -1;
+	slot.m_bInUse = true;
+
+	++m_iNumInUse;
+
+	return MakeID(index, slot.m_iGeneration);
+}
+
+int EntityManager::CreateID(int requested)
+{
+	assert((requested >= 0) && "<EntityManager::CreateID>: invalid ID");
+
+	const int index = IndexOf(requested);
+
+	if (index >= (int)m_slots.size())
+	{
+		GrowTo(index);
+	}
+
+	Slot& slot = m_slots[index];
+
+	assert((!slot.m_bInUse && slot.m_iGeneration == GenerationOf(requested)) && "<EntityManager::CreateID>: ID already taken");
+
+	// Take the slot off the free list
+	for (int* pLink = &m_iFreeList; *pLink >= 0; pLink = &m_slots[*pLink].m_iNextFree)
+	{
+		if (*pLink == index)
+		{
+			*pLink = slot.m_iNextFree;
+			break;
+		}
+	}
 
-	// Assert that the entity is a member of the map
-	assert((it != m_EntityMap.cend()) && "<EntityManager::GetEntityFromID>: invalid ID");
+	slot.m_iNextFree = -1;
+	slot.m_bInUse = true;
+
+	++m_iNumInUse;
+
+	return requested;
+}
+
+void EntityManager::ReleaseID(int id)
+{
+	assert(IsValid(id) && "<EntityManager::ReleaseID>: invalid ID");
+
+	Slot& slot = m_slots[IndexOf(id)];
+
+	slot.m_pEntity = nullptr;
+	slot.m_bInUse = false;
+
+	--m_iNumInUse;
+
+	// A slot whose generations have run out is retired rather than risk
+	// an old ID matching again
+	if (slot.m_iGeneration == MaxGeneration)
+	{
+		slot.m_iGeneration = -1;
+		return;
+	}
+
+	++slot.m_iGeneration;
+
+	slot.m_iNextFree = m_iFreeList;
+	m_iFreeList = IndexOf(id);
+}
+
+void EntityManager::RegisterEntity(BaseGameEntity* pNewEntity)
+{
+	assert(pNewEntity && "<EntityManager::RegisterEntity>: pNewEntity is null");
+	assert(IsValid(pNewEntity->ID()) && "<EntityManager::RegisterEntity>: invalid ID");
 
-	return it->second;
+	m_slots[IndexOf(pNewEntity->ID())].m_pEntity = pNewEntity;
 }
 
 void EntityManager::RemoveEntity(BaseGameEntity* pEntity)
 {
 	assert(pEntity && "<EntityManager::RemoveEntity>: pEntity is null");
+	assert((GetEntityFromID(pEntity->ID()) == pEntity) && "<EntityManager::RemoveEntity>: entity not registered");
 
-	m_EntityMap.erase(m_EntityMap.find(pEntity->ID()));
+	m_slots[IndexOf(pEntity->ID())].m_pEntity = nullptr;
 }
@@ -4,20 +4,16 @@
 #include "Public/Time/CrudeTimer.h"
 #include "Public/Messaging/MessageTypes.h"
 #include "Public/Messaging/MessageDispatcher.h"
+#include "Public/Misc/Log.h"
 
-// #include "Public/Locations.h"
-
-#include <iostream>
-#include <set>
+#include <algorithm>
 
-using std::cout;
-using std::set;
+// #include "Public/Locations.h"
 
-#ifdef TEXTOUTPUT
-#include <fstream>
-extern std::ofstream os;
-#define cout os
-#endif
+MessageDispatcher::MessageDispatcher()
+	:m_dFrameTime(Clock->GetElapsedTime())
+{
+}
 
 MessageDispatcher* MessageDispatcher::Instance()
 {
@@ -31,81 +27,184 @@ void MessageDispatcher::Discharge(BaseGameEntity* pReceiver, const Telegram& msg
 	if (!pReceiver->HandleMessage(msg))
 	{
 		// Telegram could not be handled
-		cout << "Message could not be handled";
+		LOG_WARNING(ELogColor::ELC_Highlight, "Message could not be handled");
 	}
 }
 
-void MessageDispatcher::DispatchCustomMessage(double delay, int sender, int receiver, EMessageType msg, void* extraInfo)
+MessageDispatcher::SenderMailbox* MessageDispatcher::LocalMailbox()
 {
-	SetTextColor(BACKGROUND_RED | FOREGROUND_RED | FOREGROUND_GREEN | FOREGROUND_BLUE);
+	// The dispatcher is a singleton, so a single pointer per thread will do.
+	// A mailbox outlives its thread, so nothing posted to it is lost
+	thread_local SenderMailbox* t_pMailbox = nullptr;
 
-	// Get a pointer to the receiver and sender
-	BaseGameEntity* pSender = EntityMgr->GetEntityFromID(sender);
-	BaseGameEntity* pReceiver = EntityMgr->GetEntityFromID(receiver);
-
-	// Make sure the receiver is valid
-	if (pReceiver == nullptr)
+	if (t_pMailbox == nullptr)
 	{
-		cout << "\nWarning! No Receiver with ID of " << receiver << " found";
-		return;
+		std::lock_guard<std::mutex> lock(m_mailboxesMutex);
+
+		m_mailboxes.push_back(std::make_unique<SenderMailbox>());
+
+		t_pMailbox = m_mailboxes.back().get();
 	}
 
-	// Create the telegram
-	Telegram message(0, sender, receiver, msg, extraInfo);
+	return t_pMailbox;
+}
 
-	// If there is no delay, route telegram inmediately
-	if (delay <= 0.0f)
-	{
-		cout << "\nInstant telegram dispatched at time: " << Clock->GetElapsedTime()
-			<< " by " << GetNameOfEntity(pSender->ID()) << " for " << GetNameOfEntity(pReceiver->ID())
-			<< ". Msg is " << EMsgTypeToStr(msg);
+void MessageDispatcher::DispatchCustomMessage(double delay, int sender, int receiver, EMessageType msg, const TelegramPayload& extraInfo)
+{
+	SenderMailbox* pMailbox = LocalMailbox();
+
+	// Create the telegram. The receiver is looked up when it is delivered,
+	// as it may be gone by then anyway
+	Envelope envelope;
+	envelope.m_telegram = Telegram(0, sender, receiver, msg, extraInfo);
+	envelope.m_iSequence = pMailbox->m_iNextSequence++;
+
+	// A delayed telegram is due that long after the current frame. Any
+	// other is delivered at the end of it
+	envelope.m_bDelayed = delay > 0.0;
+	envelope.m_telegram.dispatchTime = m_dFrameTime.load(std::memory_order_relaxed) + (envelope.m_bDelayed ? delay : 0.0);
+
+	pMailbox->m_queue.Push(envelope);
+}
 
-		// send the telegram to the recipient
-		Discharge(pReceiver, message);
+void MessageDispatcher::GatherMailboxes()
+{
+	m_incoming.clear();
+
+	{
+		std::lock_guard<std::mutex> lock(m_mailboxesMutex);
+
+		for (size_t i = 0; i < m_mailboxes.size(); ++i)
+		{
+			m_mailboxes[i]->m_queue.Drain([this](const Envelope& envelope)
+			{
+				m_incoming.push_back(envelope);
+			});
+		}
 	}
-	else
+
+	std::sort(m_incoming.begin(), m_incoming.end(), [](const Envelope& a, const Envelope& b)
 	{
-		// Calculate the time when the telegram should be dispatched
-		double currentTime = Clock->GetElapsedTime();
+		if (a.m_telegram.dispatchTime != b.m_telegram.dispatchTime) return a.m_telegram.dispatchTime < b.m_telegram.dispatchTime;
+		if (a.m_telegram.sender != b.m_telegram.sender) return a.m_telegram.sender < b.m_telegram.sender;
 
-		message.dispatchTime = currentTime + delay;
+		return a.m_iSequence < b.m_iSequence;
+	});
+}
 
-		// and put the message into the queue
-		priorityQueue.insert(message);
+void MessageDispatcher::DeliverDue()
+{
+	std::sort(m_due.begin(), m_due.end(), [](const Envelope& a, const Envelope& b)
+	{
+		if (a.m_telegram.receiver != b.m_telegram.receiver) return a.m_telegram.receiver < b.m_telegram.receiver;
+		if (a.m_telegram.dispatchTime != b.m_telegram.dispatchTime) return a.m_telegram.dispatchTime < b.m_telegram.dispatchTime;
+		if (a.m_telegram.sender != b.m_telegram.sender) return a.m_telegram.sender < b.m_telegram.sender;
+
+		return a.m_iSequence < b.m_iSequence;
+	});
 
-		cout << "\nDelayed telegram from " << GetNameOfEntity(pSender->ID()) << " recorded at time "
-			<< Clock->GetElapsedTime() << " for " << GetNameOfEntity(pReceiver->ID())
-			<< ". Msg is " << EMsgTypeToStr(msg);
+	for (size_t first = 0, last = 0; first < m_due.size(); first = last)
+	{
+		const int receiver = m_due[first].m_telegram.receiver;
+
+		while (last < m_due.size() && m_due[last].m_telegram.receiver == receiver)
+		{
+			++last;
+		}
+
+		// Find the recipient once for its whole batch. It may have been
+		// removed since the telegrams were sent, in which case its ID has
+		// gone stale
+		BaseGameEntity* pReceiver = EntityMgr->GetEntityFromID(receiver);
+
+		if (pReceiver == nullptr)
+		{
+			LOG_WARNING(ELogColor::ELC_Highlight, "No Receiver with ID of {} found", receiver);
+			continue;
+		}
+
+		for (size_t i = first; i < last; ++i)
+		{
+			const Telegram& telegram = m_due[i].m_telegram;
+
+			if (m_due[i].m_bDelayed)
+			{
+				LOG_DEBUG(ELogColor::ELC_Highlight, "Queued telegram ready for dispatch: Sent to {}. Msg is {}",
+					GetNameOfEntity(receiver), EMsgTypeToStr(telegram.msg));
+			}
+			else
+			{
+				LOG_DEBUG(ELogColor::ELC_Highlight, "Instant telegram dispatched at time: {} by {} for {}. Msg is {}",
+					Clock->GetElapsedTime(), GetNameOfEntity(telegram.sender), GetNameOfEntity(receiver), EMsgTypeToStr(telegram.msg));
+			}
+
+			// Send the telegram to the receipient
+			Discharge(pReceiver, telegram);
+		}
 	}
 }
 
 void MessageDispatcher::DispatchDelayedMessages()
 {
-	SetTextColor(BACKGROUND_RED | FOREGROUND_RED | FOREGROUND_GREEN | FOREGROUND_BLUE);
-
 	// Get current time
-	double currentTime = Clock->GetElapsedTime();
-	
-	// Now peek at the queue to see if any telegrams need dispatching.
-	// Remove all telegrams from the front of the queue that have gone
-	// past their sell by date
-	while ( !priorityQueue.empty() &&
-			(priorityQueue.begin()->dispatchTime < currentTime) &&
-			(priorityQueue.begin()->dispatchTime > 0))
+	const double currentTime = Clock->GetElapsedTime();
+
+	// Anything sent from here on belongs to the next frame
+	m_dFrameTime.store(currentTime, std::memory_order_relaxed);
+
+	for (;;)
 	{
-		// Read the telegram from the front of the queue
-		const Telegram& telegram = *priorityQueue.begin();
+		GatherMailboxes();
+
+		m_due.clear();
+
+		for (size_t i = 0; i < m_incoming.size(); ++i)
+		{
+			const Envelope& envelope = m_incoming[i];
+
+			if (!envelope.m_bDelayed)
+			{
+				m_due.push_back(envelope);
+				continue;
+			}
 
-		// Find the recipient
-		BaseGameEntity* pReceiver = EntityMgr->GetEntityFromID(telegram.receiver);
+			// Put the message into the queue, unless it duplicates one that
+			// is already there
+			if (m_coalescer.Add(envelope.m_telegram))
+			{
+				m_delayedTelegrams.Schedule(envelope.m_telegram.dispatchTime, envelope);
+			}
 
-		cout << "\nQueued telegram ready for dispatch: Sent to "
-			<< GetNameOfEntity(pReceiver->ID()) << ". Msg is " << EMsgTypeToStr(telegram.msg);
+			LOG_DEBUG(ELogColor::ELC_Highlight, "Delayed telegram from {} recorded at time {} for {}. Msg is {}",
+				GetNameOfEntity(envelope.m_telegram.sender), currentTime, GetNameOfEntity(envelope.m_telegram.receiver), EMsgTypeToStr(envelope.m_telegram.msg));
+		}
 
-		// Send the telegram to the receipient
-		Discharge(pReceiver, telegram);
+		// Now add every telegram that has gone past its sell by date
+		m_delayedTelegrams.Advance(currentTime, [this](const Envelope& envelope)
+		{
+			m_coalescer.Remove(envelope.m_telegram);
 
-		// Remove it from the queue
-		priorityQueue.erase(priorityQueue.begin());
+			m_due.push_back(envelope);
+		});
+
+		// Once the receivers have stopped replying, the frame is done
+		if (m_due.empty()) return;
+
+		DeliverDue();
 	}
-}
\ No newline at end of file
+}
+
+//---------------------------- SetCoalescingPolicy ---------------------------
+// The coalescer forgets everything when its policy changes, so the messages
+// still waiting are recorded again under the new one
+//----------------------------------------------------------------------------
+
+void MessageDispatcher::SetCoalescingPolicy(ECoalescingPolicy policy, double windowLength)
+{
+	m_coalescer.SetPolicy(policy, windowLength);
+
+	m_delayedTelegrams.ForEach([this](const Envelope& envelope)
+	{
+		m_coalescer.Add(envelope.m_telegram);
+	});
+}
@@ -0,0 +1,173 @@
+#include "Public/Messaging/TelegramCoalescer.h"
+
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+
+static const size_t InitialTableSize = 64;
+
+//----------------------------- Mix ----------------------------------------
+// The splitmix64 finalizer, which spreads every input bit over the result
+//--------------------------------------------------------------------------
+
+static inline uint64_t Mix(uint64_t h)
+{
+	h ^= h >> 30;
+	h *= 0xbf58476d1ce4e5b9ULL;
+	h ^= h >> 27;
+	h *= 0x94d049bb133111ebULL;
+	h ^= h >> 31;
+
+	return h;
+}
+
+//----------------------------- ctor ---------------------------------------
+
+TelegramCoalescer::TelegramCoalescer(ECoalescingPolicy policy, double windowLength)
+	:m_table(InitialTableSize),
+	m_iCount(0),
+	m_policy(policy),
+	m_dWindowLength(windowLength)
+{
+	assert(windowLength > 0.0 && "<TelegramCoalescer::TelegramCoalescer>: windows must have a length");
+}
+
+//----------------------------- SetPolicy ----------------------------------
+
+void TelegramCoalescer::SetPolicy(ECoalescingPolicy policy, double windowLength)
+{
+	assert(windowLength > 0.0 && "<TelegramCoalescer::SetPolicy>: windows must have a length");
+
+	m_policy = policy;
+	m_dWindowLength = windowLength;
+
+	Clear();
+}
+
+//----------------------------- MakeKey ------------------------------------
+
+void TelegramCoalescer::MakeKey(const Telegram& telegram, Entry& entry) const
+{
+	entry.m_iSender = telegram.sender;
+	entry.m_iReceiver = telegram.receiver;
+	entry.m_msg = telegram.msg;
+	entry.m_iWindow = (long long)std::floor(telegram.dispatchTime / m_dWindowLength);
+
+	uint64_t h = Mix((uint64_t)(uint32_t)entry.m_iSender | ((uint64_t)(uint32_t)entry.m_iReceiver << 32));
+	h = Mix(h ^ (uint64_t)(unsigned short)entry.m_msg);
+	h = Mix(h ^ (uint64_t)entry.m_iWindow);
+
+	entry.m_iHash = h;
+}
+
+//----------------------------- Find ---------------------------------------
+// Linear probing from the slot the hash picks
+//--------------------------------------------------------------------------
+
+size_t TelegramCoalescer::Find(const Entry& key) const
+{
+	const size_t mask = m_table.size() - 1;
+
+	for (size_t i = (size_t)key.m_iHash & mask;; i = (i + 1) & mask)
+	{
+		const Entry& entry = m_table[i];
+
+		if (!entry.m_bUsed) return i;
+
+		if (entry.m_iHash == key.m_iHash &&
+			entry.m_iSender == key.m_iSender &&
+			entry.m_iReceiver == key.m_iReceiver &&
+			entry.m_msg == key.m_msg &&
+			entry.m_iWindow == key.m_iWindow)
+		{
+			return i;
+		}
+	}
+}
+
+//----------------------------- Grow ---------------------------------------
+
+void TelegramCoalescer::Grow()
+{
+	std::vector<Entry> old(m_table.size() * 2);
+	old.swap(m_table);
+
+	for (size_t i = 0; i < old.size(); ++i)
+	{
+		if (old[i].m_bUsed)
+		{
+			m_table[Find(old[i])] = old[i];
+		}
+	}
+}
+
+//----------------------------- Add ----------------------------------------
+
+bool TelegramCoalescer::Add(const Telegram& telegram)
+{
+	if (m_policy == ECoalescingPolicy::ECP_None) return true;
+
+	Entry key;
+	MakeKey(telegram, key);
+
+	const size_t slot = Find(key);
+
+	if (m_table[slot].m_bUsed) return false;
+
+	m_table[slot] = key;
+	m_table[slot].m_bUsed = true;
+
+	if (++m_iCount * 2 > m_table.size())
+	{
+		Grow();
+	}
+
+	return true;
+}
+
+//----------------------------- Remove -------------------------------------
+// Deletes without leaving a marker behind, by moving back any later entry
+// of the probe run that the hole would otherwise cut off from its home
+//--------------------------------------------------------------------------
+
+void TelegramCoalescer::Remove(const Telegram& telegram)
+{
+	if (m_policy == ECoalescingPolicy::ECP_None) return;
+
+	Entry key;
+	MakeKey(telegram, key);
+
+	size_t hole = Find(key);
+
+	if (!m_table[hole].m_bUsed) return;
+
+	const size_t mask = m_table.size() - 1;
+
+	for (size_t i = (hole + 1) & mask; m_table[i].m_bUsed; i = (i + 1) & mask)
+	{
+		const size_t home = (size_t)m_table[i].m_iHash & mask;
+
+		// The entry can fill the hole if its home isn't between the hole
+		// and where it is now
+		const bool homeInRange = hole <= i ? (hole < home && home <= i) : (hole < home || home <= i);
+
+		if (!homeInRange)
+		{
+			m_table[hole] = m_table[i];
+			hole = i;
+		}
+	}
+
+	m_table[hole] = Entry();
+
+	--m_iCount;
+}
+
+//----------------------------- Clear --------------------------------------
+
+void TelegramCoalescer::Clear()
+{
+	std::fill(m_table.begin(), m_table.end(), Entry());
+
+	m_iCount = 0;
+}
@@ -0,0 +1,112 @@
+#include "Public/Misc/Arena.h"
+
+#include <cassert>
+#include <cstdint>
+#include <algorithm>
+
+const size_t Arena::ChunkHeaderSize = (sizeof(Chunk) + alignof(std::max_align_t) - 1) & ~(alignof(std::max_align_t) - 1);
+
+//----------------------------- ctor -------------------------------
+
+Arena::Arena(size_t chunkSize)
+	:m_iChunkSize(chunkSize),
+	m_pFirst(nullptr),
+	m_pCurrent(nullptr),
+	m_pCursor(nullptr),
+	m_pEnd(nullptr),
+	m_pFinalizers(nullptr),
+	m_iBytesUsed(0)
+{
+}
+
+//----------------------------- dtor -------------------------------
+
+Arena::~Arena()
+{
+	Rewind();
+
+	while (m_pFirst)
+	{
+		Chunk* next = m_pFirst->m_pNext;
+
+		::operator delete(m_pFirst);
+
+		m_pFirst = next;
+	}
+}
+
+//----------------------------- Allocate ---------------------------
+
+void* Arena::Allocate(size_t size, size_t align)
+{
+	assert((align & (align - 1)) == 0 && "<Arena::Allocate>: alignment must be a power of two");
+
+	uintptr_t address = ((uintptr_t)m_pCursor + align - 1) & ~(uintptr_t)(align - 1);
+
+	if (!m_pCursor || address + size > (uintptr_t)m_pEnd)
+	{
+		NextChunk(size + align);
+
+		address = ((uintptr_t)m_pCursor + align - 1) & ~(uintptr_t)(align - 1);
+	}
+
+	m_iBytesUsed += (address + size) - (uintptr_t)m_pCursor;
+	m_pCursor = (char*)(address + size);
+
+	return (void*)address;
+}
+
+//----------------------------- NextChunk --------------------------
+
+void Arena::NextChunk(size_t size)
+{
+	// A chunk that was in use before the last rewind
+	Chunk* next = m_pCurrent ? m_pCurrent->m_pNext : m_pFirst;
+
+	if (!next || next->m_iSize < size)
+	{
+		const size_t chunkSize = std::max(m_iChunkSize, size);
+
+		// Through operator new rather than malloc, so anything that counts
+		// the program's allocations sees the arena's too
+		Chunk* chunk = static_cast<Chunk*>(::operator new(ChunkHeaderSize + chunkSize));
+
+		chunk->m_iSize = chunkSize;
+		chunk->m_pNext = next;
+
+		if (m_pCurrent)
+		{
+			m_pCurrent->m_pNext = chunk;
+		}
+		else
+		{
+			m_pFirst = chunk;
+		}
+
+		next = chunk;
+	}
+
+	m_pCurrent = next;
+	m_pCursor = (char*)next + ChunkHeaderSize;
+	m_pEnd = m_pCursor + next->m_iSize;
+}
+
+//----------------------------- Rewind -----------------------------
+
+void Arena::Rewind()
+{
+	while (m_pFinalizers)
+	{
+		Finalizer* finalizer = m_pFinalizers;
+
+		m_pFinalizers = finalizer->m_pPrev;
+
+		finalizer->m_pDestroy(finalizer->m_pObject);
+	}
+
+	m_pCurrent = nullptr;
+	m_pCursor = nullptr;
+	m_pEnd = nullptr;
+
+	m_iBytesUsed = 0;
+}
@@ -0,0 +1,259 @@
+#include "Public/Misc/Log.h"
+
+#include <chrono>
+#include <cstdio>
+#include <iostream>
+
+#ifndef HEADLESS
+#include "Public/Misc/ConsoleUtils.h"
+#endif
+
+//----------------------------- Instance ---------------------------
+
+Logger* Logger::Instance()
+{
+	static Logger instance;
+
+	return &instance;
+}
+
+//----------------------------- ctor -------------------------------
+// Each cell starts out ready for the producer whose position matches it
+//------------------------------------------------------------------
+
+Logger::Logger()
+	:m_cells(Capacity),
+	m_iEnqueuePos(0),
+	m_iDequeuePos(0),
+	m_iWritten(0),
+	m_iDropped(0),
+	m_bStop(false),
+	m_pOutput(&std::cout)
+{
+	for (size_t i = 0; i < Capacity; ++i)
+	{
+		m_cells[i].m_iSequence.store(i, std::memory_order_relaxed);
+	}
+
+	m_line.reserve(256);
+
+	m_writer = std::thread(&Logger::WriterLoop, this);
+}
+
+//----------------------------- dtor -------------------------------
+// Lets the writer drain what is left before stopping it
+//------------------------------------------------------------------
+
+Logger::~Logger()
+{
+	m_bStop.store(true, std::memory_order_release);
+
+	if (m_writer.joinable())
+	{
+		m_writer.join();
+	}
+
+	const size_t dropped = m_iDropped.load(std::memory_order_relaxed);
+
+	if (dropped > 0)
+	{
+		*m_pOutput.load() << "\n" << dropped << " log records were dropped because the buffer was full" << std::endl;
+	}
+}
+
+//----------------------------- Push -------------------------------
+// Claims the cell at the enqueue position and publishes the record in it
+// by moving its sequence on. A cell still waiting to be read means the
+// buffer is full
+//------------------------------------------------------------------
+
+void Logger::Push(ELogLevel level, ELogColor color, const char* format, const LogArg* args, int numArgs)
+{
+	size_t pos = m_iEnqueuePos.load(std::memory_order_relaxed);
+	Cell* cell;
+
+	for (;;)
+	{
+		cell = &m_cells[pos & (Capacity - 1)];
+
+		const size_t sequence = cell->m_iSequence.load(std::memory_order_acquire);
+		const intptr_t diff = (intptr_t)sequence - (intptr_t)pos;
+
+		if (diff == 0)
+		{
+			if (m_iEnqueuePos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) break;
+		}
+		else if (diff < 0)
+		{
+			m_iDropped.fetch_add(1, std::memory_order_relaxed);
+			return;
+		}
+		else
+		{
+			pos = m_iEnqueuePos.load(std::memory_order_relaxed);
+		}
+	}
+
+	Record& record = cell->m_record;
+	record.m_pFormat = format;
+	record.m_iNumArgs = (unsigned char)numArgs;
+	record.m_level = level;
+	record.m_color = color;
+
+	for (int i = 0; i < numArgs; ++i)
+	{
+		record.m_args[i] = args[i];
+	}
+
+	cell->m_iSequence.store(pos + 1, std::memory_order_release);
+}
+
+//----------------------------- Pop --------------------------------
+// Only the writer thread reads, so no compare and swap is needed here
+//------------------------------------------------------------------
+
+bool Logger::Pop(Record& record)
+{
+	const size_t pos = m_iDequeuePos.load(std::memory_order_relaxed);
+	Cell& cell = m_cells[pos & (Capacity - 1)];
+
+	if (cell.m_iSequence.load(std::memory_order_acquire) != pos + 1) return false;
+
+	record = cell.m_record;
+
+	cell.m_iSequence.store(pos + Capacity, std::memory_order_release);
+	m_iDequeuePos.store(pos + 1, std::memory_order_relaxed);
+
+	return true;
+}
+
+//----------------------------- WriteRecord ------------------------
+
+void Logger::WriteRecord(const Record& record)
+{
+	m_line.clear();
+
+	if (record.m_level == ELogLevel::ELL_Warning) m_line += "Warning! ";
+	else if (record.m_level == ELogLevel::ELL_Error) m_line += "ERROR! ";
+
+	char buffer[64];
+	int arg = 0;
+
+	for (const char* c = record.m_pFormat; *c; ++c)
+	{
+		if (c[0] != '{' || c[1] != '}' || arg == record.m_iNumArgs)
+		{
+			m_line += *c;
+			continue;
+		}
+
+		const LogArg& value = record.m_args[arg++];
+
+		switch (value.m_type)
+		{
+			case LogArg::EAT_Int:
+				std::snprintf(buffer, sizeof(buffer), "%lld", value.m_iValue);
+				m_line += buffer;
+				break;
+
+			case LogArg::EAT_Double:
+				std::snprintf(buffer, sizeof(buffer), "%g", value.m_dValue);
+				m_line += buffer;
+				break;
+
+			case LogArg::EAT_String:
+				m_line += value.m_pValue ? value.m_pValue : "(null)";
+				break;
+		}
+
+		++c;
+	}
+
+	m_line += '\n';
+
+	std::ostream* os = m_pOutput.load(std::memory_order_acquire);
+
+#ifndef HEADLESS
+	if (os == &std::cout)
+	{
+		switch (record.m_color)
+		{
+			case ELogColor::ELC_Red:
+				SetTextColor(FOREGROUND_RED | FOREGROUND_INTENSITY);
+				break;
+
+			case ELogColor::ELC_Green:
+				SetTextColor(FOREGROUND_GREEN | FOREGROUND_INTENSITY);
+				break;
+
+			case ELogColor::ELC_Highlight:
+				SetTextColor(BACKGROUND_RED | FOREGROUND_RED | FOREGROUND_GREEN | FOREGROUND_BLUE);
+				break;
+
+			default:
+				SetTextColor(FOREGROUND_RED | FOREGROUND_GREEN | FOREGROUND_BLUE);
+				break;
+		}
+	}
+#endif
+
+	os->write(m_line.data(), (std::streamsize)m_line.size());
+}
+
+//----------------------------- WriterLoop -------------------------
+// Writes records as they come in and flushes the stream whenever it runs
+// dry, sleeping a little while there is nothing to do
+//------------------------------------------------------------------
+
+void Logger::WriterLoop()
+{
+	Record record;
+
+	for (;;)
+	{
+		size_t written = 0;
+
+		while (Pop(record))
+		{
+			WriteRecord(record);
+			++written;
+		}
+
+		if (written > 0)
+		{
+			m_pOutput.load(std::memory_order_acquire)->flush();
+
+			m_iWritten.fetch_add(written, std::memory_order_release);
+
+			continue;
+		}
+
+		// Everything logged before the stop was requested has been written
+		if (m_bStop.load(std::memory_order_acquire)) return;
+
+		std::this_thread::sleep_for(std::chrono::milliseconds(1));
+	}
+}
+
+//----------------------------- SetOutput --------------------------
+// What was logged before is written to the old stream first
+//------------------------------------------------------------------
+
+void Logger::SetOutput(std::ostream* os)
+{
+	Flush();
+
+	m_pOutput.store(os, std::memory_order_release);
+}
+
+//----------------------------- Flush ------------------------------
+
+void Logger::Flush()
+{
+	const size_t target = m_iEnqueuePos.load(std::memory_order_acquire);
+
+	while (m_iWritten.load(std::memory_order_acquire) < target)
+	{
+		std::this_thread::yield();
+	}
+}
@@ -0,0 +1,266 @@
+#include "Public/Misc/Profiler.h"
+
+#include <chrono>
+#include <cstring>
+#include <iostream>
+
+//----------------------------- Instance ---------------------------
+
+Profiler* Profiler::Instance()
+{
+	static Profiler instance;
+
+	return &instance;
+}
+
+//----------------------------- ctor -------------------------------
+
+Profiler::Profiler()
+	:m_bTracing(false)
+{
+}
+
+//----------------------------- Now --------------------------------
+
+int64_t Profiler::Now()
+{
+	return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+//----------------------------- Register ---------------------------
+
+int Profiler::Register(std::vector<std::string>& names, int maxNames, const char* name)
+{
+	for (unsigned int i = 0; i < names.size(); ++i)
+	{
+		if (names[i] == name) return (int)i;
+	}
+
+	// Out of room. Anything recorded under this name is dropped
+	if ((int)names.size() == maxNames) return -1;
+
+	names.push_back(name);
+
+	return (int)names.size() - 1;
+}
+
+int Profiler::RegisterZone(const char* name)
+{
+	std::lock_guard<std::mutex> lock(m_mutex);
+
+	return Register(m_zoneNames, MaxZones, name);
+}
+
+int Profiler::RegisterCounter(const char* name)
+{
+	std::lock_guard<std::mutex> lock(m_mutex);
+
+	return Register(m_counterNames, MaxCounters, name);
+}
+
+//----------------------------- ThisThread -------------------------
+
+Profiler::ThreadData& Profiler::ThisThread()
+{
+	thread_local ThreadData* pData = nullptr;
+
+	if (!pData)
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+
+		std::unique_ptr<ThreadData> data(new ThreadData());
+		std::memset(data->m_zoneTime, 0, sizeof(data->m_zoneTime));
+		std::memset(data->m_zoneCalls, 0, sizeof(data->m_zoneCalls));
+		std::memset(data->m_counters, 0, sizeof(data->m_counters));
+		data->m_iThreadId = (int)m_threads.size();
+
+		pData = data.get();
+		m_threads.push_back(std::move(data));
+	}
+
+	return *pData;
+}
+
+//----------------------------- AddTime ----------------------------
+
+void Profiler::AddTime(int zone, int64_t start, int64_t end)
+{
+	if (zone < 0) return;
+
+	ThreadData& data = ThisThread();
+
+	data.m_zoneTime[zone] += end - start;
+	++data.m_zoneCalls[zone];
+
+	if (m_bTracing && data.m_trace.size() < MaxTraceEventsPerThread)
+	{
+		TraceEvent event;
+		event.m_iZone = zone;
+		event.m_iStart = start;
+		event.m_iEnd = end;
+
+		data.m_trace.push_back(event);
+	}
+}
+
+//----------------------------- AddCount ---------------------------
+
+void Profiler::AddCount(int counter, int64_t value)
+{
+	if (counter < 0) return;
+
+	ThisThread().m_counters[counter] += value;
+}
+
+//----------------------------- EndFrame ---------------------------
+
+void Profiler::EndFrame()
+{
+	FrameStats frame;
+	std::memset(&frame, 0, sizeof(frame));
+
+	for (unsigned int t = 0; t < m_threads.size(); ++t)
+	{
+		ThreadData& data = *m_threads[t];
+
+		for (int z = 0; z < MaxZones; ++z)
+		{
+			frame.m_zoneTime[z] += data.m_zoneTime[z];
+			frame.m_zoneCalls[z] += data.m_zoneCalls[z];
+		}
+
+		for (int c = 0; c < MaxCounters; ++c)
+		{
+			frame.m_counters[c] += data.m_counters[c];
+		}
+
+		std::memset(data.m_zoneTime, 0, sizeof(data.m_zoneTime));
+		std::memset(data.m_zoneCalls, 0, sizeof(data.m_zoneCalls));
+		std::memset(data.m_counters, 0, sizeof(data.m_counters));
+	}
+
+	m_frames.push_back(frame);
+}
+
+//----------------------------- Reset ------------------------------
+
+void Profiler::Reset()
+{
+	m_frames.clear();
+
+	for (unsigned int t = 0; t < m_threads.size(); ++t)
+	{
+		m_threads[t]->m_trace.clear();
+	}
+}
+
+//----------------------------- WriteCsv ---------------------------
+// One row per frame. Times are in microseconds
+//------------------------------------------------------------------
+
+void Profiler::WriteCsv(std::ostream& os) const
+{
+	os << "frame";
+
+	for (unsigned int z = 0; z < m_zoneNames.size(); ++z)
+	{
+		os << "," << m_zoneNames[z] << "_us," << m_zoneNames[z] << "_calls";
+	}
+
+	for (unsigned int c = 0; c < m_counterNames.size(); ++c)
+	{
+		os << "," << m_counterNames[c];
+	}
+
+	os << "\n";
+
+	for (unsigned int f = 0; f < m_frames.size(); ++f)
+	{
+		const FrameStats& frame = m_frames[f];
+
+		os << f;
+
+		for (unsigned int z = 0; z < m_zoneNames.size(); ++z)
+		{
+			os << "," << frame.m_zoneTime[z] / 1000.0 << "," << frame.m_zoneCalls[z];
+		}
+
+		for (unsigned int c = 0; c < m_counterNames.size(); ++c)
+		{
+			os << "," << frame.m_counters[c];
+		}
+
+		os << "\n";
+	}
+}
+
+//----------------------------- WriteJson --------------------------
+//------------------------------------------------------------------
+
+void Profiler::WriteJson(std::ostream& os) const
+{
+	os << "{\n  \"frames\": [";
+
+	for (unsigned int f = 0; f < m_frames.size(); ++f)
+	{
+		const FrameStats& frame = m_frames[f];
+
+		os << (f == 0 ? "\n" : ",\n") << "    { \"frame\": " << f << ", \"zones\": {";
+
+		for (unsigned int z = 0; z < m_zoneNames.size(); ++z)
+		{
+			os << (z == 0 ? " " : ", ") << "\"" << m_zoneNames[z] << "\": { \"us\": " << frame.m_zoneTime[z] / 1000.0
+				<< ", \"calls\": " << frame.m_zoneCalls[z] << " }";
+		}
+
+		os << " }, \"counters\": {";
+
+		for (unsigned int c = 0; c < m_counterNames.size(); ++c)
+		{
+			os << (c == 0 ? " " : ", ") << "\"" << m_counterNames[c] << "\": " << frame.m_counters[c];
+		}
+
+		os << " } }";
+	}
+
+	os << "\n  ]\n}\n";
+}
+
+//----------------------------- WriteChromeTrace -------------------
+// Complete events in the Trace Event Format, one track per thread
+//------------------------------------------------------------------
+
+void Profiler::WriteChromeTrace(std::ostream& os) const
+{
+	// Start the timeline at the first event
+	int64_t origin = INT64_MAX;
+
+	for (unsigned int t = 0; t < m_threads.size(); ++t)
+	{
+		if (!m_threads[t]->m_trace.empty() && m_threads[t]->m_trace.front().m_iStart < origin)
+		{
+			origin = m_threads[t]->m_trace.front().m_iStart;
+		}
+	}
+
+	os << "{ \"displayTimeUnit\": \"ns\", \"traceEvents\": [";
+
+	bool first = true;
+
+	for (unsigned int t = 0; t < m_threads.size(); ++t)
+	{
+		const std::vector<TraceEvent>& trace = m_threads[t]->m_trace;
+
+		for (unsigned int e = 0; e < trace.size(); ++e)
+		{
+			os << (first ? "\n" : ",\n")
+				<< "  { \"name\": \"" << m_zoneNames[trace[e].m_iZone] << "\", \"ph\": \"X\", \"pid\": 0, \"tid\": " << m_threads[t]->m_iThreadId
+				<< ", \"ts\": " << (trace[e].m_iStart - origin) / 1000.0
+				<< ", \"dur\": " << (trace[e].m_iEnd - trace[e].m_iStart) / 1000.0 << " }";
+
+			first = false;
+		}
+	}
+
+	os << "\n] }\n";
+}
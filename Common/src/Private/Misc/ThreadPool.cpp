@@ -0,0 +1,188 @@
+#include "Public/Misc/ThreadPool.h"
+
+#include <cassert>
+#include <algorithm>
+
+//----------------------------- ctor -------------------------------
+
+ThreadPool::ThreadPool(unsigned int numThreads)
+	:m_pJob(nullptr),
+	m_iPendingTasks(0),
+	m_iGeneration(0),
+	m_bShutdown(false)
+{
+	if (numThreads == 0)
+	{
+		numThreads = std::thread::hardware_concurrency();
+
+		if (numThreads == 0) numThreads = 1;
+	}
+
+	for (unsigned int i = 0; i < numThreads; ++i)
+	{
+		m_queues.push_back(std::unique_ptr<WorkQueue>(new WorkQueue()));
+	}
+
+	// The last queue belongs to whichever thread calls ParallelFor
+	for (unsigned int i = 0; i + 1 < numThreads; ++i)
+	{
+		m_workers.push_back(std::thread(&ThreadPool::WorkerLoop, this, (size_t)i));
+	}
+}
+
+//----------------------------- dtor -------------------------------
+
+ThreadPool::~ThreadPool()
+{
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+		m_bShutdown = true;
+	}
+
+	m_wakeWorkers.notify_all();
+
+	for (unsigned int i = 0; i < m_workers.size(); ++i)
+	{
+		m_workers[i].join();
+	}
+}
+
+//----------------------------- PopOrSteal -------------------------
+
+bool ThreadPool::PopOrSteal(size_t self, Task& task)
+{
+	// Our own work first, newest task first
+	{
+		WorkQueue& own = *m_queues[self];
+		std::lock_guard<std::mutex> lock(own.m_mutex);
+
+		if (!own.m_tasks.empty())
+		{
+			task = own.m_tasks.back();
+			own.m_tasks.pop_back();
+
+			return true;
+		}
+	}
+
+	// Then steal the oldest task of the next busy thread along
+	for (size_t i = 1; i < m_queues.size(); ++i)
+	{
+		WorkQueue& victim = *m_queues[(self + i) % m_queues.size()];
+		std::lock_guard<std::mutex> lock(victim.m_mutex);
+
+		if (!victim.m_tasks.empty())
+		{
+			task = victim.m_tasks.front();
+			victim.m_tasks.pop_front();
+
+			return true;
+		}
+	}
+
+	return false;
+}
+
+//----------------------------- RunTasks ---------------------------
+
+void ThreadPool::RunTasks(size_t self)
+{
+	Task task;
+
+	while (PopOrSteal(self, task))
+	{
+		(*m_pJob)(task.m_iBegin, task.m_iEnd);
+
+		// The last task to finish wakes up the thread waiting in ParallelFor
+		if (m_iPendingTasks.fetch_sub(1) == 1)
+		{
+			std::lock_guard<std::mutex> lock(m_mutex);
+			m_jobDone.notify_all();
+		}
+	}
+}
+
+//----------------------------- WorkerLoop -------------------------
+
+void ThreadPool::WorkerLoop(size_t self)
+{
+	unsigned int seenGeneration = 0;
+
+	while (true)
+	{
+		{
+			std::unique_lock<std::mutex> lock(m_mutex);
+
+			m_wakeWorkers.wait(lock, [&] { return m_bShutdown || m_iGeneration != seenGeneration; });
+
+			if (m_bShutdown) return;
+
+			seenGeneration = m_iGeneration;
+		}
+
+		RunTasks(self);
+	}
+}
+
+//----------------------------- ParallelFor ------------------------
+
+void ThreadPool::ParallelFor(size_t count, size_t grainSize, const std::function<void(size_t, size_t)>& job)
+{
+	assert(!m_pJob && "<ThreadPool::ParallelFor>: nested calls are not supported");
+
+	if (count == 0) return;
+	if (grainSize == 0) grainSize = 1;
+
+	const size_t numTasks = (count + grainSize - 1) / grainSize;
+
+	// Nothing to share out
+	if (m_workers.empty() || numTasks == 1)
+	{
+		for (size_t begin = 0; begin < count; begin += grainSize)
+		{
+			job(begin, std::min(begin + grainSize, count));
+		}
+
+		return;
+	}
+
+	m_pJob = &job;
+	m_iPendingTasks = numTasks;
+
+	// Deal the tasks out in contiguous runs so each thread starts on its own
+	// stretch of the range
+	const size_t numQueues = m_queues.size();
+
+	for (size_t q = 0; q < numQueues; ++q)
+	{
+		const size_t firstTask = numTasks * q / numQueues;
+		const size_t lastTask = numTasks * (q + 1) / numQueues;
+
+		std::lock_guard<std::mutex> lock(m_queues[q]->m_mutex);
+
+		for (size_t t = firstTask; t < lastTask; ++t)
+		{
+			Task task;
+			task.m_iBegin = t * grainSize;
+			task.m_iEnd = std::min(task.m_iBegin + grainSize, count);
+
+			m_queues[q]->m_tasks.push_back(task);
+		}
+	}
+
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+		++m_iGeneration;
+	}
+
+	m_wakeWorkers.notify_all();
+
+	RunTasks(numQueues - 1);
+
+	{
+		std::unique_lock<std::mutex> lock(m_mutex);
+		m_jobDone.wait(lock, [&] { return m_iPendingTasks == 0; });
+	}
+
+	m_pJob = nullptr;
+}
@@ -16,7 +16,7 @@ PrecisionTimer::PrecisionTimer()
 	m_bSmoothUpdates(false)
 {
 	// How many ticks per sec do we get
-	QueryPerformanceCounter((LARGE_INTEGER*)& m_lPerFCountFreq);
+	m_lPerFCountFreq = PrecisionClock::period::den / PrecisionClock::period::num;
 
 	m_dTimeScale = 1.0 / m_lPerFCountFreq;
 }
@@ -39,12 +39,12 @@ PrecisionTimer::PrecisionTimer(double fps)
 	m_bSmoothUpdates(false)
 {
 	// How many ticks per sec do we get
-	QueryPerformanceCounter((LARGE_INTEGER*)& m_lPerFCountFreq);
+	m_lPerFCountFreq = PrecisionClock::period::den / PrecisionClock::period::num;
 
 	m_dTimeScale = 1.0 / m_lPerFCountFreq;
 
 	// Calculate ticks per frame
-	m_lFrameTime = (LONGLONG)(m_lPerFCountFreq / m_dNormalFPS);
+	m_lFrameTime = (TimerTicks)(m_lPerFCountFreq / m_dNormalFPS);
 }
 
 //-------------------------Start -------------------------------
@@ -58,7 +58,7 @@ void PrecisionTimer::Start()
 	m_dTimeElapsed = 0.0;
 
 	// Get the time
-	QueryPerformanceCounter((LARGE_INTEGER*)& m_lLastTime);
+	m_lLastTime = QueryCounter();
 
 	// Keep a record of when the timer was started
 	m_lStartTime = m_lLastTimeInTimeElapsed = m_lLastTime;
@@ -72,11 +72,11 @@ void PrecisionTimer::Start()
 //  FPS is set.
 //----------------------------------------------------------------------------
 
-inline bool PrecisionTimer::ReadyForNextFrame()
+bool PrecisionTimer::ReadyForNextFrame()
 {
 	assert(m_dNormalFPS && "PrecisionTimer::ReadyForNextFrame<No FPS set in timer>");
 
-	QueryPerformanceCounter((LARGE_INTEGER*)& m_lCurrentTime);
+	m_lCurrentTime = QueryCounter();
 
 	if (m_lCurrentTime > m_lNextTime)
 	{
@@ -5,15 +5,16 @@
 #include "Public/Misc/Utils.h"
 #include "Public/2D/Vector2D.h"
 
-class C2DMatrix
+template<class T>
+class C2DMatrixT
 {
 private:
 
 	struct Matrix
 	{
-		double _11, _12, _13;
-		double _21, _22, _23;
-		double _31, _32, _33;
+		T _11, _12, _13;
+		T _21, _22, _23;
+		T _31, _32, _33;
 
 		Matrix()
 		{
@@ -53,7 +54,7 @@ private:
 
 public:
 
-	C2DMatrix()
+	C2DMatrixT()
 	{
 		// Initialize the matrix to an identity matrix
 		Identity();
@@ -74,7 +75,7 @@ public:
 	// Create a transformation matrix
 	// -------------------------------------------------------------------
 
-	inline void Translate(double x, double y)
+	inline void Translate(T x, T y)
 	{
 		Matrix mat;
 
@@ -90,7 +91,7 @@ public:
 	// Create a scale matrix
 	// ---------------------------------------------------------------
 
-	inline void Scale(double x, double y)
+	inline void Scale(T x, T y)
 	{
 		Matrix mat;
 
@@ -106,12 +107,12 @@ public:
 	// Create a rotation matrix
 	// ---------------------------------------------------------------
 
-	inline void Rotate(double rotation)
+	inline void Rotate(T rotation)
 	{
 		Matrix mat;
 
-		double sin = std::sin(rotation);
-		double cos = std::cos(rotation);
+		T sin = std::sin(rotation);
+		T cos = std::cos(rotation);
 
 		mat._11 = cos; mat._12 = sin; mat._13 = 0;
 		mat._21 = -sin; mat._22 = cos; mat._23 = 0;
@@ -125,7 +126,7 @@ public:
 	// Create a rotation matrix from a fwd and side 2D vector
 	// ---------------------------------------------------------------
 
-	inline void Rotate(const Vector2D& fwd, const Vector2D& side)
+	inline void Rotate(const Vector2DT<T>& fwd, const Vector2DT<T>& side)
 	{
 		Matrix mat;
 
@@ -141,13 +142,13 @@ public:
 	// Apply a transformation matrix to a std::vector of points
 	// ---------------------------------------------------------------------------
 
-	inline void TransformVector2Ds(std::vector<Vector2D>& vPoints)
+	inline void TransformVector2Ds(std::vector<Vector2DT<T>>& vPoints)
 	{
 		for (unsigned int i = 0; i < vPoints.size(); ++i)
 		{
-			double tempX = (m_matrix._11*vPoints[i].x) + (m_matrix._21*vPoints[i].y) + (m_matrix._31);
+			T tempX = (m_matrix._11*vPoints[i].x) + (m_matrix._21*vPoints[i].y) + (m_matrix._31);
 
-			double tempY = (m_matrix._12*vPoints[i].x) + (m_matrix._22*vPoints[i].y) + (m_matrix._32);
+			T tempY = (m_matrix._12*vPoints[i].x) + (m_matrix._22*vPoints[i].y) + (m_matrix._32);
 
 			vPoints[i].x = tempX;
 
@@ -162,11 +163,11 @@ public:
 	// Apply a transformation matrix to a point
 	// ---------------------------------------------------------------------------
 
-	inline void TransformVector2Ds(Vector2D& vPoint)
+	inline void TransformVector2Ds(Vector2DT<T>& vPoint)
 	{
-		double tempX = (m_matrix._11*vPoint.x) + (m_matrix._21*vPoint.y) + (m_matrix._31);
+		T tempX = (m_matrix._11*vPoint.x) + (m_matrix._21*vPoint.y) + (m_matrix._31);
 
-		double tempY = (m_matrix._12*vPoint.x) + (m_matrix._22*vPoint.y) + (m_matrix._32);
+		T tempY = (m_matrix._12*vPoint.x) + (m_matrix._22*vPoint.y) + (m_matrix._32);
 
 		vPoint.x = tempX;
 
@@ -174,15 +175,17 @@ public:
 	}
 
 	// Accessors to the matrix elements
-	void _11(double val) { m_matrix._11 = val; }
-	void _12(double val) { m_matrix._12 = val; }
-	void _13(double val) { m_matrix._13 = val; }
+	void _11(T val) { m_matrix._11 = val; }
+	void _12(T val) { m_matrix._12 = val; }
+	void _13(T val) { m_matrix._13 = val; }
 
-	void _21(double val) { m_matrix._21 = val; }
-	void _22(double val) { m_matrix._22 = val; }
-	void _23(double val) { m_matrix._23 = val; }
+	void _21(T val) { m_matrix._21 = val; }
+	void _22(T val) { m_matrix._22 = val; }
+	void _23(T val) { m_matrix._23 = val; }
 	
-	void _31(double val) { m_matrix._31 = val; }
-	void _32(double val) { m_matrix._32 = val; }
-	void _33(double val) { m_matrix._33 = val; }
-};
\ No newline at end of file
+	void _31(T val) { m_matrix._31 = val; }
+	void _32(T val) { m_matrix._32 = val; }
+	void _33(T val) { m_matrix._33 = val; }
+};
+
+typedef C2DMatrixT<double> C2DMatrix;
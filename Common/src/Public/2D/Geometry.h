@@ -15,11 +15,12 @@ const double PI = 3.14159;
 // occurs. Returns a negative if the ray is parallel
 // --------------------------------------------------------------------------------------
 
-inline double DistanceToRayPlaneIntersection(Vector2D rayOrigin, Vector2D rayHeading, Vector2D planePoint, Vector2D planeNormal)
+template<class T>
+inline T DistanceToRayPlaneIntersection(Vector2DT<T> rayOrigin, Vector2DT<T> rayHeading, Vector2DT<T> planePoint, Vector2DT<T> planeNormal)
 {
-	double d = -planeNormal.Dot(planePoint);
-	double numer = planeNormal.Dot(rayOrigin) + d;
-	double denom = planeNormal.Dot(rayHeading);
+	T d = -planeNormal.Dot(planePoint);
+	T numer = planeNormal.Dot(rayOrigin) + d;
+	T denom = planeNormal.Dot(rayHeading);
 
 	// normal is parallel to vector
 	return ((denom < 0.000001) && (denom > -0.000001)) ? -1.0 : -(numer / denom);
@@ -30,22 +31,23 @@ inline double DistanceToRayPlaneIntersection(Vector2D rayOrigin, Vector2D rayHea
 //  perpendicular distance between them
 //---------------------------------------------------------------------------
 
-inline double DistToLineSegment(Vector2D a, Vector2D b, Vector2D p)
+template<class T>
+inline T DistToLineSegment(Vector2DT<T> a, Vector2DT<T> b, Vector2DT<T> p)
 {
 	// If the angle is obtuse between PA and AB (is obtuse when the closest
 	// vertex must be A)
-	double dotA = (p.x - a.x) * (b.x - a.x) + (p.y - a.y)* (b.y - a.y);
+	T dotA = (p.x - a.x) * (b.x - a.x) + (p.y - a.y)* (b.y - a.y);
 
 	if (dotA <= 0) return Vec2DDistance(a, p);
 
 	// If the angle is obtuse between PB and AB (is obstuse when the closest
 	// vertext must be B
-	double dotB = (p.x - b.x) * (a.x - b.x) + (p.y - b.y) * (a.y - b.y);
+	T dotB = (p.x - b.x) * (a.x - b.x) + (p.y - b.y) * (a.y - b.y);
 
 	if (dotB <= 0) return Vec2DDistance(b, p);
 
 	// Calculate the point along AB that is the closest to P
-	Vector2D point = a + ((b - a) * dotA) / (dotA + dotB);
+	Vector2DT<T> point = a + ((b - a) * dotA) / (dotA + dotB);
 
 	// Calculate the distance P-Point
 	return Vec2DDistance(p, point);
@@ -55,20 +57,21 @@ inline double DistToLineSegment(Vector2D a, Vector2D b, Vector2D p)
 // Given 2 lines in 2D space AB, CD this returns true if an intersection occurs
 //-----------------------------------------------------------------------------
 
-inline bool LineIntersection2D(const Vector2D& a, const Vector2D& b, const Vector2D& c, const Vector2D& d)
+template<class T>
+inline bool LineIntersection2D(const Vector2DT<T>& a, const Vector2DT<T>& b, const Vector2DT<T>& c, const Vector2DT<T>& d)
 {
-	double rTop = (a.y - c.y) * (d.x - c.x) - (a.x - c.x) * (d.y - c.y);
-	double sTop = (a.y - c.y) * (b.x - a.x) - (a.x - c.x) * (b.y - a.y);
+	T rTop = (a.y - c.y) * (d.x - c.x) - (a.x - c.x) * (d.y - c.y);
+	T sTop = (a.y - c.y) * (b.x - a.x) - (a.x - c.x) * (b.y - a.y);
 
-	double bot = (b.x - a.x) * (d.y - c.y) - (b.y - a.y) * (d.x - c.x);
+	T bot = (b.x - a.x) * (d.y - c.y) - (b.y - a.y) * (d.x - c.x);
 
 	if (bot == 0) // parallel
 	{
 		return false;
 	}
 
-	double r = rTop / bot;
-	double s = sTop / bot;
+	T r = rTop / bot;
+	T s = sTop / bot;
 
 	if ((r > 0) && (r < 1) && (s > 0) && (s < 1))
 	{
@@ -85,17 +88,18 @@ inline bool LineIntersection2D(const Vector2D& a, const Vector2D& b, const Vecto
 // and sets dist to the distance the intersection occurs along AB
 //-----------------------------------------------------------------------------
 
-inline bool LineIntersection2D(const Vector2D& a, const Vector2D& b, const Vector2D& c, const Vector2D& d, double& dist)
+template<class T>
+inline bool LineIntersection2D(const Vector2DT<T>& a, const Vector2DT<T>& b, const Vector2DT<T>& c, const Vector2DT<T>& d, Scalar2D<T>& dist)
 {
-	double rTop = (a.y - c.y) * (d.x - c.x) - (a.x - c.x) * (d.y - c.y);
-	double sTop = (a.y - c.y) * (b.x - a.x) - (a.x - c.x) * (b.y - a.y);
+	T rTop = (a.y - c.y) * (d.x - c.x) - (a.x - c.x) * (d.y - c.y);
+	T sTop = (a.y - c.y) * (b.x - a.x) - (a.x - c.x) * (b.y - a.y);
 
-	double bot = (b.x - a.x) * (d.y - c.y) - (b.y - a.y) * (d.x - c.x);
+	T bot = (b.x - a.x) * (d.y - c.y) - (b.y - a.y) * (d.x - c.x);
 	
 	// Check if rects are parallel
 	if (bot == 0)
 	{
-		if (IsEqual(rTop, 0) && IsEqual(sTop, 0))
+		if (IsEqual(rTop, (T)0) && IsEqual(sTop, (T)0))
 		{
 			return true;
 		}
@@ -103,8 +107,8 @@ inline bool LineIntersection2D(const Vector2D& a, const Vector2D& b, const Vecto
 		return false;
 	}
 
-	double r = rTop / bot;
-	double s = sTop / bot;
+	T r = rTop / bot;
+	T s = sTop / bot;
 
 	if ((r > 0) && (r < 1) && (s > 0) && (s < 1))
 	{
@@ -124,13 +128,14 @@ inline bool LineIntersection2D(const Vector2D& a, const Vector2D& b, const Vecto
 // 2d vector point to the point of intersection
 //-----------------------------------------------------------------------------
 
-inline bool LineIntersection2D(const Vector2D& a, const Vector2D& b, const Vector2D& c,const  Vector2D& d, double& dist, Vector2D& point)
+template<class T>
+inline bool LineIntersection2D(const Vector2DT<T>& a, const Vector2DT<T>& b, const Vector2DT<T>& c,const  Vector2DT<T>& d, Scalar2D<T>& dist, Vector2DT<T>& point)
 {
-	double rTop = (a.y - c.y) * (d.x - c.x) - (a.x - c.x) * (d.y - c.y);
-	double rBot = (b.x - a.x) * (d.y - c.y) - (b.y - a.y) * (d.x - c.x);
+	T rTop = (a.y - c.y) * (d.x - c.x) - (a.x - c.x) * (d.y - c.y);
+	T rBot = (b.x - a.x) * (d.y - c.y) - (b.y - a.y) * (d.x - c.x);
 
-	double sTop = (a.y - c.y) * (b.x - a.x) - (a.x - c.x) * (b.y - a.y);
-	double sBot = (b.x - a.x) * (d.y - c.y) - (b.y - a.y) * (d.x - c.x);
+	T sTop = (a.y - c.y) * (b.x - a.x) - (a.x - c.x) * (b.y - a.y);
+	T sBot = (b.x - a.x) * (d.y - c.y) - (b.y - a.y) * (d.x - c.x);
 
 	if ((rBot == 0) || (sBot == 0))
 	{
@@ -138,8 +143,8 @@ inline bool LineIntersection2D(const Vector2D& a, const Vector2D& b, const Vecto
 		return false;
 	}
 
-	double r = rTop / rBot;
-	double s = sTop / sBot;
+	T r = rTop / rBot;
+	T s = sTop / sBot;
 
 	if ((r > 0) && (r < 1) && (s > 0) && (s < 1))
 	{
@@ -160,11 +165,12 @@ inline bool LineIntersection2D(const Vector2D& a, const Vector2D& b, const Vecto
 //-----------------------------------------------------------------------------
 
 enum span_type { ST_Backside, ST_Front, ST_OnPlane };
-inline span_type WhereIsPoint(Vector2D point, Vector2D pointOnPlane, Vector2D planeNormal)
+template<class T>
+inline span_type WhereIsPoint(Vector2DT<T> point, Vector2DT<T> pointOnPlane, Vector2DT<T> planeNormal)
 {
-	Vector2D dir = pointOnPlane - point;
+	Vector2DT<T> dir = pointOnPlane - point;
 
-	double d = dir.Dot(planeNormal);
+	T d = dir.Dot(planeNormal);
 
 	if (d < -0.000001)
 	{
@@ -182,12 +188,13 @@ inline span_type WhereIsPoint(Vector2D point, Vector2D pointOnPlane, Vector2D pl
 // Check whether a ray intersects with a circle with a given radius
 //-------------------------------------------------------------------------------
 
-inline double GetRayCircleIntersect(Vector2D rayOrigin, Vector2D rayHeading, Vector2D circleOrigin, double radius)
+template<class T>
+inline T GetRayCircleIntersect(Vector2DT<T> rayOrigin, Vector2DT<T> rayHeading, Vector2DT<T> circleOrigin, Scalar2D<T> radius)
 {
-	Vector2D toCircle = circleOrigin - rayOrigin;
-	double length = toCircle.Length();
-	double v = toCircle.Dot(rayHeading);
-	double d = radius * radius - (length * length* - v * v);
+	Vector2DT<T> toCircle = circleOrigin - rayOrigin;
+	T length = toCircle.Length();
+	T v = toCircle.Dot(rayHeading);
+	T d = radius * radius - (length * length* - v * v);
 
 	// If there was no intersection, return -1
 	if (d < 0.0) return (-1.0);
@@ -198,12 +205,13 @@ inline double GetRayCircleIntersect(Vector2D rayOrigin, Vector2D rayHeading, Vec
 
 //----------------------------- DoRayCircleIntersect --------------------------
 
-inline bool DoRayCircleIntersect(Vector2D rayOrigin, Vector2D rayHeading, Vector2D circleOrigin, double radius)
+template<class T>
+inline bool DoRayCircleIntersect(Vector2DT<T> rayOrigin, Vector2DT<T> rayHeading, Vector2DT<T> circleOrigin, Scalar2D<T> radius)
 {
-	Vector2D toCircle = circleOrigin - rayOrigin;
-	double length = toCircle.Length();
-	double v = toCircle.Dot(rayHeading);
-	double d = radius * radius - ((length * length) * (-v * v));
+	Vector2DT<T> toCircle = circleOrigin - rayOrigin;
+	T length = toCircle.Length();
+	T v = toCircle.Dot(rayHeading);
+	T d = radius * radius - ((length * length) * (-v * v));
 
 	// If there was no intersection, return -1
 	return (d < 0.0);
@@ -215,11 +223,12 @@ inline bool DoRayCircleIntersect(Vector2D rayOrigin, Vector2D rayHeading, Vector
 // P to the circle. Returns false if P is within the circle.
 //-----------------------------------------------------------------------------
 
-inline bool GetTangentPoints(Vector2D circle, double radius, Vector2D point, Vector2D& t1, Vector2D& t2)
+template<class T>
+inline bool GetTangentPoints(Vector2DT<T> circle, Scalar2D<T> radius, Vector2DT<T> point, Vector2DT<T>& t1, Vector2DT<T>& t2)
 {
-	Vector2D PC = point - circle;
-	double sqrLen = PC.LengthSq();
-	double rSqr = radius * radius;
+	Vector2DT<T> PC = point - circle;
+	T sqrLen = PC.LengthSq();
+	T rSqr = radius * radius;
 
 	if (sqrLen <= rSqr)
 	{
@@ -227,8 +236,8 @@ inline bool GetTangentPoints(Vector2D circle, double radius, Vector2D point, Vec
 		return false;
 	}
 
-	double invSqrLen = 1 / sqrLen;
-	double root = sqrt(fabs(sqrLen - rSqr));
+	T invSqrLen = 1 / sqrLen;
+	T root = sqrt(fabs(sqrLen - rSqr));
 
 	t1.x = circle.x + radius * (radius * PC.x - PC.y * root) * invSqrLen;
 	t1.y = circle.y + radius * (radius * PC.y + PC.x * root) * invSqrLen;
@@ -254,9 +263,10 @@ inline bool TwoCirclesOverlapped(double x1, double y1, double r1, double x2, dou
 // Returns true if the two circles overlap
 //--------------------------------------------------------------------------------
 
-inline bool TwoCirclesOverlapped(Vector2D c1, double r1, Vector2D c2, double r2)
+template<class T>
+inline bool TwoCirclesOverlapped(Vector2DT<T> c1, Scalar2D<T> r1, Vector2DT<T> c2, Scalar2D<T> r2)
 {
-	double distBetweenCenters = sqrt((c1.x - c2.x) * (c1.x - c2.x) + (c1.y - c2.y) * (c1.y - c2.y));
+	T distBetweenCenters = sqrt((c1.x - c2.x) * (c1.x - c2.x) + (c1.y - c2.y) * (c1.y - c2.y));
 
 	return (distBetweenCenters < (r1 + r2)) || (distBetweenCenters < fabs(r1 - r2)) ? true : false;
 }
@@ -264,9 +274,10 @@ inline bool TwoCirclesOverlapped(Vector2D c1, double r1, Vector2D c2, double r2)
 //----------------------- PointInCircle ----------------------------------
 //  Returns true if the point p is within the radius of the given circle
 //------------------------------------------------------------------------
-inline bool PointInCircle(Vector2D pos, double radius, Vector2D p)
+template<class T>
+inline bool PointInCircle(Vector2DT<T> pos, Scalar2D<T> radius, Vector2DT<T> p)
 {
-	double distFromCenterSquared = (p - pos).LengthSq();
+	T distFromCenterSquared = (p - pos).LengthSq();
 
 	return (distFromCenterSquared < (radius*radius)) ? true : false;
 }
\ No newline at end of file
@@ -1,7 +1,10 @@
 #pragma once
 
 #include "Public/2D/Vector2D.h"
+
+#ifndef HEADLESS
 #include "Public/Misc/Cgdi.h"
+#endif
 
 /*
 V simple inverted (y increases down screen) axis 
@@ -32,6 +35,7 @@ public:
 			(other.Right() < this->Left()));
 	}
 
+#ifndef HEADLESS
 	void Render(bool renderCenter = false) const
 	{
 		gdi->Line((int)Left(), (int)Top(), (int)Right(), (int)Top());
@@ -44,6 +48,7 @@ public:
 			gdi->Circle(m_vCenter, 5);
 		}
 	}
+#endif
 
 	const Vector2D& TopLeft() const { return m_vTopLeft; }
 	const Vector2D& BottomRight() const { return m_vBottomRight; }
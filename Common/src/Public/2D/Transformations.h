@@ -10,17 +10,18 @@
 // this function transforms the 2D vectors into the object's world space
 // --------------------------------------------------------------------------
 
-inline std::vector<Vector2D> WorldTransform(const std::vector<Vector2D>& points, 
-	const Vector2D& pos, 
-	const Vector2D& forward, 
-	const Vector2D& side, 
-	const Vector2D& scale)
+template<class T>
+inline std::vector<Vector2DT<T>> WorldTransform(const std::vector<Vector2DT<T>>& points, 
+	const Vector2DT<T>& pos, 
+	const Vector2DT<T>& forward, 
+	const Vector2DT<T>& side, 
+	const Vector2DT<T>& scale)
 {
 	// Copy the original vertices into the buffer about to be transformed
-	std::vector<Vector2D> tranVector2Ds = points;
+	std::vector<Vector2DT<T>> tranVector2Ds = points;
 
 	// Create a transform matrix
-	C2DMatrix matTransform;
+	C2DMatrixT<T> matTransform;
 
 	// Scale
 	if ((scale.x != 1.0f) || (scale.y != 1.0f))
@@ -40,14 +41,15 @@ inline std::vector<Vector2D> WorldTransform(const std::vector<Vector2D>& points,
 	return tranVector2Ds;
 }
 
-inline void InPlaceWorldTransform(std::vector<Vector2D>& points,
-	const Vector2D& pos,
-	const Vector2D& forward,
-	const Vector2D& side,
-	const Vector2D& scale)
+template<class T>
+inline void InPlaceWorldTransform(std::vector<Vector2DT<T>>& points,
+	const Vector2DT<T>& pos,
+	const Vector2DT<T>& forward,
+	const Vector2DT<T>& side,
+	const Vector2DT<T>& scale)
 {
 	// Create a transform matrix
-	C2DMatrix matTransform;
+	C2DMatrixT<T> matTransform;
 
 	// Scale
 	if ((scale.x != 1.0f) || (scale.y != 1.0f))
@@ -70,16 +72,17 @@ inline void InPlaceWorldTransform(std::vector<Vector2D>& points,
 // this function transforms the 2D vectors into the object's world space
 // --------------------------------------------------------------------------
 
-inline std::vector<Vector2D> WorldTransform(const std::vector<Vector2D>& points,
-	const Vector2D& pos,
-	const Vector2D& forward,
-	const Vector2D& side)
+template<class T>
+inline std::vector<Vector2DT<T>> WorldTransform(const std::vector<Vector2DT<T>>& points,
+	const Vector2DT<T>& pos,
+	const Vector2DT<T>& forward,
+	const Vector2DT<T>& side)
 {
 	// Copy the original vertices into the buffer about to be transformed
-	std::vector<Vector2D> tranVector2Ds = points;
+	std::vector<Vector2DT<T>> tranVector2Ds = points;
 
 	// Create a transformation matrix
-	C2DMatrix matTransform;
+	C2DMatrixT<T> matTransform;
 
 	// Rotate
 	matTransform.Rotate(forward, side);
@@ -93,13 +96,14 @@ inline std::vector<Vector2D> WorldTransform(const std::vector<Vector2D>& points,
 	return tranVector2Ds;
 }
 
-inline void InPlaceWorldTransform(std::vector<Vector2D>& points,
-	const Vector2D& pos,
-	const Vector2D& forward,
-	const Vector2D& side)
+template<class T>
+inline void InPlaceWorldTransform(std::vector<Vector2DT<T>>& points,
+	const Vector2DT<T>& pos,
+	const Vector2DT<T>& forward,
+	const Vector2DT<T>& side)
 {
 	// Create a transformation matrix
-	C2DMatrix matTransform;
+	C2DMatrixT<T> matTransform;
 
 	// Rotate
 	matTransform.Rotate(forward, side);
@@ -115,16 +119,17 @@ inline void InPlaceWorldTransform(std::vector<Vector2D>& points,
 // Transform a point from the agent's local space into world space
 // --------------------------------------------------------------------------
 
-inline Vector2D PointToWorldSpace(const Vector2D& point,
-	const Vector2D& agentHeading,
-	const Vector2D& agentSide,
-	const Vector2D& agentPosition)
+template<class T>
+inline Vector2DT<T> PointToWorldSpace(const Vector2DT<T>& point,
+	const Vector2DT<T>& agentHeading,
+	const Vector2DT<T>& agentSide,
+	const Vector2DT<T>& agentPosition)
 {
 	// Make a copy of the point
-	Vector2D transPoint = point;
+	Vector2DT<T> transPoint = point;
 
 	// Create a transformation matrix
-	C2DMatrix matTransform;
+	C2DMatrixT<T> matTransform;
 
 	// Rotate
 	matTransform.Rotate(agentHeading, agentSide);
@@ -138,13 +143,14 @@ inline Vector2D PointToWorldSpace(const Vector2D& point,
 	return transPoint;
 }
 
-inline void InPlacePointToWorldSpace(Vector2D& point,
-	const Vector2D& agentHeading,
-	const Vector2D& agentSide,
-	const Vector2D& agentPosition)
+template<class T>
+inline void InPlacePointToWorldSpace(Vector2DT<T>& point,
+	const Vector2DT<T>& agentHeading,
+	const Vector2DT<T>& agentSide,
+	const Vector2DT<T>& agentPosition)
 {
 	// Create a transformation matrix
-	C2DMatrix matTransform;
+	C2DMatrixT<T> matTransform;
 
 	// Rotate
 	matTransform.Rotate(agentHeading, agentSide);
@@ -160,15 +166,16 @@ inline void InPlacePointToWorldSpace(Vector2D& point,
 // Transforms a vector from the agent's local space into world space
 // --------------------------------------------------------------------------
 
-inline Vector2D VectorToWorldSpace(const Vector2D& vec,
-	const Vector2D& agentHeading,
-	const Vector2D& agentSide)
+template<class T>
+inline Vector2DT<T> VectorToWorldSpace(const Vector2DT<T>& vec,
+	const Vector2DT<T>& agentHeading,
+	const Vector2DT<T>& agentSide)
 {
 	// Make a copy of the point
-	Vector2D transVec = vec;
+	Vector2DT<T> transVec = vec;
 
 	// Create a transformation matrix
-	C2DMatrix matTransform;
+	C2DMatrixT<T> matTransform;
 
 	// Rotate
 	matTransform.Rotate(agentHeading, agentSide);
@@ -179,12 +186,13 @@ inline Vector2D VectorToWorldSpace(const Vector2D& vec,
 	return transVec;
 }
 
-inline void InPlaceVectorToWorldSpace(Vector2D& vec,
-	const Vector2D& agentHeading,
-	const Vector2D& agentSide)
+template<class T>
+inline void InPlaceVectorToWorldSpace(Vector2DT<T>& vec,
+	const Vector2DT<T>& agentHeading,
+	const Vector2DT<T>& agentSide)
 {
 	// Create a transformation matrix
-	C2DMatrix matTransform;
+	C2DMatrixT<T> matTransform;
 
 	// Rotate
 	matTransform.Rotate(agentHeading, agentSide);
@@ -197,19 +205,20 @@ inline void InPlaceVectorToWorldSpace(Vector2D& vec,
 //	Transforms a point from world space into agent's local space
 // --------------------------------------------------------------------------
 
-inline Vector2D PointToLocalSpace(const Vector2D& point,
-	const Vector2D& agentHeading,
-	const Vector2D& agentSide,
-	const Vector2D& agentPosition)
+template<class T>
+inline Vector2DT<T> PointToLocalSpace(const Vector2DT<T>& point,
+	const Vector2DT<T>& agentHeading,
+	const Vector2DT<T>& agentSide,
+	const Vector2DT<T>& agentPosition)
 {
 	// Make a copy of the point
-	Vector2D transPoint = point;
+	Vector2DT<T> transPoint = point;
 
 	// Create a transformation matrix
-	C2DMatrix matTransform;
+	C2DMatrixT<T> matTransform;
 
-	double Tx = -agentPosition.Dot(agentHeading);
-	double Ty = -agentPosition.Dot(agentSide);
+	T Tx = -agentPosition.Dot(agentHeading);
+	T Ty = -agentPosition.Dot(agentSide);
 
 	// Create the transformation matrix
 	matTransform._11(agentHeading.x); matTransform._12(agentSide.x);
@@ -226,15 +235,16 @@ inline Vector2D PointToLocalSpace(const Vector2D& point,
 // Transforms a vector from world space into agent's local space
 // --------------------------------------------------------------------------
 
-inline Vector2D VectorToLocalSpace(const Vector2D& vec,
-	const Vector2D& agentHeading,
-	const Vector2D& agentSide)
+template<class T>
+inline Vector2DT<T> VectorToLocalSpace(const Vector2DT<T>& vec,
+	const Vector2DT<T>& agentHeading,
+	const Vector2DT<T>& agentSide)
 {
 	// Make a copy of the vector
-	Vector2D transPoint = vec;
+	Vector2DT<T> transPoint = vec;
 
 	// Create a transformation matrix
-	C2DMatrix matTrasform;
+	C2DMatrixT<T> matTrasform;
 
 	// Create the transformation matrix
 	matTrasform._11(agentHeading.x); matTrasform._12(agentSide.x);
@@ -250,10 +260,11 @@ inline Vector2D VectorToLocalSpace(const Vector2D& vec,
 // Rotates a vector ang rads around the origin
 // --------------------------------------------------------------------------------
 
-inline void Vec2DRotateAroundOrigin(Vector2D& v, double ang)
+template<class T>
+inline void Vec2DRotateAroundOrigin(Vector2DT<T>& v, Scalar2D<T> ang)
 {
 	// Create a transformation matrix
-	C2DMatrix matTransform;
+	C2DMatrixT<T> matTransform;
 
 	// Rotate
 	matTransform.Rotate(ang);
@@ -271,19 +282,20 @@ inline void Vec2DRotateAroundOrigin(Vector2D& v, double ang)
 //  them. (like the spokes of a wheel clipped to a specific segment size)
 //----------------------------------------------------------------------------
 
-inline std::vector<Vector2D> CreateWhiskers(
+template<class T>
+inline std::vector<Vector2DT<T>> CreateWhiskers(
 	unsigned int numWhiskers,
-	double whiskerLength,
-	double fov,
-	Vector2D facing,
-	Vector2D origin)
+	Scalar2D<T> whiskerLength,
+	Scalar2D<T> fov,
+	Vector2DT<T> facing,
+	Vector2DT<T> origin)
 {
 	// This is the magnitude of the angle separating each whisker
-	double sectorSize = fov / (double)(numWhiskers - 1);
+	T sectorSize = fov / (T)(numWhiskers - 1);
 
-	std::vector<Vector2D> whiskers;
-	Vector2D temp;
-	double angle = -fov * 0.5;
+	std::vector<Vector2DT<T>> whiskers;
+	Vector2DT<T> temp;
+	T angle = -fov * 0.5;
 
 	for (unsigned int w = 0; w < numWhiskers; ++w)
 	{
@@ -1,32 +1,42 @@
 #pragma once
 
 #include <math.h>
-#include <windows.h>
 #include <iosfwd>
 #include <limits>
 #include <fstream>
 
 #include "Public/Misc/Utils.h"
 
-struct Vector2D
+#ifndef HEADLESS
+#include <windows.h>
+#endif
+
+template<class T>
+struct Vector2DT
 {
-	double x;
-	double y;
+	typedef T value_type;
+
+	T x;
+	T y;
+
+	Vector2DT() :x(0), y(0) {}
+	Vector2DT(T a, T b) :x(a), y(b) {}
 
-	Vector2D() :x(0.0), y(0.0) {}
-	Vector2D(double a, double b) :x(a), y(b) {}
+	// Converts a vector of another precision
+	template<class U>
+	explicit Vector2DT(const Vector2DT<U>& v) :x((T)v.x), y((T)v.y) {}
 
 	// Sets x and y to zero
-	void Zero() { x = 0.0; y = 0.0; }
+	void Zero() { x = 0; y = 0; }
 	
 	// Returns true if both x and y are zero
-	bool IsZero() const { return (x*x + y*y) < MinDouble; }
+	bool IsZero() const { return (x*x + y*y) < (std::numeric_limits<T>::min)(); }
 
 	//----------------------- Length -----------------------------------
 	// Returns the length of a 2D Vector
 	//------------------------------------------------------------------
 
-	inline double Length() const
+	inline T Length() const
 	{
 		return sqrt(x * x + y * y);
 	}
@@ -35,7 +45,7 @@ struct Vector2D
 	// Returns the squared length of a 2D Vector
 	//--------------------------------------------------------------------
 
-	inline double LengthSq() const
+	inline T LengthSq() const
 	{
 		return (x * x + y * y);
 	}
@@ -46,9 +56,9 @@ struct Vector2D
 
 	inline void Normalize()
 	{
-		double vector_length = this->Length();
+		T vector_length = this->Length();
 
-		if (vector_length > std::numeric_limits<double>::epsilon())
+		if (vector_length > std::numeric_limits<T>::epsilon())
 		{
 			this->x /= vector_length;
 			this->y /= vector_length;
@@ -59,7 +69,7 @@ struct Vector2D
 	// Calculates the dot product
 	//---------------------------------------------------------------
 
-	inline double Dot(const Vector2D& v2) const
+	inline T Dot(const Vector2DT& v2) const
 	{
 		return x * v2.x + y * v2.y;
 	}
@@ -71,7 +81,7 @@ struct Vector2D
 
 	enum { clockwise = 1, anticlockwise = -1 };
 
-	inline int Sign(const Vector2D& v2) const
+	inline int Sign(const Vector2DT& v2) const
 	{
 		return (y*v2.x > x*v2.y) ? anticlockwise : clockwise;
 	}
@@ -80,16 +90,16 @@ struct Vector2D
 	// Returns a vector perpendicular to this vector
 	//----------------------------------------------------------------
 
-	inline Vector2D Perp() const
+	inline Vector2DT Perp() const
 	{
-		return Vector2D(-y, x);
+		return Vector2DT(-y, x);
 	}
 
 	//----------------------- Truncate -----------------------------------
 	// Truncates a vector so that its length does not exceed max
 	//--------------------------------------------------------------------
 
-	inline void Truncate(double max)
+	inline void Truncate(T max)
 	{
 		if (this->Length() > max)
 		{
@@ -102,10 +112,10 @@ struct Vector2D
 	// Calculates the euclidean distance between two vectors
 	//--------------------------------------------------------------------
 
-	inline double Distance(const Vector2D& v2) const
+	inline T Distance(const Vector2DT& v2) const
 	{
-		double xSeparation = v2.x - x;
-		double ySeparation = v2.y - y;
+		T xSeparation = v2.x - x;
+		T ySeparation = v2.y - y;
 
 
 		return sqrt(ySeparation * ySeparation + xSeparation * xSeparation);
@@ -115,10 +125,10 @@ struct Vector2D
 	// Calculates the euclidean distance squared between two vectors
 	//----------------------------------------------------------------------
 
-	inline double DistanceSq(const Vector2D& v2) const
+	inline T DistanceSq(const Vector2DT& v2) const
 	{
-		double xSeparation = v2.x - x;
-		double ySeparation = v2.y - y;
+		T xSeparation = v2.x - x;
+		T ySeparation = v2.y - y;
 
 
 		return (ySeparation * ySeparation + xSeparation * xSeparation);
@@ -129,95 +139,143 @@ struct Vector2D
 	// is operating upon. (like the path of a ball bouncing off a wall)
 	//-------------------------------------------------------------------
 
-	inline void Reflect(const Vector2D& norm)
+	inline void Reflect(const Vector2DT& norm)
 	{
-		*this += 2.0 * this->Dot(norm) * norm.GetReverse();
+		*this += (T)2 * this->Dot(norm) * norm.GetReverse();
 	}
 
 	//----------------------- GetReverse ----------------------------------------
 	// Returns the vector that is the reverse of this vector
 	//---------------------------------------------------------------------------
 
-	inline Vector2D GetReverse() const
+	inline Vector2DT GetReverse() const
 	{
-		return Vector2D(-this->x, -this->y);
+		return Vector2DT(-this->x, -this->y);
 	}
 
 	// We need some basic operator overloads
-	const Vector2D& operator+=(const Vector2D& rhs);
-	const Vector2D& operator-=(const Vector2D& rhs);
-	const Vector2D& operator*=(const double& rhs);
-	const Vector2D& operator/=(const double& rhs);
-	const Vector2D& operator/=(const Vector2D& rhs);
-	const Vector2D& operator*=(const Vector2D& rhs);
+	const Vector2DT& operator+=(const Vector2DT& rhs)
+	{
+		x += rhs.x;
+		y += rhs.y;
+
+		return *this;
+	}
+
+	const Vector2DT& operator-=(const Vector2DT& rhs)
+	{
+		x -= rhs.x;
+		y -= rhs.y;
 
-	bool operator==(const Vector2D& rhs);
-	bool operator!=(const Vector2D& rhs);
+		return *this;
+	}
+
+	const Vector2DT& operator*=(const T& rhs)
+	{
+		x *= rhs;
+		y *= rhs;
+
+		return *this;
+	}
+
+	const Vector2DT& operator/=(const T& rhs)
+	{
+		x /= rhs;
+		y /= rhs;
+
+		return *this;
+	}
+
+	const Vector2DT& operator/=(const Vector2DT& rhs)
+	{
+		x /= rhs.x;
+		y /= rhs.y;
+
+		return *this;
+	}
+
+	const Vector2DT& operator*=(const Vector2DT& rhs)
+	{
+		x *= rhs.x;
+		y *= rhs.y;
+
+		return *this;
+	}
+
+	bool operator==(const Vector2DT& rhs)
+	{
+		return IsEqual(x, rhs.x) && IsEqual(y, rhs.y);
+	}
+
+	bool operator!=(const Vector2DT& rhs)
+	{
+		return (x != rhs.x) && (y != rhs.y);
+	}
 
 	// More operator overloads
-	friend inline Vector2D operator*(const Vector2D& lhs, double rhs)
+	friend inline Vector2DT operator*(const Vector2DT& lhs, T rhs)
 	{
-		Vector2D result(lhs);
+		Vector2DT result(lhs);
 		result *= rhs;
 
 		return result;
 	}
 
-	friend inline Vector2D operator*(double lhs, const Vector2D& rhs)
+	friend inline Vector2DT operator*(T lhs, const Vector2DT& rhs)
 	{
-		Vector2D result(rhs);
+		Vector2DT result(rhs);
 		result *= lhs;
 
 		return result;
 	}
 
-	friend inline Vector2D operator-(const Vector2D& lhs, const Vector2D& rhs)
+	friend inline Vector2DT operator-(const Vector2DT& lhs, const Vector2DT& rhs)
 	{
-		Vector2D result(lhs);
+		Vector2DT result(lhs);
 		result.x -= rhs.x;
 		result.y -= rhs.y;
 
 		return result;
 	}
 
-	friend inline Vector2D operator+(const Vector2D& lhs, const Vector2D& rhs)
+	friend inline Vector2DT operator+(const Vector2DT& lhs, const Vector2DT& rhs)
 	{
-		Vector2D result(lhs);
+		Vector2DT result(lhs);
 		result.x += rhs.x;
 		result.y += rhs.y;
 
 		return result;
 	}
 
-	friend inline Vector2D operator/(const Vector2D& lhs, double val)
+	friend inline Vector2DT operator/(const Vector2DT& lhs, T val)
 	{
-		Vector2D result(lhs);
+		Vector2DT result(lhs);
 		result.x /= val;
 		result.y /= val;
 
 		return result;
 	}
 	
-	// Vector2D friend functions
+	// Vector2DT friend functions
 
-	friend inline void WrapAround(Vector2D& pos, int maxX, int maxY)
+	friend inline void WrapAround(Vector2DT& pos, int maxX, int maxY)
 	{
-		if (pos.x > maxX) { pos.x = 0.0; }
+		if (pos.x > maxX) { pos.x = 0; }
 
-		if (pos.x < 0) { pos.x = (double)maxX; }
+		if (pos.x < 0) { pos.x = (T)maxX; }
 
-		if (pos.y < 0) { pos.y = (double)maxY; }
+		if (pos.y < 0) { pos.y = (T)maxY; }
 
-		if (pos.y > maxY) { pos.y = 0.0; }
+		if (pos.y > maxY) { pos.y = 0; }
 	}
 
-	friend inline Vector2D Vec2DNormalize(const Vector2D& v)
+	friend inline Vector2DT Vec2DNormalize(const Vector2DT& v)
 	{
-		Vector2D vec = v;
+		Vector2DT vec = v;
 
-		double vLength = vec.Length();
+		T vLength = vec.Length();
 
-		if (vLength > std::numeric_limits<double>::epsilon())
+		if (vLength > std::numeric_limits<T>::epsilon())
 		{
 			vec.x /= vLength;
 			vec.y /= vLength;
@@ -226,44 +284,45 @@ struct Vector2D
 		return vec;
 	}
 
-	friend inline void Vec2DNormalizeInPlace(Vector2D& v)
+	friend inline void Vec2DNormalizeInPlace(Vector2DT& v)
 	{
-		double vLength = v.Length();
+		T vLength = v.Length();
 
-		if (vLength > std::numeric_limits<double>::epsilon())
+		if (vLength > std::numeric_limits<T>::epsilon())
 		{
 			v.x /= vLength;
 			v.y /= vLength;
 		}
 	}
 	
-	friend inline double Vec2DDistance(const Vector2D& v1, const Vector2D& v2)
+	friend inline T Vec2DDistance(const Vector2DT& v1, const Vector2DT& v2)
 	{
-		double ySeparation = v2.y - v1.y;
-		double xSeparation = v2.x - v1.x;
+		T ySeparation = v2.y - v1.y;
+		T xSeparation = v2.x - v1.x;
 
 		return sqrt(ySeparation * ySeparation + xSeparation * xSeparation);
 	}
 
-	friend inline double Vec2DDistanceSq(const Vector2D& v1, const Vector2D& v2)
+	friend inline T Vec2DDistanceSq(const Vector2DT& v1, const Vector2DT& v2)
 	{
-		double ySeparation = v2.y - v1.y;
-		double xSeparation = v2.x - v1.x;
+		T ySeparation = v2.y - v1.y;
+		T xSeparation = v2.x - v1.x;
 
 		return ySeparation * ySeparation + xSeparation * xSeparation;
 	}
 
-	friend inline Vector2D POINTtoVector(const POINT& p)
+#ifndef HEADLESS
+	friend inline Vector2DT POINTtoVector(const POINT& p)
 	{
-		return Vector2D(p.x, p.y);
+		return Vector2DT((T)p.x, (T)p.y);
 	}
 
-	friend inline Vector2D POINTStoVector(const POINTS& p)
+	friend inline Vector2DT POINTStoVector(const POINTS& p)
 	{
-		return Vector2D((double)p.x, (double)p.y);
+		return Vector2DT((T)p.x, (T)p.y);
 	}
 
-	friend inline POINT VectorToPOINT(const Vector2D& v)
+	friend inline POINT VectorToPOINT(const Vector2DT& v)
 	{
 		POINT p;
 		p.x = (long)v.x;
@@ -272,7 +331,7 @@ struct Vector2D
 		return p;
 	}
 
-	friend inline POINTS VectorToPOINTS(const Vector2D& v)
+	friend inline POINTS VectorToPOINTS(const Vector2DT& v)
 	{
 		POINTS p;
 		p.x = (short)v.x;
@@ -280,18 +339,30 @@ struct Vector2D
 
 		return p;
 	}
+#endif
 
-	friend inline std::ostream& operator<<(std::ostream& os, const Vector2D& rhs)
+	friend inline std::ostream& operator<<(std::ostream& os, const Vector2DT& rhs)
 	{
 		os << " " << rhs.x << " " << rhs.y;
 
 		return os;
 	}
 
-	//std::ifstream& operator>>(std::ifstream& is, Vector2D& lhs)
+	//std::ifstream& operator>>(std::ifstream& is, Vector2DT& lhs)
 	//{
 	//	is >> lhs.x >> lhs.y;
 	//
 	//	return is;
 	//}
 };
+
+// The simulation works in double precision. The float version is for bulk
+// data where memory bandwidth and vector width matter more than precision
+typedef Vector2DT<double> Vector2D;
+typedef Vector2DT<float> Vector2DF;
+
+// The scalar type of a Vector2DT. Helpers templated on the vector type take
+// their scalar arguments as this, which keeps those arguments out of template
+// argument deduction, so a float vector can still be passed a double constant
+template<class T>
+using Scalar2D = typename Vector2DT<T>::value_type;
@@ -2,9 +2,12 @@
 
 #include <fstream>
 
-#include "Public/Misc/Cgdi.h"
 #include "Public/2D/Vector2D.h"
 
+#ifndef HEADLESS
+#include "Public/Misc/Cgdi.h"
+#endif
+
 class Wall2D
 {
 protected:
@@ -39,6 +42,7 @@ public:
 	void SetTo(const Vector2D& v) { m_vB = v; CalculateNormal(); }
 	void SetNormal(const Vector2D& v) { m_vN = v; }
 
+#ifndef HEADLESS
 	// Render wall along with its info
 	virtual void Render(bool renderNormals = false) const
 	{
@@ -53,6 +57,7 @@ public:
 			gdi->Line(midX, midY, (int)(midX + (m_vN.x * 5)), (int)(midY + (m_vN.y * 5)));
 		}
 	}
+#endif
 
 	// Take info from an ifstream
 	void Read(std::ifstream& in)
@@ -0,0 +1,53 @@
+#pragma once
+
+#include <vector>
+
+#include "Public/2D/Vector2D.h"
+#include "Public/2D/Wall2D.h"
+
+//--------------------------------------------------------------------------
+// A uniform grid over a set of static walls, so a line segment such as a
+// feeler only has to be tested against the walls near it rather than all
+// of them.
+//
+// Each wall is listed in every cell it passes through. As in
+// CellSpacePartition the lists are packed into one array, so the walls of
+// cell i are m_walls[m_cellStart[i]] up to (but not including)
+// m_cellStart[i + 1]. Positions outside the grid are clamped into the
+// nearest edge cell, so walls and queries beyond the world's bounds still
+// find each other.
+//
+// The grid is built once when the walls are created and only read after
+// that, so any number of threads may query it at once.
+//--------------------------------------------------------------------------
+
+class WallGrid
+{
+private:
+
+	int m_iNumCellsX;
+	int m_iNumCellsY;
+
+	double m_dCellSize;
+
+	std::vector<int> m_cellStart;
+	std::vector<int> m_walls;
+
+	int CellCoord(double coord, int numCells) const;
+
+	// The cells covered by the bounding box of the segment from a to b
+	void CellRange(const Vector2D& a, const Vector2D& b, int& minX, int& maxX, int& minY, int& maxY) const;
+
+public:
+
+	WallGrid();
+
+	// Indexes walls over a width by height area, in square cells of the
+	// given size. Cells about as big as the longest query keep the number a
+	// query touches down to four or fewer
+	void Build(const std::vector<Wall2D>& walls, double width, double height, double cellSize);
+
+	// Fills candidates with the index of every wall that may cross the
+	// segment from a to b, in ascending order and each once only
+	void Candidates(const Vector2D& a, const Vector2D& b, std::vector<int>& candidates) const;
+};
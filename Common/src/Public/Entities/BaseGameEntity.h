@@ -3,6 +3,7 @@
 #include <vector>
 #include <string>
 #include "Public/2D/Vector2D.h"
+#include "Public/Entities/EntityManager.h"
 #include "Public/Messaging/Telegram.h"
 #include "Public/Misc/Utils.h"
 
@@ -18,7 +19,8 @@ public:
 
 private:
 
-	// Every entity has an unique identifier number
+	// Every entity has an unique identifier number, handed out by the
+	// EntityManager when it is created and given back when it is destroyed
 	int m_ID;
 
 	// Each entity has a type associated with it (health, ammo, etc)
@@ -27,15 +29,9 @@ private:
 	// Each entity has a generic flag
 	bool m_bTag;
 
-	// This is the next valid ID. Each time a BaseGameEntity is instantiated
-	// this value is always updated
-	static int m_iNextvalidID;
-
-	// This is called within the constructor to make sure the ID is set
-	// properly. It verifies that the value passed to the method is greater or 
-	// equal to the next valid ID, before setting the ID and incrementing
-	// the next valid ID
-	void SetID(int val);
+	// An ID can't be shared, so neither can an entity be copied
+	BaseGameEntity(const BaseGameEntity&) = delete;
+	BaseGameEntity& operator=(const BaseGameEntity&) = delete;
 
 protected:
 
@@ -51,54 +47,47 @@ protected:
 public:
 
 	// Default constructor
-	BaseGameEntity() = default;
+	BaseGameEntity()
+		:m_ID(EntityMgr->CreateID()),
+		m_EntityType(ET_Default),
+		m_bTag(false),
+		m_dBoundingRadius(0)
+	{}
 	
-	// Default virtual destructor
-	virtual ~BaseGameEntity() = default;
+	// Gives the ID back, making any copies of it stale
+	virtual ~BaseGameEntity();
 
-	// Set ID on constructor
+	// Set ID on constructor. The ID must be free
 	BaseGameEntity(int id)
-		:m_ID(-1),
+		:m_ID(EntityMgr->CreateID(id)),
 		m_EntityType(ET_Default),
 		m_bTag(false),
 		m_dBoundingRadius(0)
-	{ 
-		SetID(id); 
-	}
+	{}
 
 	// Another constructor with more additional parameters
 	BaseGameEntity(int entityType, Vector2D pos, double radius)
-		:m_ID(-1),
+		:m_ID(EntityMgr->CreateID()),
 		m_EntityType(entityType),
 		m_bTag(false),
 		m_vPos(pos),
 		m_vScale(Vector2D(1.0f, 1.0f)),
 		m_dBoundingRadius(radius)
-	{
-		SetID(m_iNextvalidID);
-	}
+	{}
 
 	// Another constructor with more additional parameters
 	BaseGameEntity(int entityType, Vector2D pos, double radius, Vector2D scale)
-		:m_ID(-1),
+		:m_ID(EntityMgr->CreateID()),
 		m_EntityType(entityType),
 		m_bTag(false),
 		m_vPos(pos),
 		m_vScale(scale),
 		m_dBoundingRadius(radius)
-	{
-		SetID(m_iNextvalidID);
-	}
+	{}
 
 	// Get the current ID of this entity
 	int ID() const { return m_ID; }
 
-	// This is used to grab the next valid ID
-	static int GetNextValidID() { return m_iNextvalidID; }
-
-	// This is used to reset the next ID
-	static void ResetNextValidID() { m_iNextvalidID = 0; }
-
 	// All entities must implement an update function
 	virtual void Update(double timeElapsed) = 0;
 
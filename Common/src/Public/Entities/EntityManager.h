@@ -1,25 +1,73 @@
 #pragma once
 
-#include <map>
+#include <vector>
 #include <cassert>
-#include <string>
 
 class BaseGameEntity;
 
 // Provide easy access to EntityManager
 #define EntityMgr EntityManager::Instance()
 
+//--------------------------------------------------------------------------
+// Hands out entity IDs and looks entities up by them.
+//
+// An ID is a handle made of a slot index and a generation. The slots are
+// kept in an array, so a lookup is an index and a compare. A slot is
+// reused once its entity is destroyed, but with its generation moved on,
+// so old IDs that still name it are told apart from the new one and look
+// up as nullptr instead of finding the wrong entity.
+//
+// The generation lives in the high bits, so the first ID given out for a
+// slot is just its index.
+//
+// Not thread safe; entities should be created and destroyed from one
+// thread at a time.
+//--------------------------------------------------------------------------
+
 class EntityManager
 {
 private:
 
-	typedef std::map<int, BaseGameEntity*> EntityMap;
-	
-	// To facilitate quick lookup the entites are stored in a std::map, in which
-	// pointers to entites are cross referenced by their identifying number
-	EntityMap m_EntityMap;
+	// 4M slots, each reused up to 512 times, in a non-negative int
+	static const int IndexBits = 22;
+	static const int GenerationBits = 9;
+
+	static const int IndexMask = (1 << IndexBits) - 1;
+	static const int MaxGeneration = (1 << GenerationBits) - 1;
+
+	struct Slot
+	{
+		// Null until the entity is registered
+		BaseGameEntity* m_pEntity;
+
+		// The generation of the ID the slot was last handed out with. Set
+		// to -1 once it has run out, so it matches no ID and is never reused
+		int m_iGeneration;
+
+		// The next slot on the free list
+		int m_iNextFree;
+
+		bool m_bInUse;
+
+		Slot() :m_pEntity(nullptr), m_iGeneration(0), m_iNextFree(-1), m_bInUse(false) {}
+	};
+
+	std::vector<Slot> m_slots;
+
+	// The most recently freed slot, or -1
+	int m_iFreeList;
 
-	EntityManager() = default;
+	int m_iNumInUse;
+
+	EntityManager() :m_iFreeList(-1), m_iNumInUse(0) {}
+
+	static int IndexOf(int id) { return id & IndexMask; }
+	static int GenerationOf(int id) { return id >> IndexBits; }
+	static int MakeID(int index, int generation) { return (generation << IndexBits) | index; }
+
+	// Adds slots up to and including index, putting the new ones on the
+	// free list
+	void GrowTo(int index);
 
 public:
 
@@ -29,14 +77,42 @@ public:
 
 	static EntityManager* Instance();
 
-	// This method stores a pointer to the entity in the std::map
-	// m_Entities at the index position indicated by the entity's 
-	// ID (for faster access)
+	// Reserves a free slot and returns its ID. Called by BaseGameEntity's
+	// constructor, so every entity owns an ID for as long as it exists
+	int CreateID();
+
+	// Reserves the ID given, which must be free. Lets entities be created
+	// with IDs known in advance, such as those in EntityNames.h. Slower than
+	// CreateID, so meant for a handful of named entities only
+	int CreateID(int requested);
+
+	// Frees the ID when its entity is destroyed. Any copies of it left
+	// around go stale
+	void ReleaseID(int id);
+
+	// Whether the ID belongs to an entity that still exists
+	bool IsValid(int id) const
+	{
+		const int index = IndexOf(id);
+
+		return id >= 0 && index < (int)m_slots.size() &&
+			m_slots[index].m_bInUse && m_slots[index].m_iGeneration == GenerationOf(id);
+	}
+
+	// Makes the entity reachable through its ID
 	void RegisterEntity(BaseGameEntity* pNewEntity);
 
-	// Returns a pointer to the entity with the ID given as a parameter
-	BaseGameEntity* GetEntityFromID(int id) const;
+	// Returns a pointer to the entity with the ID given as a parameter, or
+	// nullptr if it isn't registered or the ID is stale
+	BaseGameEntity* GetEntityFromID(int id) const
+	{
+		return IsValid(id) ? m_slots[IndexOf(id)].m_pEntity : nullptr;
+	}
 
-	// This method removes the entity from the list
+	// Makes the entity unreachable. Its ID stays reserved until it is
+	// destroyed
 	void RemoveEntity(BaseGameEntity* pEntity);
-};
\ No newline at end of file
+
+	// How many IDs are reserved
+	int NumEntities() const { return m_iNumInUse; }
+};
@@ -1,22 +1,22 @@
 #pragma once
 
-#include <iostream>
-#include <string>
-
 enum class EEntityName : short
 {
 	EEN_MinerBob = 1,
 	EEN_Elsa = 2
 };
 
-inline std::string GetNameOfEntity(short n)
+// The names are string literals, so they can be handed around, and logged,
+// without being copied. Takes the whole entity ID, generation included, so
+// a later entity reusing a named one's slot comes back as unknown
+inline const char* GetNameOfEntity(int id)
 {
-	switch (n)
+	switch (id)
 	{
-		case 1:
+		case (int)EEntityName::EEN_MinerBob:
 			return "Miner Bob";
 		
-		case 2:
+		case (int)EEntityName::EEN_Elsa:
 			return "Elsa";
 
 		default:
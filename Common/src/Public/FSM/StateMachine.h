@@ -34,9 +34,9 @@ public:
 	virtual ~StateMachine() = default;
 
 	// Getters
-	void CurrentState() const { return m_pCurrentState; }
-	void PreviousState() const { return m_pPreviousState; }
-	void GlobalState() const { return m_pGlobalState; }
+	State<entity_type>* CurrentState() const { return m_pCurrentState; }
+	State<entity_type>* PreviousState() const { return m_pPreviousState; }
+	State<entity_type>* GlobalState() const { return m_pGlobalState; }
 
 	// Use these methods to initialize the FSM
 	void SetCurrentState(State<entity_type>* state) { m_pCurrentState = state; }
@@ -0,0 +1,170 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+
+//--------------------------------------------------------------------------
+// An unbounded queue with one thread putting items in and one taking them
+// out, neither of which ever waits on the other.
+//
+// Items are written into blocks of a fixed size, and each block counts
+// how many of its items have been written. The reader can take anything
+// below that count. A new block is linked on whenever the last one fills
+// up. Blocks the reader has finished with are handed back to the writer
+// to reuse, so once a mailbox has grown to the traffic it sees, sending
+// allocates nothing.
+//--------------------------------------------------------------------------
+
+template<class T>
+class Mailbox
+{
+private:
+
+	static const size_t BlockSize = 64;
+
+	struct Block
+	{
+		T m_items[BlockSize];
+
+		// How many of the items have been written
+		std::atomic<size_t> m_iCount;
+
+		std::atomic<Block*> m_pNext;
+
+		Block() :m_iCount(0), m_pNext(nullptr) {}
+	};
+
+	// Owned by the writer: the block being written to and the blocks it can
+	// reuse
+	Block* m_pTail;
+	Block* m_pSpare;
+
+	// Owned by the reader: the block being read and how far into it
+	Block* m_pHead;
+	size_t m_iHeadIndex;
+
+	// Blocks the reader has finished with, waiting for the writer to take
+	// them all at once
+	std::atomic<Block*> m_pReturned;
+
+	Mailbox(const Mailbox&) = delete;
+	Mailbox& operator=(const Mailbox&) = delete;
+
+	//----------------------- NewBlock -----------------------------------------
+	//---------------------------------------------------------------------------
+
+	Block* NewBlock()
+	{
+		if (m_pSpare == nullptr)
+		{
+			m_pSpare = m_pReturned.exchange(nullptr, std::memory_order_acquire);
+		}
+
+		if (m_pSpare == nullptr) return new Block();
+
+		Block* block = m_pSpare;
+		m_pSpare = block->m_pNext.load(std::memory_order_relaxed);
+
+		block->m_iCount.store(0, std::memory_order_relaxed);
+		block->m_pNext.store(nullptr, std::memory_order_relaxed);
+
+		return block;
+	}
+
+	//----------------------- ReturnBlock --------------------------------------
+	//---------------------------------------------------------------------------
+
+	void ReturnBlock(Block* block)
+	{
+		Block* head = m_pReturned.load(std::memory_order_relaxed);
+
+		do
+		{
+			block->m_pNext.store(head, std::memory_order_relaxed);
+		}
+		while (!m_pReturned.compare_exchange_weak(head, block, std::memory_order_release, std::memory_order_relaxed));
+	}
+
+	static void DeleteList(Block* block)
+	{
+		while (block)
+		{
+			Block* next = block->m_pNext.load(std::memory_order_relaxed);
+
+			delete block;
+
+			block = next;
+		}
+	}
+
+public:
+
+	Mailbox()
+		:m_pSpare(nullptr),
+		m_iHeadIndex(0),
+		m_pReturned(nullptr)
+	{
+		m_pTail = m_pHead = new Block();
+	}
+
+	~Mailbox()
+	{
+		DeleteList(m_pHead);
+		DeleteList(m_pSpare);
+		DeleteList(m_pReturned.load());
+	}
+
+	//----------------------- Push ---------------------------------------------
+	// Only to be called by the writing thread
+	//---------------------------------------------------------------------------
+
+	void Push(const T& item)
+	{
+		size_t count = m_pTail->m_iCount.load(std::memory_order_relaxed);
+
+		if (count == BlockSize)
+		{
+			Block* block = NewBlock();
+
+			m_pTail->m_pNext.store(block, std::memory_order_release);
+			m_pTail = block;
+
+			count = 0;
+		}
+
+		m_pTail->m_items[count] = item;
+		m_pTail->m_iCount.store(count + 1, std::memory_order_release);
+	}
+
+	//----------------------- Drain --------------------------------------------
+	// Calls take with every item pushed so far, in the order they were
+	// pushed. Only to be called by the reading thread
+	//---------------------------------------------------------------------------
+
+	template<class Callback>
+	void Drain(Callback take)
+	{
+		for (;;)
+		{
+			const size_t count = m_pHead->m_iCount.load(std::memory_order_acquire);
+
+			while (m_iHeadIndex < count)
+			{
+				take(m_pHead->m_items[m_iHeadIndex++]);
+			}
+
+			if (m_iHeadIndex < BlockSize) return;
+
+			// The writer has moved on once it links a new block, so this
+			// one can be given back
+			Block* next = m_pHead->m_pNext.load(std::memory_order_acquire);
+
+			if (next == nullptr) return;
+
+			ReturnBlock(m_pHead);
+
+			m_pHead = next;
+			m_iHeadIndex = 0;
+		}
+	}
+};
@@ -1,33 +1,103 @@
 #pragma once
 
-#include <set>
-#include "Public/Misc/ConsoleUtils.h"
+#include <vector>
+#include <memory>
+#include <mutex>
+#include <atomic>
+#include <cstdint>
+
+#include "Public/Misc/TimingWheel.h"
+#include "Mailbox.h"
 #include "Telegram.h"
+#include "TelegramCoalescer.h"
 
 class BaseGameEntity;
 
 // to make code easier to read
 const double SEND_MSG_INMEDIATELY = 0.0f;
-const int NO_ADDITIONAL_INFO = 0;
+const TelegramPayload NO_ADDITIONAL_INFO;
 
 // to make life easier ...
 #define Dispatch MessageDispatcher::Instance()
 
+//--------------------------------------------------------------------------
+// Routes telegrams between entities.
+//
+// Sending never calls into the receiver. Each thread that sends gets a
+// mailbox of its own to post into without locking, so agents can send
+// while they are being updated in parallel. DispatchDelayedMessages is the
+// frame boundary: it gathers what every mailbox holds, files the delayed
+// telegrams, and delivers the ones that are due on the calling thread.
+//
+// Telegrams are stamped with the time of the frame they were sent in, and
+// each mailbox numbers the telegrams posted to it, so the order they are
+// merged in, (time, sender, sequence), doesn't depend on which thread ran
+// which agent. They are then delivered grouped by receiver, each receiver
+// getting its telegrams in that same order.
+//--------------------------------------------------------------------------
+
 class MessageDispatcher
 {
 private:
 
-	// A std::set is used as the container for the delayed messages
-	// because of the benefit of automatic sorting and avoidance
-	// of duplicates. messages are sorted by their dispatch time.
-	std::set<Telegram> priorityQueue;
+	// A telegram on its way, with what is needed to order it
+	struct Envelope
+	{
+		Telegram m_telegram;
+
+		// Posted by the same mailbox in this order
+		uint64_t m_iSequence;
+
+		bool m_bDelayed;
+
+		Envelope() :m_iSequence(0), m_bDelayed(false) {}
+	};
+
+	struct SenderMailbox
+	{
+		Mailbox<Envelope> m_queue;
+
+		// Only touched by the thread the mailbox belongs to
+		uint64_t m_iNextSequence;
+
+		SenderMailbox() :m_iNextSequence(0) {}
+	};
+
+	// Every thread's mailbox. The list is only locked when a thread sends
+	// for the first time and at the frame boundary
+	std::vector<std::unique_ptr<SenderMailbox>> m_mailboxes;
+	std::mutex m_mailboxesMutex;
 
-	// This method is utilized by DispatchMessage or DispatchDelayedMessages.
+	// The time telegrams sent now are stamped with
+	std::atomic<double> m_dFrameTime;
+
+	// The delayed messages, waiting for their dispatch time in a timing
+	// wheel with ticks of a millisecond. Queuing and expiring a message
+	// are constant time, and they come out sorted by their dispatch time
+	TimingWheel<Envelope> m_delayedTelegrams;
+
+	// Drops delayed messages that duplicate one already waiting
+	TelegramCoalescer m_coalescer;
+
+	// Scratch space for the frame boundary, kept to avoid reallocating
+	std::vector<Envelope> m_incoming;
+	std::vector<Envelope> m_due;
+
+	// The calling thread's mailbox, created the first time it is needed
+	SenderMailbox* LocalMailbox();
+
+	// Moves what the mailboxes hold into m_incoming, in merge order
+	void GatherMailboxes();
+
+	// Delivers m_due grouped by receiver
+	void DeliverDue();
+
+	// This method is utilized by DispatchDelayedMessages.
 	// This method calls the message handling member function of the receiving
 	// entity, pReceiver, with the newly created telegram
 	void Discharge(BaseGameEntity* pReceiver, const Telegram& msg);
 
-	MessageDispatcher() = default;
+	MessageDispatcher();
 
 public:
 
@@ -39,8 +109,23 @@ public:
 	static MessageDispatcher* Instance();
 
 	// Send a message to another agent. Receiving agent is referenced by ID.
-	void DispatchCustomMessage(double delay, int sender, int receiver, EMessageType msg, void* extraInfo);
+	// Safe to call from any thread. The message is delivered by the next call
+	// to DispatchDelayedMessages, or once its delay has passed. Any trivially
+	// copyable value that fits in a TelegramPayload can go along with it
+	void DispatchCustomMessage(double delay, int sender, int receiver, EMessageType msg, const TelegramPayload& extraInfo = NO_ADDITIONAL_INFO);
 
-	// Send out any delayed messages. This method is called each time through the main game loop.
+	// Send out the messages sent since the last call and any delayed messages
+	// that have come due. This method is called each time through the main
+	// game loop, from one thread. Messages sent by the receivers are delivered
+	// in further rounds before it returns. Other threads may keep sending, but
+	// the order is only deterministic if they are idle meanwhile
 	void DispatchDelayedMessages();
+
+	// Chooses how duplicate delayed messages are treated. By default one that
+	// matches a waiting message's sender, receiver and type is dropped if
+	// they are due within the same window of smallestDelay seconds. Messages
+	// already waiting are checked against under the new policy too, but any
+	// duplicates among them are still delivered. Call it from the thread
+	// that calls DispatchDelayedMessages
+	void SetCoalescingPolicy(ECoalescingPolicy policy, double windowLength = smallestDelay);
 };
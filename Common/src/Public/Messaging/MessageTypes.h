@@ -1,7 +1,5 @@
 #pragma once
 
-#include <string>
-
 enum class EMessageType : short
 {
 	EMT_NoMessage = 0,
@@ -9,7 +7,8 @@ enum class EMessageType : short
 	EMT_StewReady = 2
 };
 
-inline std::string EMsgTypeToStr(const EMessageType& emt)
+// As with GetNameOfEntity, the names are string literals
+inline const char* EMsgTypeToStr(const EMessageType& emt)
 {
 	switch (emt)
 	{
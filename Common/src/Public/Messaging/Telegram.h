@@ -1,6 +1,7 @@
 #pragma once
 
 #include "MessageTypes.h"
+#include "TelegramPayload.h"
 
 #include <iostream>
 #include <math.h>
@@ -23,19 +24,19 @@ struct Telegram
 	// amount of time.
 	double dispatchTime;
 
-	// Any additional information that may accompany the message
-	void* extraInfo;
+	// Any additional information that may accompany the message, held by
+	// value so it lives as long as the telegram does
+	TelegramPayload extraInfo;
 
 	// Custom Telegram constructors
 	Telegram()
 		: sender(-1),
 		receiver(-1),
 		msg(EMessageType::EMT_NoMessage),
-		dispatchTime(-1),
-		extraInfo(nullptr)
+		dispatchTime(-1)
 	{}
 
-	Telegram(double time, int sender, int receiver, EMessageType msg, void* info = nullptr)
+	Telegram(double time, int sender, int receiver, EMessageType msg, const TelegramPayload& info = TelegramPayload())
 		: sender(sender),
 		receiver(receiver),
 		msg(msg),
@@ -44,28 +45,11 @@ struct Telegram
 	{}
 };
 
-// These telegrams will be stored in a priority queue. Therefore, the >
-// operator needs to be overloaded so that the PQ can sort the telegram
-// by the time priority. Note how the times must be smaller than
-// SmallestDelay apart before two telegram are considered unique
+// Delayed telegrams from the same sender to the same receiver with the same
+// message are treated as duplicates when they fall due within a window this
+// many seconds long. See TelegramCoalescer
 const double smallestDelay = 0.25;
 
-inline bool operator==(const Telegram& t1, const Telegram& t2)
-{
-	return (fabs(t1.dispatchTime - t2.dispatchTime) < smallestDelay) &&
-		(t1.sender == t2.sender) &&
-		(t1.receiver == t2.receiver) &&
-		(t1.msg == t2.msg);
-}
-
-inline bool operator<(const Telegram& t1, const Telegram& t2)
-{
-	if (t1 == t2)
-		return false;
-	else
-		return t1.dispatchTime < t2.dispatchTime;
-}
-
 inline std::ostream& operator<<(std::ostream& os, const Telegram& t)
 {
 	os << "time: " << t.dispatchTime << " Sender: " << t.sender
@@ -73,11 +57,3 @@ inline std::ostream& operator<<(std::ostream& os, const Telegram& t)
 
 	return os;
 }
-
-// Helper function for dereferencing the extraInfo field of the telegram
-// to the required type
-template <class T>
-inline T DereferenceToType(void* p)
-{
-	return static_cast<T>(p);
-}
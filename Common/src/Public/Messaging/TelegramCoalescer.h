@@ -0,0 +1,86 @@
+#pragma once
+
+#include <vector>
+#include <cstdint>
+
+#include "Telegram.h"
+
+// How duplicate delayed telegrams are treated
+enum class ECoalescingPolicy : short
+{
+	// Every telegram is delivered
+	ECP_None = 0,
+
+	// A telegram is dropped if one with the same sender, receiver and
+	// message is already waiting to be delivered in the same window of time.
+	// The payloads aren't compared; the waiting telegram's is the one kept
+	ECP_SameWindow = 1
+};
+
+//--------------------------------------------------------------------------
+// Keeps track of the delayed telegrams waiting to be delivered so that
+// duplicates can be dropped.
+//
+// Windows are fixed: window w covers the dispatch times from w * length up
+// to (w + 1) * length. Two telegrams are duplicates if they have the same
+// sender, receiver and message and are due in the same window. This takes
+// the place of comparing dispatch times with a tolerance, which isn't
+// transitive and so could never key a container reliably.
+//
+// The waiting telegrams are kept in an open addressing hash table, so
+// checking and forgetting one are constant time and, once the table has
+// grown to fit, allocate nothing.
+//--------------------------------------------------------------------------
+
+class TelegramCoalescer
+{
+private:
+
+	struct Entry
+	{
+		int m_iSender;
+		int m_iReceiver;
+		EMessageType m_msg;
+		long long m_iWindow;
+
+		uint64_t m_iHash;
+		bool m_bUsed;
+
+		Entry() :m_iSender(-1), m_iReceiver(-1), m_msg(EMessageType::EMT_NoMessage), m_iWindow(0), m_iHash(0), m_bUsed(false) {}
+	};
+
+	// Always a power of two in size, and never more than half full
+	std::vector<Entry> m_table;
+	size_t m_iCount;
+
+	ECoalescingPolicy m_policy;
+	double m_dWindowLength;
+
+	// Fills in the key fields and hash of entry for a telegram
+	void MakeKey(const Telegram& telegram, Entry& entry) const;
+
+	// The slot holding an entry with the same key, or the empty slot where
+	// it would go
+	size_t Find(const Entry& key) const;
+
+	void Grow();
+
+public:
+
+	explicit TelegramCoalescer(ECoalescingPolicy policy = ECoalescingPolicy::ECP_SameWindow, double windowLength = smallestDelay);
+
+	// Changing the policy forgets every waiting telegram
+	void SetPolicy(ECoalescingPolicy policy, double windowLength);
+
+	ECoalescingPolicy Policy() const { return m_policy; }
+	double WindowLength() const { return m_dWindowLength; }
+
+	// Records a telegram that is about to be queued. Returns false, recording
+	// nothing, if it duplicates one that is already waiting
+	bool Add(const Telegram& telegram);
+
+	// Forgets a telegram that has been delivered
+	void Remove(const Telegram& telegram);
+
+	void Clear();
+};
@@ -0,0 +1,108 @@
+#pragma once
+
+#include <cassert>
+#include <cstddef>
+#include <cstring>
+#include <type_traits>
+
+//--------------------------------------------------------------------------
+// The extra information a telegram carries, stored by value inside it.
+//
+// Any trivially copyable type of up to Capacity bytes can be put in, and
+// is copied along with the telegram, so a delayed telegram's payload needs
+// no allocation and can't be left dangling. The payload remembers its type,
+// and reading it back as a different one asserts.
+//
+// Larger data should be sent as an index or handle to where it is kept.
+//--------------------------------------------------------------------------
+
+class TelegramPayload
+{
+public:
+
+	// Leaves a telegram at 56 bytes, within a cache line
+	static const size_t Capacity = 24;
+
+private:
+
+	// One of these exists per type put in a payload, and its address tells
+	// the types apart. Not const, as identical read-only data may be folded
+	// together by the linker (/OPT:ICF) and the addresses would then match
+	template<class T>
+	struct TypeTag
+	{
+		static char m_id;
+	};
+
+	alignas(8) unsigned char m_data[Capacity];
+
+	// Null when there is no payload
+	const char* m_pType;
+
+	template<class T>
+	static void CheckType()
+	{
+		static_assert(std::is_trivially_copyable<T>::value, "<TelegramPayload>: payloads are copied bytewise, so must be trivially copyable");
+		static_assert(sizeof(T) <= Capacity, "<TelegramPayload>: payload too big to store inline");
+		static_assert(alignof(T) <= 8, "<TelegramPayload>: payload too strictly aligned");
+	}
+
+public:
+
+	TelegramPayload() :m_data(), m_pType(nullptr) {}
+
+	// Not explicit, so a value can be passed wherever a payload is expected
+	template<class T, class = typename std::enable_if<!std::is_same<typename std::decay<T>::type, TelegramPayload>::value>::type>
+	TelegramPayload(const T& value)
+		:m_data()
+	{
+		Set(value);
+	}
+
+	template<class T>
+	void Set(const T& value)
+	{
+		CheckType<T>();
+
+		std::memcpy(m_data, &value, sizeof(T));
+
+		m_pType = &TypeTag<T>::m_id;
+	}
+
+	bool Empty() const { return m_pType == nullptr; }
+
+	template<class T>
+	bool Is() const { return m_pType == &TypeTag<T>::m_id; }
+
+	// Returns a copy of the value, which must be of type T
+	template<class T>
+	T Get() const
+	{
+		CheckType<T>();
+
+		assert(Is<T>() && "<TelegramPayload::Get>: payload is of another type");
+
+		T value;
+		std::memcpy(&value, m_data, sizeof(T));
+
+		return value;
+	}
+
+	// Copies the value into value and returns true if it is of type T
+	template<class T>
+	bool TryGet(T& value) const
+	{
+		CheckType<T>();
+
+		if (!Is<T>()) return false;
+
+		std::memcpy(&value, m_data, sizeof(T));
+
+		return true;
+	}
+
+	void Clear() { m_pType = nullptr; }
+};
+
+template<class T>
+char TelegramPayload::TypeTag<T>::m_id = 0;
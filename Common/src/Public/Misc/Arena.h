@@ -0,0 +1,113 @@
+#pragma once
+
+#include <cstddef>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+//--------------------------------------------------------------------------
+// A bump allocator for objects that all live and die together, such as the
+// agents of a world and their components.
+//
+// Objects are placed one after another in large chunks, so things created
+// together end up next to each other in memory. They can't be freed one at
+// a time. Instead Rewind destroys everything at once, newest first, and
+// keeps the chunks so the next batch of objects costs no allocations.
+//
+// Objects that need their destructor run are threaded onto a list stored
+// in the arena itself, so nothing else is allocated to keep track of them.
+//
+// An arena is not thread safe; create objects from one thread at a time.
+//--------------------------------------------------------------------------
+
+class Arena
+{
+private:
+
+	// The header at the start of each block of memory. The usable memory
+	// follows it
+	struct Chunk
+	{
+		Chunk* m_pNext;
+		size_t m_iSize;
+	};
+
+	// The chunk header padded so the memory after it is suitably aligned
+	// for anything
+	static const size_t ChunkHeaderSize;
+
+	// Stored just ahead of each object that has a destructor to run
+	struct Finalizer
+	{
+		void (*m_pDestroy)(void*);
+		void* m_pObject;
+		Finalizer* m_pPrev;
+	};
+
+	// The size given to new chunks, unless an allocation needs more
+	size_t m_iChunkSize;
+
+	Chunk* m_pFirst;
+	Chunk* m_pCurrent;
+
+	// The free part of the current chunk
+	char* m_pCursor;
+	char* m_pEnd;
+
+	// The most recently created object that needs destroying
+	Finalizer* m_pFinalizers;
+
+	size_t m_iBytesUsed;
+
+	Arena(const Arena&) = delete;
+	Arena& operator=(const Arena&) = delete;
+
+	// Moves on to a chunk with at least size bytes free, reusing a chunk
+	// left over from before the last rewind if it's big enough
+	void NextChunk(size_t size);
+
+	template<class T>
+	static void Destroy(void* object) { static_cast<T*>(object)->~T(); }
+
+public:
+
+	explicit Arena(size_t chunkSize = 64 * 1024);
+
+	~Arena();
+
+	// Returns size bytes aligned to align, which must be a power of two
+	void* Allocate(size_t size, size_t align);
+
+	// Constructs a T in the arena. Its destructor runs when the arena is
+	// rewound or destroyed
+	template<class T, class... Args>
+	T* New(Args&&... args)
+	{
+		Finalizer* finalizer = nullptr;
+
+		if (!std::is_trivially_destructible<T>::value)
+		{
+			finalizer = static_cast<Finalizer*>(Allocate(sizeof(Finalizer), alignof(Finalizer)));
+		}
+
+		T* object = new (Allocate(sizeof(T), alignof(T))) T(std::forward<Args>(args)...);
+
+		if (finalizer)
+		{
+			finalizer->m_pDestroy = &Destroy<T>;
+			finalizer->m_pObject = object;
+			finalizer->m_pPrev = m_pFinalizers;
+
+			m_pFinalizers = finalizer;
+		}
+
+		return object;
+	}
+
+	// Destroys every object, newest first, and makes all of the memory
+	// available again
+	void Rewind();
+
+	// How many bytes have been handed out since the last rewind
+	size_t BytesUsed() const { return m_iBytesUsed; }
+};
@@ -1,24 +1,23 @@
 #pragma once
 
 #include <vector>
-#include <list>
+#include <algorithm>
 #include <iterator>
 #include <cassert>
+#include <cmath>
 
 #include "Public/2D/Vector2D.h"
 #include "Public/2D/InvertedAABox2D.h"
 #include "Public/Misc/Utils.h"
+#include "Public/Misc/Profiler.h"
 
 //--------------------------------------------------------------------------
-// Defines a cell containing a list of pointers to entities
+// Defines a cell of the partition. Cells don't own their members; the
+// entities in a cell are a contiguous run of the partition's sorted array
 //--------------------------------------------------------------------------
 
-template<class Entity>
 struct Cell
 {
-	// All the entities inhabiting this cell
-	std::list<Entity> m_members;
-
 	// The cell's bounding box (it's inverted because the Window's default 
 	// co-ordinate system has a y axis that increases as it descends)
 	InvertedAABox2D m_bBox;
@@ -32,18 +31,66 @@ struct Cell
 // entities, fast proximity querys can be made by calling the CalculateNeighbours
 // method with a position and proximity radius.
 //
-// If an entity is capable of moving, and therefore capable of moving between
-// cells, the Update method should be called each update-cycle to synchronize
-// the entity and the cell space it occupies.
+// The members of every cell live in one flat array, so the members of cell i
+// are m_sorted[m_cellStart[i]] up to (but not including) m_cellStart[i] +
+// m_cellCount[i]. Each cell owns the slots up to m_cellStart[i + 1], which
+// leaves it some room to grow. Rebuild counting-sorts every entity by cell to
+// lay the array out afresh, which keeps the neighbor scans walking
+// contiguous memory.
+//
+// Update, called once per update-cycle, keeps the array current more
+// cheaply. Each entity remembers its cell and slot, so one that stays in its
+// cell costs a single store. One that moves is swap-removed from its old
+// cell and appended to its new one. Only when a cell runs out of room is the
+// whole array rebuilt.
+//
+// Queries test the positions the entities had at the last Update.
+// Entities are also known by the order they were added in, so a caller that
+// keeps its own per-entity arrays in the same order can ask for indices
+// instead of entities.
+//
+// T is the precision those positions are stored and tested in. A float
+// partition reads half the memory per query, at the cost of deciding
+// borderline neighbors to float precision
 //--------------------------------------------------------------------------
 
-template<class Entity>
+template<class Entity, class T = double>
 class CellSpacePartition
 {
 private:
 
 	// The required amount of cells in the space
-	std::vector<Cell<Entity>> m_cells;
+	std::vector<Cell> m_cells;
+
+	// Every entity registered with the partition, in insertion order
+	std::vector<Entity> m_entities;
+
+	// The cell each entity of m_entities is in, and its slot in m_sorted
+	std::vector<int> m_entityCells;
+	std::vector<int> m_entitySlots;
+
+	// The entities grouped by cell, and the offset of each cell's first slot
+	// within that array. m_cellStart has one extra entry so that the end of
+	// the last cell can be read the same way as any other
+	std::vector<Entity> m_sorted;
+	std::vector<int> m_cellStart;
+
+	// How many of each cell's slots are in use
+	std::vector<int> m_cellCount;
+
+	// The insertion index and position of each entity of m_sorted, captured
+	// by the last update
+	std::vector<int> m_sortedIndex;
+	std::vector<Vector2DT<T>> m_sortedPos;
+
+	// Scratch space used while scattering the entities into m_sorted
+	std::vector<int> m_cellCursor;
+
+	// The fewest spare slots a cell is given when the array is laid out
+	static const int MinCellSlack = 8;
+
+	// True when entities have been added or removed since the last rebuild
+	bool m_bDirty;
 
 	// This is used to store any valid neighbors when an agent searches
 	// its neighboring space
@@ -64,6 +111,22 @@ private:
 	double m_dCellSizeX;
 	double m_dCellSizeY;
 
+	//----------------------- CellCoord ----------------------------------------
+	// Returns the column (or row) of the cell containing the given coordinate,
+	// clamped to the grid so positions on or outside the border are binned
+	// into the nearest edge cell
+	//---------------------------------------------------------------------------
+
+	static inline int CellCoord(double coord, double cellSize, int numCells)
+	{
+		int c = (int)std::floor(coord / cellSize);
+
+		if (c < 0) return 0;
+		if (c > numCells - 1) return numCells - 1;
+
+		return c;
+	}
+
 	//----------------------- PositionToIndex -----------------------------------
 	// Given a 2D vector representing a position within the game world, this
 	// method calculates an index into its appropriate cell
@@ -71,26 +134,19 @@ private:
 
 	inline size_t PositionToIndex(const Vector2D& pos) const
 	{
-		size_t idx =
-			(int)(m_iNumCellsX * pos.x / m_dSpaceWidth) +
-			((int)(m_iNumCellsY * pos.y / m_dSpaceHeight) * m_iNumCellsX);
-
-		// If the entity's position is equal to vector2d(m_dSpaceWidth, m_dSpaceHeight)
-		// then the index will overshoot. We need to check for this and adjust
-		if (idx > m_cells.size() - 1) idx = m_cells.size() - 1;
-
-		return idx;
+		return CellCoord(pos.x, m_dCellSizeX, m_iNumCellsX) +
+			CellCoord(pos.y, m_dCellSizeY, m_iNumCellsY) * m_iNumCellsX;
 	}
 
 public:
 
 	// Main ctor
 	CellSpacePartition(double width, double height, int cellsX, int cellsY, int maxEntities)
-		:m_dSpaceWidth(width),
+		:m_bDirty(false),
+		m_dSpaceWidth(width),
 		m_dSpaceHeight(height),
 		m_iNumCellsX(cellsX),
-		m_iNumCellsY(cellsY),
-		m_neighbors(maxEntities, Entity())
+		m_iNumCellsY(cellsY)
 	{
 		// Calculate bounds of each cell
 		m_dCellSizeX = width / cellsX;
@@ -106,84 +162,265 @@ public:
 				double top = y * m_dCellSizeY;
 				double bottom = top + m_dCellSizeY;
 
-				m_cells.push_back(Cell<Entity>(Vector2D(left, top), Vector2D(right, bottom)));
+				m_cells.push_back(Cell(Vector2D(left, top), Vector2D(right, bottom)));
 			}
 		}
+
+		m_cellStart.assign(m_cells.size() + 1, 0);
+		m_cellCount.assign(m_cells.size(), 0);
+		m_cellCursor.assign(m_cells.size(), 0);
+
+		m_entities.reserve(maxEntities);
+		m_entityCells.reserve(maxEntities);
+		m_entitySlots.reserve(maxEntities);
+		m_sorted.reserve(maxEntities);
+		m_neighbors.reserve(maxEntities + 1);
 	}
 
 	//----------------------- AddEntity --------------------------------------
-	// Used to add the entities into the data structure
+	// Used to add the entities into the data structure. The entity becomes
+	// visible to queries after the next rebuild
 	//------------------------------------------------------------------------
 
 	inline void AddEntity(const Entity& entity)
 	{
 		assert(entity);
 
-		size_t sz = m_cells.size();
-		size_t idx = PositionToIndex(entity->Pos());
+		m_entities.push_back(entity);
 
-		m_cells[idx].m_members.push_back(entity);
+		m_bDirty = true;
 	}
 
 	//----------------------- UpdateEntity -----------------------------------
-	// Checks to see if an entity has moved cells. If so, the data structure
-	// is updated accordingly
+	// Moves the entity with the given insertion index to the cell it is in
+	// now and records its position. Returns false, changing nothing, if the
+	// new cell has no room for it
+	//------------------------------------------------------------------------
+
+	inline bool UpdateEntity(size_t index)
+	{
+		const Vector2D pos = m_entities[index]->Pos();
+		const int cell = (int)PositionToIndex(pos);
+		const int oldCell = m_entityCells[index];
+		const int slot = m_entitySlots[index];
+
+		if (cell == oldCell)
+		{
+			m_sortedPos[slot] = Vector2DT<T>(pos);
+
+			return true;
+		}
+
+		if (m_cellCount[cell] == m_cellStart[cell + 1] - m_cellStart[cell]) return false;
+
+		// Fill the hole with the old cell's last member
+		const int last = m_cellStart[oldCell] + --m_cellCount[oldCell];
+
+		m_sorted[slot] = m_sorted[last];
+		m_sortedIndex[slot] = m_sortedIndex[last];
+		m_sortedPos[slot] = m_sortedPos[last];
+		m_entitySlots[m_sortedIndex[slot]] = slot;
+
+		// And append to the new cell
+		const int newSlot = m_cellStart[cell] + m_cellCount[cell]++;
+
+		m_sorted[newSlot] = m_entities[index];
+		m_sortedIndex[newSlot] = (int)index;
+		m_sortedPos[newSlot] = Vector2DT<T>(pos);
+
+		m_entityCells[index] = cell;
+		m_entitySlots[index] = newSlot;
+
+		return true;
+	}
+
+	//----------------------- Update -----------------------------------------
+	// Brings every entity's cell and position up to date. Call once per
+	// update-cycle, before any neighbor queries are made. The entities are
+	// visited in insertion order, so the layout it leaves, and the order
+	// queries find neighbors in, is reproducible
 	//------------------------------------------------------------------------
 
-	inline void UpdateEntity(const Entity& entity, Vector2D& oldPos)
+	inline void Update()
 	{
-		// If the index for the old pos and the new pos are not equal then the entity
-		// has moved to another cell
-		size_t oldIdx = PositionToIndex(oldPos);
-		size_t newIdx = PositionToIndex(entity->Pos());
+		if (m_bDirty)
+		{
+			Rebuild();
 
-		if (newIdx == oldIdx) return;
+			return;
+		}
 
-		// The entity has moved into another cell so delete from current cell and
-		// add to new one
-		m_cells[oldIdx].m_members.remove(entity);
-		m_cells[newIdx].m_members.push_back(entity);
+		for (size_t i = 0; i < m_entities.size(); ++i)
+		{
+			if (!UpdateEntity(i))
+			{
+				// A cell is full. Rebuilding resizes every cell to suit
+				Rebuild();
+
+				return;
+			}
+		}
 	}
 
-	//----------------------- CalculateNeighbors -----------------------------------
-	// This must be called to create the vector of neighbors. This method
-	// examines each cell within range of the target, if the cells contain
-	// entities then they're tested to see if they're situated within the 
-	// target's neighborhood region. If they are added to neighbor list
-	//----------------------------------------------------------------------
+	//----------------------- Rebuild ----------------------------------------
+	// Bins every entity into its current cell with a counting sort, giving
+	// each cell room for some more members than it has
+	//------------------------------------------------------------------------
 
-	inline void CalculateNeighbors(const Vector2D& targetPos, double queryRadius)
+	inline void Rebuild()
+	{
+		PROFILE_COUNT("CellSpaceRebuilds", 1);
+
+		const size_t numEntities = m_entities.size();
+
+		m_entityCells.resize(numEntities);
+		m_entitySlots.resize(numEntities);
+
+		// Count the members of each cell
+		std::fill(m_cellCount.begin(), m_cellCount.end(), 0);
+
+		for (size_t i = 0; i < numEntities; ++i)
+		{
+			int cell = (int)PositionToIndex(m_entities[i]->Pos());
+
+			m_entityCells[i] = cell;
+			++m_cellCount[cell];
+		}
+
+		// Lay the cells out one after the other, each with room to grow by
+		// half again plus MinCellSlack. With flocks of a few dozen that is
+		// enough for most frames to need no rebuild
+		m_cellStart[0] = 0;
+
+		for (size_t c = 0; c < m_cellCount.size(); ++c)
+		{
+			m_cellStart[c + 1] = m_cellStart[c] + m_cellCount[c] + m_cellCount[c] / 2 + MinCellSlack;
+		}
+
+		const size_t numSlots = m_cellStart.back();
+
+		m_sorted.assign(numSlots, Entity());
+		m_sortedIndex.assign(numSlots, -1);
+		m_sortedPos.resize(numSlots);
+
+		// Scatter the entities into their cells, each cell starting out in
+		// insertion order. Later moves swap-remove, so from then on the order
+		// depends on the sequence of moves; it stays reproducible only
+		// because Update visits the entities in insertion order
+		std::copy(m_cellStart.begin(), m_cellStart.end() - 1, m_cellCursor.begin());
+
+		for (size_t i = 0; i < numEntities; ++i)
+		{
+			const int slot = m_cellCursor[m_entityCells[i]]++;
+
+			m_sorted[slot] = m_entities[i];
+			m_sortedIndex[slot] = (int)i;
+			m_sortedPos[slot] = Vector2DT<T>(m_entities[i]->Pos());
+
+			m_entitySlots[i] = slot;
+		}
+
+		m_bDirty = false;
+	}
+
+	//----------------------- ForEachInRange ---------------------------------------
+	// Calls visit with the sorted slot of every entity within queryRadius of
+	// targetPos. This method examines each cell within range of the target, if
+	// the cells contain entities then they're tested to see if they're situated
+	// within the target's neighborhood region.
+	//
+	// The partition is only read, so any number of threads may query it at
+	// once as long as each supplies its own buffer and nobody is updating it
+	//-------------------------------------------------------------------------------
+
+	template<class Visitor>
+	inline void ForEachInRange(const Vector2D& targetPos, double queryRadius, Visitor visit) const
 	{
-		// Create an iterator and set it to the beginning of the neighbor vector
-		typename std::vector<Entity>::iterator curNeighbor = m_neighbors.begin();
-
-		// Create the query box that is the bounding box of the target's query area
-		InvertedAABox2D queryBox(
-			targetPos - Vector2D(queryRadius, queryRadius),
-			targetPos + Vector2D(queryRadius, queryRadius)
-		);
-
-		// Iterate through each cell and test to see if its bounding box overlaps with the query box. 
-		// If it does and it also contains entities then make further proximity tests
-		typename std::vector<Cell<Entity>>::iterator curCell;
-		for (curCell = m_cells.begin(); curCell != m_cells.end(); ++curCell)
+		assert(!m_bDirty && "<CellSpacePartition::ForEachInRange>: entities were added or removed since the last Rebuild");
+
+		const Vector2DT<T> target(targetPos);
+		const T queryRadiusSq = (T)(queryRadius * queryRadius);
+
+		// Work out the range of cells the query box covers. Only those cells
+		// can hold neighbors, so the cost of a query depends on its radius
+		// rather than on the resolution of the grid
+		const int minX = CellCoord(targetPos.x - queryRadius, m_dCellSizeX, m_iNumCellsX);
+		const int maxX = CellCoord(targetPos.x + queryRadius, m_dCellSizeX, m_iNumCellsX);
+		const int minY = CellCoord(targetPos.y - queryRadius, m_dCellSizeY, m_iNumCellsY);
+		const int maxY = CellCoord(targetPos.y + queryRadius, m_dCellSizeY, m_iNumCellsY);
+
+#ifdef PROFILING
+		int candidates = 0;
+		int found = 0;
+#endif
+
+		for (int y = minY; y <= maxY; ++y)
 		{
-			// Test to see if this cell contains members and if it overlaps the query box
-			if ((*curCell).m_bBox.IsOverlappedWith(queryBox) && !(*curCell).m_members.empty())
+			for (int x = minX; x <= maxX; ++x)
 			{
-				// Add any entities found within query radius to the neighbor list
-				for (typename std::list<Entity>::iterator it = curCell->m_members.begin(); it != curCell->m_members.end(); ++it)
+				const int c = x + y * m_iNumCellsX;
+				const int end = m_cellStart[c] + m_cellCount[c];
+
+#ifdef PROFILING
+				candidates += m_cellCount[c];
+#endif
+
+				for (int i = m_cellStart[c]; i < end; ++i)
 				{
-					if (Vec2DDistanceSq((*it)->Pos(), targetPos) < (queryRadius * queryRadius))
+					if (Vec2DDistanceSq(m_sortedPos[i], target) < queryRadiusSq)
 					{
-						*curNeighbor++ = *it;
+						visit(i);
+
+#ifdef PROFILING
+						++found;
+#endif
 					}
 				}
 			}
 		}
 
+		// Counted once per query rather than per entity to keep the loop tight
+		PROFILE_COUNT("QueryCalls", 1);
+		PROFILE_COUNT("QueryCellsVisited", (maxX - minX + 1) * (maxY - minY + 1));
+		PROFILE_COUNT("QueryCandidates", candidates);
+		PROFILE_COUNT("QueryNeighbors", found);
+	}
+
+	//----------------------- CalculateNeighbors -----------------------------------
+	// Fills neighbors with every entity within queryRadius of targetPos
+	//----------------------------------------------------------------------
+
+	inline void CalculateNeighbors(const Vector2D& targetPos, double queryRadius, std::vector<Entity>& neighbors) const
+	{
+		neighbors.clear();
+
+		ForEachInRange(targetPos, queryRadius, [&](int slot) { neighbors.push_back(m_sorted[slot]); });
+	}
+
+	//----------------------- CalculateNeighborIndices -----------------------------
+	// As above, but fills neighbors with the insertion index of each entity
+	//----------------------------------------------------------------------
+
+	inline void CalculateNeighborIndices(const Vector2D& targetPos, double queryRadius, std::vector<int>& neighbors) const
+	{
+		neighbors.clear();
+
+		ForEachInRange(targetPos, queryRadius, [&](int slot) { neighbors.push_back(m_sortedIndex[slot]); });
+	}
+
+	//----------------------- CalculateNeighbors -----------------------------------
+	// As above, but stores the result in the partition itself to be walked
+	// with Begin/Next/End. Only one such query can be in flight at a time
+	//----------------------------------------------------------------------
+
+	inline void CalculateNeighbors(const Vector2D& targetPos, double queryRadius)
+	{
+		if (m_bDirty) Rebuild();
+
+		CalculateNeighbors(targetPos, queryRadius, m_neighbors);
+
 		// Mark the end of the list with a zero-null
-		*curNeighbor = nullptr;
+		m_neighbors.push_back(nullptr);
 	}
 
 	//----------------------- EmptyCells -----------------------------------
@@ -192,25 +429,24 @@ public:
 
 	inline void EmptyCells()
 	{
-		typename std::vector<Cell<Entity>>::iterator it = m_cells.begin();
+		m_entities.clear();
 
-		for (it; it != m_cells.end(); ++it)
-		{
-			(*it).m_members.clear();
-		}
+		m_bDirty = true;
 	}
 
+#ifndef HEADLESS
 	//----------------------- RenderCells -----------------------------------
 	//-----------------------------------------------------------------------
 
 	inline void RenderCells() const
 	{
-		typename std::vector<Cell<Entity>>::const_iterator curCell;
+		std::vector<Cell>::const_iterator curCell;
 		for (curCell = m_cells.cbegin(); curCell != m_cells.cend(); ++curCell)
 		{
 			(*curCell).m_bBox.Render(false);
 		}
 	}
+#endif
 
 	// Returns a reference to the entity at the front of the neighbor vector
 	inline Entity& Begin() { m_curNeighbor = m_neighbors.begin(); return *m_curNeighbor; }
@@ -4,11 +4,9 @@
 #include <string>
 #include <cassert>
 #include <iostream>
-#include <filesystem>
+#include <stdexcept>
 #include <bitset>
 
-namespace fs = std::experimental::filesystem;
-
 extern const char* BAD_FILE_ERROR;
 
 class IniFileLoaderBase
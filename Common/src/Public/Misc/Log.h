@@ -0,0 +1,217 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <atomic>
+#include <thread>
+#include <vector>
+#include <string>
+#include <iosfwd>
+
+//--------------------------------------------------------------------------
+// Structured logging that keeps formatting and I/O off the calling thread.
+//
+// Code logs through the macros at the bottom of this file, giving a level,
+// a color, a format with a {} for each argument, and up to four arguments.
+// A call copies the format pointer and the raw arguments into a fixed-size
+// record in a lock-free ring buffer and returns. A background thread takes
+// the records out, formats them and writes them to the output stream.
+//
+// Only the pointers of string arguments are kept, so they must outlive the
+// record: string literals, or names that stay put such as those returned by
+// GetNameOfEntity and EMsgTypeToStr. std::string can't be passed.
+//
+// If the buffer is full the record is dropped rather than making the caller
+// wait, and the number dropped is reported at the end.
+//
+// Levels below LOG_LEVEL are compiled out along with their arguments (see
+// the AITECHNIQUES_LOG_LEVEL CMake option). At LOG_LEVEL_OFF no logging code
+// is left at all and the writer thread is never started.
+//--------------------------------------------------------------------------
+
+#define LOG_LEVEL_TRACE 0
+#define LOG_LEVEL_DEBUG 1
+#define LOG_LEVEL_INFO 2
+#define LOG_LEVEL_WARNING 3
+#define LOG_LEVEL_ERROR 4
+#define LOG_LEVEL_OFF 5
+
+#ifndef LOG_LEVEL
+#define LOG_LEVEL LOG_LEVEL_DEBUG
+#endif
+
+enum class ELogLevel : unsigned char
+{
+	ELL_Trace = LOG_LEVEL_TRACE,
+	ELL_Debug = LOG_LEVEL_DEBUG,
+	ELL_Info = LOG_LEVEL_INFO,
+	ELL_Warning = LOG_LEVEL_WARNING,
+	ELL_Error = LOG_LEVEL_ERROR
+};
+
+// The console colors a line can be written in. They only take effect when
+// writing to a Windows console
+enum class ELogColor : unsigned char
+{
+	ELC_Default = 0,
+	ELC_Red = 1,
+	ELC_Green = 2,
+
+	// White on red, used for the message traces
+	ELC_Highlight = 3
+};
+
+//--------------------------- LogArg ---------------------------------------
+// One argument of a record, kept in its raw form until it is written
+//--------------------------------------------------------------------------
+
+struct LogArg
+{
+	enum EType : unsigned char { EAT_Int, EAT_Double, EAT_String };
+
+	EType m_type;
+
+	union
+	{
+		long long m_iValue;
+		double m_dValue;
+		const char* m_pValue;
+	};
+
+	LogArg() :m_type(EAT_Int), m_iValue(0) {}
+	LogArg(int v) :m_type(EAT_Int), m_iValue(v) {}
+	LogArg(long v) :m_type(EAT_Int), m_iValue(v) {}
+	LogArg(long long v) :m_type(EAT_Int), m_iValue(v) {}
+	LogArg(unsigned int v) :m_type(EAT_Int), m_iValue(v) {}
+	LogArg(bool v) :m_type(EAT_Int), m_iValue(v ? 1 : 0) {}
+	LogArg(float v) :m_type(EAT_Double), m_dValue(v) {}
+	LogArg(double v) :m_type(EAT_Double), m_dValue(v) {}
+	LogArg(const char* v) :m_type(EAT_String), m_pValue(v) {}
+
+	// Would be destroyed before the writer gets to it
+	LogArg(const std::string&) = delete;
+};
+
+class Logger
+{
+public:
+
+	static const int MaxArgs = 4;
+
+private:
+
+	struct Record
+	{
+		const char* m_pFormat;
+		LogArg m_args[MaxArgs];
+		unsigned char m_iNumArgs;
+		ELogLevel m_level;
+		ELogColor m_color;
+	};
+
+	// A slot of the ring buffer. Its sequence number says whether it is
+	// ready to be written by the producer whose turn it is, or read
+	struct Cell
+	{
+		std::atomic<size_t> m_iSequence;
+		Record m_record;
+	};
+
+	static const size_t Capacity = 1 << 14;
+
+	std::vector<Cell> m_cells;
+
+	// Kept on separate cache lines, as producers and the writer update them
+	// from different threads
+	alignas(64) std::atomic<size_t> m_iEnqueuePos;
+	alignas(64) std::atomic<size_t> m_iDequeuePos;
+
+	// How many records have been written out, for Flush to wait on
+	alignas(64) std::atomic<size_t> m_iWritten;
+
+	std::atomic<size_t> m_iDropped;
+
+	std::atomic<bool> m_bStop;
+
+	std::atomic<std::ostream*> m_pOutput;
+
+	// Only touched by the writer thread
+	std::string m_line;
+
+	std::thread m_writer;
+
+	Logger();
+	~Logger();
+
+	Logger(const Logger&) = delete;
+	Logger& operator=(const Logger&) = delete;
+
+	void Push(ELogLevel level, ELogColor color, const char* format, const LogArg* args, int numArgs);
+
+	bool Pop(Record& record);
+
+	// Formats a record into m_line and writes it out
+	void WriteRecord(const Record& record);
+
+	void WriterLoop();
+
+public:
+
+	static Logger* Instance();
+
+	template<class... Args>
+	void Write(ELogLevel level, ELogColor color, const char* format, const Args&... args)
+	{
+		static_assert(sizeof...(Args) <= MaxArgs, "<Logger::Write>: too many arguments");
+
+		const LogArg packed[MaxArgs + 1] = { LogArg(args)... };
+
+		Push(level, color, format, packed, (int)sizeof...(Args));
+	}
+
+	// Where the lines go. std::cout unless told otherwise. The stream must
+	// stay open until the logger has been flushed
+	void SetOutput(std::ostream* os);
+
+	// Waits until every record logged before the call has been written
+	void Flush();
+
+	// How many records were dropped because the buffer was full
+	size_t Dropped() const { return m_iDropped.load(std::memory_order_relaxed); }
+};
+
+#if LOG_LEVEL <= LOG_LEVEL_TRACE
+#define LOG_TRACE(...) Logger::Instance()->Write(ELogLevel::ELL_Trace, __VA_ARGS__)
+#else
+#define LOG_TRACE(...) do {} while (0)
+#endif
+
+#if LOG_LEVEL <= LOG_LEVEL_DEBUG
+#define LOG_DEBUG(...) Logger::Instance()->Write(ELogLevel::ELL_Debug, __VA_ARGS__)
+#else
+#define LOG_DEBUG(...) do {} while (0)
+#endif
+
+#if LOG_LEVEL <= LOG_LEVEL_INFO
+#define LOG_INFO(...) Logger::Instance()->Write(ELogLevel::ELL_Info, __VA_ARGS__)
+#else
+#define LOG_INFO(...) do {} while (0)
+#endif
+
+#if LOG_LEVEL <= LOG_LEVEL_WARNING
+#define LOG_WARNING(...) Logger::Instance()->Write(ELogLevel::ELL_Warning, __VA_ARGS__)
+#else
+#define LOG_WARNING(...) do {} while (0)
+#endif
+
+#if LOG_LEVEL <= LOG_LEVEL_ERROR
+#define LOG_ERROR(...) Logger::Instance()->Write(ELogLevel::ELL_Error, __VA_ARGS__)
+#else
+#define LOG_ERROR(...) do {} while (0)
+#endif
+
+#if LOG_LEVEL < LOG_LEVEL_OFF
+#define LOG_FLUSH() Logger::Instance()->Flush()
+#else
+#define LOG_FLUSH() do {} while (0)
+#endif
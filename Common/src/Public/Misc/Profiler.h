@@ -0,0 +1,164 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+#include <string>
+#include <memory>
+#include <mutex>
+#include <iosfwd>
+
+//--------------------------------------------------------------------------
+// A lightweight instrumentation layer for the hot paths.
+//
+// Code marks what it wants measured with the macros at the bottom of this
+// file: PROFILE_SCOPE times the rest of the enclosing block under a name,
+// PROFILE_COUNT adds to a named counter and PROFILE_FRAME closes the current
+// frame. Each thread records into its own counters, so recording takes no
+// locks once a thread and a name have been seen.
+//
+// The macros only do anything when PROFILING is defined (see the
+// AITECHNIQUES_PROFILING CMake option). Otherwise they compile to nothing and
+// the profiler just reports that nothing was recorded.
+//
+// Results can be written out as one row per frame in CSV or JSON, and, if
+// tracing was switched on, every timed scope as a Chrome trace that
+// chrome://tracing or Perfetto can open.
+//--------------------------------------------------------------------------
+
+class Profiler
+{
+public:
+
+	// Fixed so per-thread storage never has to grow while being written to
+	static const int MaxZones = 64;
+	static const int MaxCounters = 32;
+
+private:
+
+	struct TraceEvent
+	{
+		int m_iZone;
+		int64_t m_iStart;
+		int64_t m_iEnd;
+	};
+
+	// What one thread has recorded since the last frame ended
+	struct ThreadData
+	{
+		int m_iThreadId;
+
+		int64_t m_zoneTime[MaxZones];
+		int64_t m_zoneCalls[MaxZones];
+		int64_t m_counters[MaxCounters];
+
+		std::vector<TraceEvent> m_trace;
+	};
+
+	// The totals over every thread for one frame
+	struct FrameStats
+	{
+		int64_t m_zoneTime[MaxZones];
+		int64_t m_zoneCalls[MaxZones];
+		int64_t m_counters[MaxCounters];
+	};
+
+	// Guards registration of names and threads
+	std::mutex m_mutex;
+
+	std::vector<std::string> m_zoneNames;
+	std::vector<std::string> m_counterNames;
+
+	std::vector<std::unique_ptr<ThreadData>> m_threads;
+
+	std::vector<FrameStats> m_frames;
+
+	bool m_bTracing;
+
+	// Stop tracing a thread once it has this many events
+	static const size_t MaxTraceEventsPerThread = 1 << 22;
+
+	Profiler();
+
+	Profiler(const Profiler&) = delete;
+	Profiler& operator=(const Profiler&) = delete;
+
+	ThreadData& ThisThread();
+
+	static int Register(std::vector<std::string>& names, int maxNames, const char* name);
+
+public:
+
+	static Profiler* Instance();
+
+	// Nanoseconds on a steady clock
+	static int64_t Now();
+
+	// Returns the id for a name, creating it on first use. Registering the
+	// same name again returns the same id
+	int RegisterZone(const char* name);
+	int RegisterCounter(const char* name);
+
+	void AddTime(int zone, int64_t start, int64_t end);
+	void AddCount(int counter, int64_t value);
+
+	// Adds up what every thread recorded into a new frame. No other thread
+	// may be recording while this runs
+	void EndFrame();
+
+	// Whether every timed scope is kept for the Chrome trace, rather than
+	// just the per-frame totals
+	void SetTracing(bool tracing) { m_bTracing = tracing; }
+
+	// Forgets every frame and trace event, but keeps the names
+	void Reset();
+
+	int NumFrames() const { return (int)m_frames.size(); }
+
+	void WriteCsv(std::ostream& os) const;
+	void WriteJson(std::ostream& os) const;
+	void WriteChromeTrace(std::ostream& os) const;
+};
+
+//--------------------------- ProfileScope ---------------------------------
+// Times its own lifetime
+//--------------------------------------------------------------------------
+
+class ProfileScope
+{
+private:
+
+	int m_iZone;
+	int64_t m_iStart;
+
+public:
+
+	explicit ProfileScope(int zone) :m_iZone(zone), m_iStart(Profiler::Now()) {}
+
+	~ProfileScope() { Profiler::Instance()->AddTime(m_iZone, m_iStart, Profiler::Now()); }
+};
+
+#ifdef PROFILING
+
+#define PROFILE_CONCAT_INNER(a, b) a##b
+#define PROFILE_CONCAT(a, b) PROFILE_CONCAT_INNER(a, b)
+
+#define PROFILE_SCOPE(name) \
+	static const int PROFILE_CONCAT(profileZone, __LINE__) = Profiler::Instance()->RegisterZone(name); \
+	ProfileScope PROFILE_CONCAT(profileScope, __LINE__)(PROFILE_CONCAT(profileZone, __LINE__))
+
+#define PROFILE_COUNT(name, value) \
+	do \
+	{ \
+		static const int profileCounter = Profiler::Instance()->RegisterCounter(name); \
+		Profiler::Instance()->AddCount(profileCounter, (int64_t)(value)); \
+	} while (0)
+
+#define PROFILE_FRAME() Profiler::Instance()->EndFrame()
+
+#else
+
+#define PROFILE_SCOPE(name)
+#define PROFILE_COUNT(name, value) do {} while (0)
+#define PROFILE_FRAME() do {} while (0)
+
+#endif
@@ -0,0 +1,111 @@
+#pragma once
+
+#include <cstdint>
+#include <cstddef>
+
+//----------------------------------------------------------------------------
+// A seeded stream of random numbers with the same interface as the functions
+// in Utils.h. Unlike rand() each stream keeps its own state, and a given seed
+// produces the same sequence with every compiler and C library, so a run
+// that draws all its numbers from one can be reproduced exactly.
+//
+// The generator is SplitMix64, which is counter based: the n-th number of a
+// stream is a hash of its starting state plus n. That makes it cheap to
+// start an independent stream anywhere (see RandomKey) and lets a batch of
+// numbers be computed without each waiting on the last.
+//----------------------------------------------------------------------------
+
+// The SplitMix64 output function. Scrambles the bits of z
+inline uint64_t MixBits(uint64_t z)
+{
+	z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+	z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+
+	return z ^ (z >> 31);
+}
+
+// The amount the SplitMix64 counter advances by per number
+const uint64_t RandomIncrement = 0x9E3779B97F4A7C15ULL;
+
+// The starting state of the stream addressed by a seed and two coordinates,
+// such as an agent and a frame. Streams that differ in any of the three are
+// unrelated, however close the values
+inline uint64_t RandomKey(uint64_t seed, uint64_t a, uint64_t b)
+{
+	uint64_t key = MixBits(seed + RandomIncrement);
+
+	key = MixBits(key ^ (a + RandomIncrement));
+
+	return MixBits(key ^ (b + RandomIncrement));
+}
+
+class RandomStream
+{
+private:
+
+	uint64_t m_iState;
+
+	// Turns 64 random bits into a double between zero and 1. The top 53
+	// bits fill the mantissa exactly
+	static double ToFloat(uint64_t bits) { return (bits >> 11) * (1.0 / 9007199254740992.0); }
+
+public:
+
+	explicit RandomStream(uint64_t seed = 0) : m_iState(seed) {}
+
+	void Seed(uint64_t seed) { m_iState = seed; }
+
+	// Returns the next 64 random bits
+	uint64_t Next()
+	{
+		return MixBits(m_iState += RandomIncrement);
+	}
+
+	// Returns a random integer between x and y
+	int RandInt(int x, int y)
+	{
+		return x + (int)(Next() % (uint64_t)(y - x + 1));
+	}
+
+	// Returns a random double between zero and 1
+	double RandFloat()
+	{
+		return ToFloat(Next());
+	}
+
+	// Fills out with the same numbers count calls to RandFloat would return,
+	// but computes them independently of each other
+	void RandFloats(double* out, size_t count)
+	{
+		const uint64_t state = m_iState;
+
+		for (size_t i = 0; i < count; ++i)
+		{
+			out[i] = ToFloat(MixBits(state + (i + 1) * RandomIncrement));
+		}
+
+		m_iState = state + count * RandomIncrement;
+	}
+
+	// Returns a random double between two ranges
+	double RandInRange(double x, double y)
+	{
+		return x + RandFloat() * (y - x);
+	}
+
+	// Returns a random bool
+	bool RandomBool()
+	{
+		return (Next() >> 63) != 0;
+	}
+
+	// Returns a random double in the range -1 < n < 1
+	double RandomClamped()
+	{
+		// Draw in a fixed order; the operands of a subtraction may be
+		// evaluated either way round
+		const double a = RandFloat();
+
+		return a - RandFloat();
+	}
+};
@@ -3,6 +3,7 @@
 #include <sstream>
 #include <string>
 #include <iomanip>
+#include <stdexcept>
 
 // --------------------- ttos ---------------------------------
 // Convert a type to a string
@@ -0,0 +1,91 @@
+#pragma once
+
+#include <vector>
+#include <deque>
+#include <memory>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+#include <functional>
+
+//--------------------------------------------------------------------------
+// A fixed-size pool of worker threads used to run data-parallel loops.
+//
+// ParallelFor splits a range of indices into tasks of grainSize indices and
+// deals them out to one queue per thread. Each thread works through its own
+// queue from the back and, once that runs dry, steals from the front of the
+// other queues, so uneven workloads still keep every thread busy. The thread
+// calling ParallelFor takes part in the work and only returns once every
+// task has been run.
+//
+// Which thread runs a task is not fixed, so jobs must not depend on it: each
+// index should only write to state that belongs to that index.
+//--------------------------------------------------------------------------
+
+class ThreadPool
+{
+private:
+
+	// A contiguous chunk of the range being processed
+	struct Task
+	{
+		size_t m_iBegin;
+		size_t m_iEnd;
+	};
+
+	struct WorkQueue
+	{
+		std::mutex m_mutex;
+		std::deque<Task> m_tasks;
+	};
+
+	std::vector<std::thread> m_workers;
+
+	// One queue per worker, plus a final one for the calling thread
+	std::vector<std::unique_ptr<WorkQueue>> m_queues;
+
+	// The job of the ParallelFor currently in flight
+	const std::function<void(size_t, size_t)>* m_pJob;
+
+	// Tasks of the current job that have not finished yet
+	std::atomic<size_t> m_iPendingTasks;
+
+	// Guards the generation count and shutdown flag and is used with the
+	// condition variables below
+	std::mutex m_mutex;
+	std::condition_variable m_wakeWorkers;
+	std::condition_variable m_jobDone;
+
+	// Incremented each time a new job is published to the workers
+	unsigned int m_iGeneration;
+
+	bool m_bShutdown;
+
+	// Takes a task from the back of this thread's queue or, failing that,
+	// from the front of another thread's queue
+	bool PopOrSteal(size_t self, Task& task);
+
+	// Runs tasks until there are none left to take
+	void RunTasks(size_t self);
+
+	void WorkerLoop(size_t self);
+
+public:
+
+	// numThreads counts the calling thread, so a pool of one thread runs
+	// everything inline. Zero means one thread per hardware thread
+	explicit ThreadPool(unsigned int numThreads = 0);
+
+	~ThreadPool();
+
+	ThreadPool(const ThreadPool&) = delete;
+	ThreadPool& operator=(const ThreadPool&) = delete;
+
+	unsigned int NumThreads() const { return (unsigned int)m_queues.size(); }
+
+	// Calls job(begin, end) over consecutive chunks covering [0, count) and
+	// blocks until all of them have completed. Must not be called from
+	// inside a job
+	void ParallelFor(size_t count, size_t grainSize, const std::function<void(size_t, size_t)>& job);
+};
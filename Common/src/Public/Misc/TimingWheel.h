@@ -0,0 +1,432 @@
+#pragma once
+
+#include <vector>
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+#include <cstdint>
+
+//--------------------------------------------------------------------------
+// A hierarchical timing wheel. Items are scheduled for a time and handed
+// back once the wheel is advanced past it.
+//
+// Time is divided into ticks of a fixed length. The first level has a slot
+// for each of the next 256 ticks, the second a slot for each of the next 256
+// runs of 256 ticks, and so on for four levels. Scheduling an item appends
+// it to the slot its tick falls in, and advancing the wheel drains the
+// first level's slots one tick at a time. Whenever the first level wraps
+// around, the next slot of the level above is emptied into it. Items due
+// further away than the four levels reach wait in an overflow list. Both
+// scheduling and expiring are constant time regardless of how many items
+// are waiting.
+//
+// Items live in a pool that grows as needed and reuses the space of
+// delivered items, so a wheel that has warmed up allocates nothing.
+//
+// Items due by the same tick are delivered in order of their exact time,
+// and items scheduled for the very same time in the order they were
+// scheduled, so delivery is deterministic.
+//--------------------------------------------------------------------------
+
+template<class T>
+class TimingWheel
+{
+private:
+
+	static const int SlotBits = 8;
+	static const int NumSlots = 1 << SlotBits;
+	static const int NumLevels = 4;
+
+	struct Node
+	{
+		T m_item;
+		double m_dTime;
+		uint64_t m_iTick;
+
+		// Breaks ties between items scheduled for the same time
+		uint64_t m_iSequence;
+
+		// The next node in the same slot or in the free list
+		int m_iNext;
+	};
+
+	// A singly linked list of nodes, kept in the order they were added
+	struct Slot
+	{
+		int m_iHead;
+		int m_iTail;
+
+		Slot() :m_iHead(-1), m_iTail(-1) {}
+	};
+
+	std::vector<Node> m_pool;
+	int m_iFreeList;
+
+	std::vector<Slot> m_slots;
+	Slot m_overflow;
+
+	// Items scheduled while the wheel is being advanced. They are filed once
+	// it is done, so the slots aren't changed under Advance's feet
+	Slot m_pending;
+	bool m_bAdvancing;
+
+	// How many items wait on each level. Lets Advance skip over stretches of
+	// the first level with nothing in them
+	int m_levelCount[NumLevels];
+
+	// Every tick before this one has been delivered
+	uint64_t m_iTick;
+
+	double m_dTickLength;
+
+	uint64_t m_iNextSequence;
+	size_t m_iSize;
+
+	// Scratch space for sorting a slot before delivering it
+	std::vector<int> m_due;
+
+	//----------------------- TickOf -------------------------------------------
+	//---------------------------------------------------------------------------
+
+	inline uint64_t TickOf(double time) const
+	{
+		return time > 0.0 ? (uint64_t)std::floor(time / m_dTickLength) : 0;
+	}
+
+	//----------------------- Append -------------------------------------------
+	//---------------------------------------------------------------------------
+
+	inline void Append(Slot& slot, int node)
+	{
+		m_pool[node].m_iNext = -1;
+
+		if (slot.m_iTail < 0)
+		{
+			slot.m_iHead = node;
+		}
+		else
+		{
+			m_pool[slot.m_iTail].m_iNext = node;
+		}
+
+		slot.m_iTail = node;
+	}
+
+	//----------------------- Place --------------------------------------------
+	// Files a node under the lowest level whose span contains both its tick
+	// and the current tick
+	//---------------------------------------------------------------------------
+
+	inline void Place(int node)
+	{
+		const uint64_t tick = std::max(m_pool[node].m_iTick, m_iTick);
+
+		for (int level = 0; level < NumLevels; ++level)
+		{
+			const int shift = SlotBits * (level + 1);
+
+			if ((tick >> shift) == (m_iTick >> shift))
+			{
+				const int slot = (int)((tick >> (shift - SlotBits)) & (NumSlots - 1));
+
+				Append(m_slots[level * NumSlots + slot], node);
+				++m_levelCount[level];
+
+				return;
+			}
+		}
+
+		Append(m_overflow, node);
+	}
+
+	//----------------------- Detach -------------------------------------------
+	// Empties a slot and returns its first node
+	//---------------------------------------------------------------------------
+
+	inline int Detach(Slot& slot)
+	{
+		const int head = slot.m_iHead;
+
+		slot.m_iHead = -1;
+		slot.m_iTail = -1;
+
+		return head;
+	}
+
+	//----------------------- Cascade ------------------------------------------
+	// Called when the current tick has just moved into a new slot of level,
+	// so the items in that slot are refiled under the levels below
+	//---------------------------------------------------------------------------
+
+	void Cascade(int level)
+	{
+		int node;
+
+		if (level == NumLevels)
+		{
+			node = Detach(m_overflow);
+		}
+		else
+		{
+			const int slot = (int)((m_iTick >> (SlotBits * level)) & (NumSlots - 1));
+
+			node = Detach(m_slots[level * NumSlots + slot]);
+		}
+
+		while (node >= 0)
+		{
+			const int next = m_pool[node].m_iNext;
+
+			if (level < NumLevels) --m_levelCount[level];
+
+			Place(node);
+
+			node = next;
+		}
+	}
+
+	//----------------------- NextTick -----------------------------------------
+	// Moves the current tick on by one, cascading every level whose slot
+	// changes. The highest level goes first, as its items may land in the
+	// slot of a lower level that is about to be cascaded itself
+	//---------------------------------------------------------------------------
+
+	void NextTick()
+	{
+		++m_iTick;
+
+		int level = 0;
+
+		while (level < NumLevels && ((m_iTick >> (SlotBits * (level + 1))) << (SlotBits * (level + 1))) == m_iTick)
+		{
+			++level;
+		}
+
+		for (; level > 0; --level)
+		{
+			Cascade(level);
+		}
+	}
+
+	//----------------------- Release ------------------------------------------
+	//---------------------------------------------------------------------------
+
+	inline void Release(int node)
+	{
+		m_pool[node].m_item = T();
+		m_pool[node].m_iNext = m_iFreeList;
+
+		m_iFreeList = node;
+
+		--m_iSize;
+	}
+
+	//----------------------- Deliver ------------------------------------------
+	// Hands the items of the current tick's slot that are due before now to
+	// deliver, earliest first. Those that aren't due yet are put back
+	//---------------------------------------------------------------------------
+
+	template<class Callback>
+	void Deliver(double now, bool wholeTick, Callback& deliver)
+	{
+		Slot& slot = m_slots[(size_t)(m_iTick & (NumSlots - 1))];
+
+		m_due.clear();
+
+		for (int node = Detach(slot); node >= 0;)
+		{
+			const int next = m_pool[node].m_iNext;
+
+			if (wholeTick || m_pool[node].m_dTime < now)
+			{
+				m_due.push_back(node);
+			}
+			else
+			{
+				Append(slot, node);
+			}
+
+			node = next;
+		}
+
+		if (m_due.empty()) return;
+
+		m_levelCount[0] -= (int)m_due.size();
+
+		std::sort(m_due.begin(), m_due.end(), [this](int a, int b)
+		{
+			if (m_pool[a].m_dTime != m_pool[b].m_dTime) return m_pool[a].m_dTime < m_pool[b].m_dTime;
+
+			return m_pool[a].m_iSequence < m_pool[b].m_iSequence;
+		});
+
+		for (size_t i = 0; i < m_due.size(); ++i)
+		{
+			// Copied out, since scheduling from within deliver may grow the pool
+			const T item = m_pool[m_due[i]].m_item;
+
+			Release(m_due[i]);
+
+			deliver(item);
+		}
+	}
+
+public:
+
+	// tickLength is in the units of the times given to Schedule and Advance.
+	// Items sharing a tick are sorted when they are delivered, so it should
+	// be short enough that few items do
+	explicit TimingWheel(double tickLength = 0.001)
+		:m_iFreeList(-1),
+		m_slots(NumLevels * NumSlots),
+		m_bAdvancing(false),
+		m_iTick(0),
+		m_dTickLength(tickLength),
+		m_iNextSequence(0),
+		m_iSize(0)
+	{
+		assert(tickLength > 0.0 && "<TimingWheel::TimingWheel>: ticks must have a length");
+
+		std::fill(m_levelCount, m_levelCount + NumLevels, 0);
+	}
+
+	//----------------------- Schedule -----------------------------------------
+	// Adds an item to be delivered once the wheel is advanced past time. A
+	// time that has already gone by is delivered by the next Advance
+	//---------------------------------------------------------------------------
+
+	void Schedule(double time, const T& item)
+	{
+		int node = m_iFreeList;
+
+		if (node >= 0)
+		{
+			m_iFreeList = m_pool[node].m_iNext;
+		}
+		else
+		{
+			node = (int)m_pool.size();
+
+			m_pool.push_back(Node());
+		}
+
+		Node& n = m_pool[node];
+		n.m_item = item;
+		n.m_dTime = time;
+		n.m_iTick = TickOf(time);
+		n.m_iSequence = m_iNextSequence++;
+
+		if (m_bAdvancing)
+		{
+			Append(m_pending, node);
+		}
+		else
+		{
+			Place(node);
+		}
+
+		++m_iSize;
+	}
+
+	//----------------------- Advance ------------------------------------------
+	// Calls deliver with every item due before now, in time order. deliver
+	// may schedule further items but must not advance the wheel. Anything it
+	// schedules for before now is left for the next call
+	//---------------------------------------------------------------------------
+
+	template<class Callback>
+	void Advance(double now, Callback deliver)
+	{
+		assert(!m_bAdvancing && "<TimingWheel::Advance>: called from within a delivery");
+
+		const uint64_t target = TickOf(now);
+
+		m_bAdvancing = true;
+
+		while (m_iTick < target)
+		{
+			if (m_levelCount[0] > 0)
+			{
+				Deliver(now, true, deliver);
+
+				NextTick();
+			}
+			else
+			{
+				// Nothing on the first level, so skip to the next tick that
+				// cascades or to the target, whichever comes first
+				const uint64_t nextCascade = ((m_iTick >> SlotBits) + 1) << SlotBits;
+
+				if (nextCascade > target)
+				{
+					m_iTick = target;
+				}
+				else
+				{
+					m_iTick = nextCascade - 1;
+
+					NextTick();
+				}
+			}
+		}
+
+		Deliver(now, false, deliver);
+
+		m_bAdvancing = false;
+
+		for (int node = Detach(m_pending); node >= 0;)
+		{
+			const int next = m_pool[node].m_iNext;
+
+			Place(node);
+
+			node = next;
+		}
+	}
+
+	//----------------------- ForEach ------------------------------------------
+	// Calls visit with every item still waiting, in no particular order
+	//---------------------------------------------------------------------------
+
+	template<class Callback>
+	void ForEach(Callback visit) const
+	{
+		auto visitSlot = [this, &visit](const Slot& slot)
+		{
+			for (int node = slot.m_iHead; node >= 0; node = m_pool[node].m_iNext)
+			{
+				visit(m_pool[node].m_item);
+			}
+		};
+
+		for (const Slot& slot : m_slots)
+		{
+			visitSlot(slot);
+		}
+
+		visitSlot(m_overflow);
+		visitSlot(m_pending);
+	}
+
+	//----------------------- Clear --------------------------------------------
+	// Drops every item without delivering it
+	//---------------------------------------------------------------------------
+
+	void Clear()
+	{
+		m_pool.clear();
+		m_iFreeList = -1;
+
+		std::fill(m_slots.begin(), m_slots.end(), Slot());
+		m_overflow = Slot();
+		m_pending = Slot();
+
+		std::fill(m_levelCount, m_levelCount + NumLevels, 0);
+
+		m_iSize = 0;
+	}
+
+	size_t Size() const { return m_iSize; }
+
+	bool Empty() const { return m_iSize == 0; }
+};
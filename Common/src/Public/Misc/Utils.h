@@ -1,6 +1,7 @@
 #pragma once
 
 #include <math.h>
+#include <stdlib.h>
 #include <sstream>
 #include <string>
 #include <vector>
@@ -8,6 +9,8 @@
 #include <cassert>
 #include <iomanip>
 
+#include "Public/Misc/RandomStream.h"
+
 //----------------------------------------------------------------------------
 //  A few useful constants.
 //----------------------------------------------------------------------------
@@ -24,19 +27,35 @@ const double HalfPi = Pi / 2;
 const double QuarterPi = Pi / 4;
 
 //----------------------------------------------------------------------------
-//  Some random number functions.
+//  Some random number functions. They all draw from one stream shared by the
+//  whole program, so code that runs on several threads or must be
+//  reproducible should keep a RandomStream of its own instead.
 //----------------------------------------------------------------------------
 
+// The stream behind the functions below
+inline RandomStream& GlobalRandom()
+{
+	static RandomStream random;
+
+	return random;
+}
+
+// Restarts the stream behind the functions below, as srand does for rand
+inline void SeedRandom(unsigned int seed)
+{
+	GlobalRandom().Seed(seed);
+}
+
 // Returns a random integer between x and y
 inline int RandInt(int x, int y)
 {
-	return rand() % (y - x + 1) + x;
+	return GlobalRandom().RandInt(x, y);
 }
 
 // Returns a random double between zero and 1
 inline double RandFloat() 
 {
-	return ((rand()) / (RAND_MAX + 1.0f)); 
+	return GlobalRandom().RandFloat();
 }
 
 // Returns a random double between two ranges
@@ -48,13 +67,13 @@ inline double RandInRange(double x, double y)
 // Returns a random bool
 inline bool RandomBool()
 {
-	return (RandInt(0, 1)) ? true : false;
+	return GlobalRandom().RandomBool();
 }
 
 // Returns a random double in the range -1 < n < 1
 inline double RandomClamped()
 {
-	return RandFloat() - RandFloat();
+	return GlobalRandom().RandomClamped();
 }
 
 //----------------------------------------------------------------------------
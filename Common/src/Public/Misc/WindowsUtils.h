@@ -4,7 +4,8 @@
 #include <Windows.h>
 #include <string>
 
-struct Vector2D;
+template<class T> struct Vector2DT;
+typedef Vector2DT<double> Vector2D;
 
 // Macro to detect keypresses
 #define KEYDOWN(vk_code) ((GetAsyncKeyState(vk_code) & 0x8000) ? 1 : 0)
@@ -1,9 +1,6 @@
 #pragma once
 
-// This library must be included
-#pragma comment(lib, "winmm.lib")
-
-#include <windows.h>
+#include <chrono>
 
 #define Clock CrudeTimer::Instance()
 
@@ -14,8 +11,11 @@ private:
 	// Set to the time (in seconds) when class is instantiated
 	double m_dStartTime;
 
+	// Returns the current time (in seconds) of a monotonic clock
+	static double Now() { return std::chrono::duration<double>(std::chrono::steady_clock::now().time_since_epoch()).count(); }
+
 	// Set the start time
-	CrudeTimer() { m_dStartTime = timeGetTime() * 0.001; }
+	CrudeTimer() { m_dStartTime = Now(); }
 
 public:
 
@@ -26,5 +26,5 @@ public:
 	static CrudeTimer* Instance();
 
 	// Returns how much time has elapsed since the timer was started
-	double GetElapsedTime() { return timeGetTime() * 0.001 - m_dStartTime; }
+	double GetElapsedTime() { return Now() - m_dStartTime; }
 };
\ No newline at end of file
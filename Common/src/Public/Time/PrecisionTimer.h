@@ -1,21 +1,26 @@
 #pragma once
 
-#include <windows.h>
+#include <chrono>
 #include <cassert>
 
 const double SMOOTHNESS = 5.0;
 
+// The timer counts ticks of a monotonic clock. On Windows this is backed by
+// QueryPerformanceCounter, elsewhere by whatever steady clock the platform has
+typedef std::chrono::steady_clock PrecisionClock;
+typedef long long TimerTicks;
+
 class PrecisionTimer
 {
 private:
 
-	LONGLONG m_lCurrentTime;
-	LONGLONG m_lLastTime;
-	LONGLONG m_lLastTimeInTimeElapsed;
-	LONGLONG m_lNextTime;
-	LONGLONG m_lStartTime;
-	LONGLONG m_lFrameTime;
-	LONGLONG m_lPerFCountFreq;
+	TimerTicks m_lCurrentTime;
+	TimerTicks m_lLastTime;
+	TimerTicks m_lLastTimeInTimeElapsed;
+	TimerTicks m_lNextTime;
+	TimerTicks m_lStartTime;
+	TimerTicks m_lFrameTime;
+	TimerTicks m_lPerFCountFreq;
 
 	double m_dTimeElapsed;
 	double m_dLastTimeElapsed;
@@ -32,6 +37,9 @@ private:
 	// a window, etc.
 	bool m_bSmoothUpdates;
 
+	// Returns the current value of the underlying monotonic counter
+	static TimerTicks QueryCounter() { return PrecisionClock::now().time_since_epoch().count(); }
+
 public:
 
 	// Ctors
@@ -42,7 +50,7 @@ public:
 	void Start();
 
 	// Determines if enough time has passed to move onto next frame
-	inline bool ReadyForNextFrame();
+	bool ReadyForNextFrame();
 
 	// Only used this after a call to the above
 	// double GetTimeElapsed() { return m_TimeElapsed; }
@@ -55,7 +63,7 @@ public:
 	{
 		m_dLastTimeElapsed = m_dTimeElapsed;
 
-		QueryPerformanceCounter((LARGE_INTEGER*)& m_lCurrentTime);
+		m_lCurrentTime = QueryCounter();
 
 		m_dTimeElapsed = (m_lCurrentTime - m_lLastTimeInTimeElapsed) * m_dTimeScale;
 		m_lLastTimeInTimeElapsed = m_lCurrentTime;
@@ -72,7 +80,7 @@ public:
 
 	inline double CurrentTime()
 	{
-		QueryPerformanceCounter((LARGE_INTEGER*)& m_lCurrentTime);
+		m_lCurrentTime = QueryCounter();
 
 		return (m_lCurrentTime - m_lStartTime) * m_dTimeScale;
 	}
@@ -2,9 +2,6 @@
 
 void Elsa::Update(double timeElapsed)
 {
-	// Set text color to green
-	SetTextColor(FOREGROUND_GREEN | FOREGROUND_INTENSITY);
-
 	m_pStateMachine->Update();
 }
 
@@ -7,17 +7,9 @@
 #include "Public/Messaging/MessageTypes.h"
 #include "Public/Messaging/Telegram.h"
 
+#include "Public/Misc/Log.h"
 #include "Public/Time/CrudeTimer.h"
 
-#include <iostream>
-using std::cout;
-
-#ifdef TEXTOUTPUT
-#include <fstream>
-extern std::ofstream os;
-#define cout os
-#endif
-
 // WifeGlobalState 
 
 WifeGlobalState* WifeGlobalState::Instance()
@@ -42,11 +34,9 @@ bool WifeGlobalState::OnMessage(Elsa * pWife, const Telegram& msg)
 	{
 		case EMessageType::EMT_HitHoneyImHome:
 
-			cout << "\nMessage handled by " << GetNameOfEntity(pWife->ID())
-				<< " at time: " << Clock->GetElapsedTime();
+			LOG_DEBUG(ELogColor::ELC_Highlight, "Message handled by {} at time: {}", GetNameOfEntity(pWife->ID()), Clock->GetElapsedTime());
 
-			cout << "\n" << GetNameOfEntity(pWife->ID()) 
-				<< ": Hi honey. Let me make you some of mah fine country stew";
+			LOG_INFO(ELogColor::ELC_Green, "{}: Hi honey. Let me make you some of mah fine country stew", GetNameOfEntity(pWife->ID()));
 
 			pWife->GetFSM()->ChangeState(CookStewState::Instance());
 
@@ -69,19 +59,19 @@ VisitBathroomState* VisitBathroomState::Instance()
 
 void VisitBathroomState::Enter(Elsa* pWife)
 {
-	cout << "\n" << GetNameOfEntity(pWife->ID()) << ": Walkin' to the can. Need to powda mah pretty li'lle nose";
+	LOG_INFO(ELogColor::ELC_Green, "{}: Walkin' to the can. Need to powda mah pretty li'lle nose", GetNameOfEntity(pWife->ID()));
 }
 
 void VisitBathroomState::Execute(Elsa * pWife)
 {
-	cout << "\n" << GetNameOfEntity(pWife->ID()) << ": Ahhhhhh! Sweet relief!";
+	LOG_INFO(ELogColor::ELC_Green, "{}: Ahhhhhh! Sweet relief!", GetNameOfEntity(pWife->ID()));
 
 	pWife->GetFSM()->RevertToPreviousState();
 }
 
 void VisitBathroomState::Exit(Elsa* pWife)
 {
-	cout << "\n" << GetNameOfEntity(pWife->ID()) << ": Leavin' the Jon";
+	LOG_INFO(ELogColor::ELC_Green, "{}: Leavin' the Jon", GetNameOfEntity(pWife->ID()));
 }
 
 bool VisitBathroomState::OnMessage(Elsa * pWife, const Telegram& msg)
@@ -105,15 +95,15 @@ void DoHouseWorkState::Execute(Elsa * pWife)
 	switch (RandInt(0, 2))
 	{
 	case 0:
-		cout << "\n" << GetNameOfEntity(pWife->ID()) << ": Moppin' the floor";
+		LOG_INFO(ELogColor::ELC_Green, "{}: Moppin' the floor", GetNameOfEntity(pWife->ID()));
 		break;
 
 	case 1:
-		cout << "\n" << GetNameOfEntity(pWife->ID()) << ": Washin' the dishes";
+		LOG_INFO(ELogColor::ELC_Green, "{}: Washin' the dishes", GetNameOfEntity(pWife->ID()));
 		break;
 
 	case 2:
-		cout << "\n" << GetNameOfEntity(pWife->ID()) << ": Makin' the beed";
+		LOG_INFO(ELogColor::ELC_Green, "{}: Makin' the beed", GetNameOfEntity(pWife->ID()));
 		break;
 	}
 }
@@ -139,8 +129,7 @@ void CookStewState::Enter(Elsa* pWife)
 	// If not already cooking, put the stew in the oven
 	if (!pWife->IsCooking())
 	{
-		cout << "\n" << GetNameOfEntity(pWife->ID())
-			<< ": Puttin' the stew in the oven";
+		LOG_INFO(ELogColor::ELC_Green, "{}: Puttin' the stew in the oven", GetNameOfEntity(pWife->ID()));
 
 		// Send a delayed message to myself so that I know when to take 
 		// the stew out of the oven
@@ -165,11 +154,9 @@ bool CookStewState::OnMessage(Elsa* pWife, const Telegram& msg)
 	{
 		case EMessageType::EMT_StewReady:
 			
-			cout << "\nMessage received by " << GetNameOfEntity(pWife->ID())
-				<< " at time: " << Clock->GetElapsedTime();
+			LOG_DEBUG(ELogColor::ELC_Highlight, "Message received by {} at time: {}", GetNameOfEntity(pWife->ID()), Clock->GetElapsedTime());
 			
-			cout << "\n" << GetNameOfEntity(pWife->ID())
-				<< ": Stew ready! Let's eat";
+			LOG_INFO(ELogColor::ELC_Green, "{}: Stew ready! Let's eat", GetNameOfEntity(pWife->ID()));
 
 			// let know that stew is ready
 			Dispatch->DispatchCustomMessage(SEND_MSG_INMEDIATELY, pWife->ID(),
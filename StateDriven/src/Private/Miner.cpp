@@ -1,9 +1,9 @@
 #include "Public/Miner.h"
 #include "Public/MinerStates.h"
 #include "Public/FSM/State.h"
+#include "Public/Misc/Log.h"
 
 #include <cassert>
-#include <iostream>
 #include <string>
 
 
@@ -41,7 +41,7 @@ void Miner::AddToGoldCarried(const int val)
 	if (m_iGoldCarried < 0)
 	{
 		m_iGoldCarried = 0;
-		std::cout << "Miner::AddToGoldCarried: minimum gold carried reached!" << std::endl;
+		LOG_WARNING(ELogColor::ELC_Default, "Miner::AddToGoldCarried: minimum gold carried reached!");
 	}
 }
 
@@ -57,7 +57,7 @@ void Miner::AddToWealth(const int val)
 	if (m_iMoneyInBank < 0)
 	{
 		m_iMoneyInBank = 0;
-		std::cout << "Miner::AddToWealth: minimum wealth carried reached!" << std::endl;
+		LOG_WARNING(ELogColor::ELC_Default, "Miner::AddToWealth: minimum wealth carried reached!");
 	}
 }
 
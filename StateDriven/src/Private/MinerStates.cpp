@@ -7,18 +7,9 @@
 #include "Public/Messaging/MessageTypes.h"
 #include "Public/Messaging/Telegram.h"
 
-#include "Public/misc/ConsoleUtils.h"
+#include "Public/Misc/Log.h"
 #include "Public/Time/CrudeTimer.h"
 
-#include <iostream>
-using std::cout;
-
-#ifdef TEXTOUTPUT
-#include <fstream>
-extern std::ofstream os;
-#define cout os
-#endif
-
 // EnterMineAndDigForNuggetState
 
 EnterMineAndDigForNuggetState* EnterMineAndDigForNuggetState::Instance()
@@ -34,9 +25,7 @@ void EnterMineAndDigForNuggetState::Enter(Miner* pMiner)
 	// change location to the gold mine
 	if (pMiner->Location() != ELocationType::EL_GoldMine)
 	{
-		SetTextColor(FOREGROUND_RED | FOREGROUND_INTENSITY);
-		cout << "\n" << GetNameOfEntity(pMiner->ID()) 
-			<< ": " << "Walkin' to the goldime";
+		LOG_INFO(ELogColor::ELC_Red, "{}: Walkin' to the goldime", GetNameOfEntity(pMiner->ID()));
 
 		pMiner->ChangeLocation(ELocationType::EL_GoldMine);
 	}
@@ -51,10 +40,7 @@ void EnterMineAndDigForNuggetState::Execute(Miner* pMiner)
 
 	pMiner->IncreaseFatigue();
 
-	SetTextColor(FOREGROUND_RED | FOREGROUND_INTENSITY);
-
-	cout << "\n" << GetNameOfEntity(pMiner->ID()) 
-		<< ": " << "Pickin' up a nugget";
+	LOG_INFO(ELogColor::ELC_Red, "{}: Pickin' up a nugget", GetNameOfEntity(pMiner->ID()));
 
 	// If enough gold mined, go and put it in the bank
 	if (pMiner->ArePocketsFull())
@@ -70,9 +56,7 @@ void EnterMineAndDigForNuggetState::Execute(Miner* pMiner)
 
 void EnterMineAndDigForNuggetState::Exit(Miner* pMiner)
 {
-	SetTextColor(FOREGROUND_RED | FOREGROUND_INTENSITY);
-	cout << "\n" << GetNameOfEntity(pMiner->ID()) 
-		<< ": " << "Ah'm leavin' the goldmine with mah pockets full o' sweet gold";
+	LOG_INFO(ELogColor::ELC_Red, "{}: Ah'm leavin' the goldmine with mah pockets full o' sweet gold", GetNameOfEntity(pMiner->ID()));
 }
 
 bool EnterMineAndDigForNuggetState::OnMessage(Miner* pMiner, const Telegram& msg)
@@ -97,9 +81,7 @@ void VisitBankAndDepositGoldState::Enter(Miner* pMiner)
 	// On entry the miner makes sure he is located at the bank
 	if (pMiner->Location() != ELocationType::EL_Bank)
 	{
-		SetTextColor(FOREGROUND_RED | FOREGROUND_INTENSITY);
-		cout << "\n" << GetNameOfEntity(pMiner->ID()) 
-			<< ": " << "Goin' to the bank. Yes siree";
+		LOG_INFO(ELogColor::ELC_Red, "{}: Goin' to the bank. Yes siree", GetNameOfEntity(pMiner->ID()));
 
 		pMiner->ChangeLocation(ELocationType::EL_Bank);
 	}
@@ -112,16 +94,12 @@ void VisitBankAndDepositGoldState::Execute(Miner* pMiner)
 
 	pMiner->SetGoldCarried(0);
 
-	SetTextColor(FOREGROUND_RED | FOREGROUND_INTENSITY);
-	cout << "\n" << GetNameOfEntity(pMiner->ID()) 
-		<< ": " << "Depositing gold. Total savings now: " << pMiner->Wealth();
+	LOG_INFO(ELogColor::ELC_Red, "{}: Depositing gold. Total savings now: {}", GetNameOfEntity(pMiner->ID()), pMiner->Wealth());
 
 	// Wealthy enough to have a well earned rest?
 	if (pMiner->Wealth() >= ComfortLevel)
 	{
-		SetTextColor(FOREGROUND_RED | FOREGROUND_INTENSITY);
-		cout << "\n" << GetNameOfEntity(pMiner->ID()) 
-			<< ": " << "WooHoo! Rich enough for now. Back home to mah li'lle lady";
+		LOG_INFO(ELogColor::ELC_Red, "{}: WooHoo! Rich enough for now. Back home to mah li'lle lady", GetNameOfEntity(pMiner->ID()));
 
 		pMiner->GetFSM()->ChangeState(GoHomeAndSleepTilRestedState::Instance());
 	}
@@ -134,9 +112,7 @@ void VisitBankAndDepositGoldState::Execute(Miner* pMiner)
 
 void VisitBankAndDepositGoldState::Exit(Miner* pMiner)
 {
-	SetTextColor(FOREGROUND_RED | FOREGROUND_INTENSITY);
-	cout << "\n" << GetNameOfEntity(pMiner->ID()) 
-		<< ": " << "Leavin' the bank";
+	LOG_INFO(ELogColor::ELC_Red, "{}: Leavin' the bank", GetNameOfEntity(pMiner->ID()));
 }
 
 bool VisitBankAndDepositGoldState::OnMessage(Miner* pMiner, const Telegram& msg)
@@ -160,9 +136,7 @@ void GoHomeAndSleepTilRestedState::Enter(Miner* pMiner)
 {
 	if (pMiner->Location() != ELocationType::EL_Shack)
 	{
-		SetTextColor(FOREGROUND_RED | FOREGROUND_INTENSITY);
-		cout << "\n" << GetNameOfEntity(pMiner->ID()) 
-			<< ": " << "Walkin' home";
+		LOG_INFO(ELogColor::ELC_Red, "{}: Walkin' home", GetNameOfEntity(pMiner->ID()));
 
 		pMiner->ChangeLocation(ELocationType::EL_Shack);
 
@@ -177,9 +151,7 @@ void GoHomeAndSleepTilRestedState::Execute(Miner* pMiner)
 	// If miner is not fatigued start to dig for nuggets again
 	if (!pMiner->Fatigued())
 	{
-		SetTextColor(FOREGROUND_RED | FOREGROUND_INTENSITY);
-		cout << "\n" << GetNameOfEntity(pMiner->ID()) 
-			<< ": " << "What a God darn Fantastic nap! Time to find more gold";
+		LOG_INFO(ELogColor::ELC_Red, "{}: What a God darn Fantastic nap! Time to find more gold", GetNameOfEntity(pMiner->ID()));
 		
 		pMiner->GetFSM()->ChangeState(EnterMineAndDigForNuggetState::Instance());
 	}
@@ -188,34 +160,24 @@ void GoHomeAndSleepTilRestedState::Execute(Miner* pMiner)
 		// sleep
 		pMiner->DecreaseFatigue();
 
-		SetTextColor(FOREGROUND_RED | FOREGROUND_INTENSITY);
-		cout << "\n" << GetNameOfEntity(pMiner->ID()) 
-			<< ": " << "ZZZZ...";
+		LOG_INFO(ELogColor::ELC_Red, "{}: ZZZZ...", GetNameOfEntity(pMiner->ID()));
 	}
 }
 
 void GoHomeAndSleepTilRestedState::Exit(Miner* pMiner)
 {
-	SetTextColor(FOREGROUND_RED | FOREGROUND_INTENSITY);
-	cout << "\n" << GetNameOfEntity(pMiner->ID()) 
-		<< ": " << "Leaving the house";
+	LOG_INFO(ELogColor::ELC_Red, "{}: Leaving the house", GetNameOfEntity(pMiner->ID()));
 }
 
 bool GoHomeAndSleepTilRestedState::OnMessage(Miner* pMiner, const Telegram& msg)
 {
-	SetTextColor(BACKGROUND_RED | FOREGROUND_RED | FOREGROUND_GREEN | FOREGROUND_BLUE);
-
 	switch (msg.msg)
 	{
 		case EMessageType::EMT_StewReady:
 
-			cout << "\nMessage handled by " << GetNameOfEntity(pMiner->ID()) 
-				<< " at time: " << Clock->GetElapsedTime();
-
-			SetTextColor(FOREGROUND_RED | FOREGROUND_INTENSITY);
+			LOG_DEBUG(ELogColor::ELC_Highlight, "Message handled by {} at time: {}", GetNameOfEntity(pMiner->ID()), Clock->GetElapsedTime());
 
-			cout << "\n" << GetNameOfEntity(pMiner->ID()) 
-				<< ": Okay Hun, ahm a comin'!";
+			LOG_INFO(ELogColor::ELC_Red, "{}: Okay Hun, ahm a comin'!", GetNameOfEntity(pMiner->ID()));
 
 			pMiner->GetFSM()->ChangeState(EatStewState::Instance());
 
@@ -244,9 +206,7 @@ void QuenchThirstState::Enter(Miner* pMiner)
 	{
 		pMiner->ChangeLocation(ELocationType::EL_Saloon);
 
-		SetTextColor(FOREGROUND_RED | FOREGROUND_INTENSITY);
-		cout << "\n" << GetNameOfEntity(pMiner->ID()) 
-			<< ": " << "Boy, ah sure is thusty! Walking to the saloon";
+		LOG_INFO(ELogColor::ELC_Red, "{}: Boy, ah sure is thusty! Walking to the saloon", GetNameOfEntity(pMiner->ID()));
 	}
 }
 
@@ -256,24 +216,19 @@ void QuenchThirstState::Execute(Miner* pMiner)
 	{
 		pMiner->BuyAndDrinkWhiskey();
 
-		SetTextColor(FOREGROUND_RED | FOREGROUND_INTENSITY);
-		cout << "\n" << GetNameOfEntity(pMiner->ID()) 
-			<< ": " << "That's mighty fine sippin liquer";
+		LOG_INFO(ELogColor::ELC_Red, "{}: That's mighty fine sippin liquer", GetNameOfEntity(pMiner->ID()));
 
 		pMiner->GetFSM()->ChangeState(EnterMineAndDigForNuggetState::Instance());
 	}
 	else
 	{
-		SetTextColor(FOREGROUND_RED | FOREGROUND_INTENSITY);
-		cout << "\nERROR!\nERROR!\nERROR!";
+		LOG_ERROR(ELogColor::ELC_Red, "{} is in the saloon without being thirsty", GetNameOfEntity(pMiner->ID()));
 	}
 }
 
 void QuenchThirstState::Exit(Miner* pMiner)
 {
-	SetTextColor(FOREGROUND_RED | FOREGROUND_INTENSITY);
-	cout << "\n" << GetNameOfEntity(pMiner->ID()) 
-		<< ": " << "Leaving the saloon, feelin' good";
+	LOG_INFO(ELogColor::ELC_Red, "{}: Leaving the saloon, feelin' good", GetNameOfEntity(pMiner->ID()));
 }
 
 bool QuenchThirstState::OnMessage(Miner* pMiner, const Telegram& msg)
@@ -295,22 +250,19 @@ EatStewState* EatStewState::Instance()
 
 void EatStewState::Enter(Miner* pMiner)
 {
-	cout << "\n" << GetNameOfEntity(pMiner->ID()) 
-		<< ": " << "Smells Reaal good Elsa!";
+	LOG_INFO(ELogColor::ELC_Red, "{}: Smells Reaal good Elsa!", GetNameOfEntity(pMiner->ID()));
 }
 
 void EatStewState::Execute(Miner* pMiner)
 {
-	cout << "\n" << GetNameOfEntity(pMiner->ID()) 
-		<< ": " << "Tastes real good too!";
+	LOG_INFO(ELogColor::ELC_Red, "{}: Tastes real good too!", GetNameOfEntity(pMiner->ID()));
 
 	pMiner->GetFSM()->RevertToPreviousState();
 }
 
 void EatStewState::Exit(Miner* pMiner)
 {
-	cout << "\n" << GetNameOfEntity(pMiner->ID()) 
-		<< ": " << "Thankya li'lle lady. Ah better get back to whatever ah wuz doin'";
+	LOG_INFO(ELogColor::ELC_Red, "{}: Thankya li'lle lady. Ah better get back to whatever ah wuz doin'", GetNameOfEntity(pMiner->ID()));
 }
 
 bool EatStewState::OnMessage(Miner* pMiner, const Telegram& msg)
@@ -319,11 +271,9 @@ bool EatStewState::OnMessage(Miner* pMiner, const Telegram& msg)
 	{
 		case EMessageType::EMT_StewReady:
 
-			cout << "\nMessage handled by " << GetNameOfEntity(pMiner->ID())
-				<< " at time: " << Clock->GetElapsedTime();
+			LOG_DEBUG(ELogColor::ELC_Highlight, "Message handled by {} at time: {}", GetNameOfEntity(pMiner->ID()), Clock->GetElapsedTime());
 
-			cout << "\n" << GetNameOfEntity(pMiner->ID())
-				<< ": Okay hun, ahm a-comin'!";
+			LOG_INFO(ELogColor::ELC_Red, "{}: Okay hun, ahm a-comin'!", GetNameOfEntity(pMiner->ID()));
 
 			pMiner->GetFSM()->ChangeState(EatStewState::Instance());
 
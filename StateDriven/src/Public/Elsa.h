@@ -5,7 +5,6 @@
 #include "Public/FSM/State.h"
 #include "Public/FSM/StateMachine.h"
 #include "Public/Entities/BaseGameEntity.h"
-#include "Public/Misc/ConsoleUtils.h"
 #include "Public/Misc/Utils.h"
 #include "Locations.h"
 #include "Miner.h"
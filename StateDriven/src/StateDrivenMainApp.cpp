@@ -1,8 +1,8 @@
-#pragma once
-
 #include <stdlib.h>
 #include <fstream>
 #include <time.h>
+#include <chrono>
+#include <thread>
 
 #include "Public/Locations.h"
 #include "Public/Miner.h"
@@ -11,7 +11,12 @@
 #include "Public/Entities/EntityNames.h"
 
 #include "Public/Messaging/MessageDispatcher.h"
+#include "Public/Misc/Log.h"
+#include "Public/Misc/Utils.h"
+
+#ifndef HEADLESS
 #include "Public/Misc/ConsoleUtils.h"
+#endif
 
 std::ofstream os;
 #define UPDATE_CALLS 30
@@ -22,10 +27,11 @@ int main()
 	// Define this to send output to a text file (see Locations.h)
 #ifdef TEXTOUTPUT
 	os.open("output.txt");
+	Logger::Instance()->SetOutput(&os);
 #endif
 
 	// Seed random number generator
-	srand((unsigned)time(nullptr));
+	SeedRandom((unsigned)time(nullptr));
 	
 	// Create a Miner
 	Miner* pMiner = new Miner((int)EEntityName::EEN_MinerBob);
@@ -46,15 +52,20 @@ int main()
 		// dispatch any delayed messages
 		Dispatch->DispatchDelayedMessages();
 
-		Sleep(800);
+		std::this_thread::sleep_for(std::chrono::milliseconds(800));
 	}
 
 	// tidy up
 	delete pMiner;
 	delete pElsa;
 
+	// Make sure everything has been written before the prompt
+	LOG_FLUSH();
+
+#ifndef HEADLESS
 	// Wait for a keypress before exiting
 	PressAnyKeyToContinue();
+#endif
 
 	return EXIT_SUCCESS;
 }
\ No newline at end of file
@@ -0,0 +1,66 @@
+#include "Public/AgentStore.h"
+#include "Public/Vehicle.h"
+#include "Public/SteeringBehaviors.h"
+
+//------------------------------- Resize ---------------------------------
+//------------------------------------------------------------------------
+
+template<class T>
+void AgentStoreT<T>::Resize(size_t numAgents)
+{
+	m_posX.resize(numAgents);
+	m_posY.resize(numAgents);
+	m_velX.resize(numAgents);
+	m_velY.resize(numAgents);
+	m_headingX.resize(numAgents);
+	m_headingY.resize(numAgents);
+	m_sideX.resize(numAgents);
+	m_sideY.resize(numAgents);
+	m_mass.resize(numAgents);
+	m_maxSpeed.resize(numAgents);
+	m_maxForce.resize(numAgents);
+	m_bRadius.resize(numAgents);
+	m_flags.resize(numAgents);
+}
+
+//------------------------------- Store ----------------------------------
+//------------------------------------------------------------------------
+
+template<class T>
+void AgentStoreT<T>::Store(size_t i, const Vehicle* pVehicle)
+{
+	const Vector2D pos = pVehicle->Pos();
+	const Vector2D vel = pVehicle->Velocity();
+	const Vector2D heading = pVehicle->Heading();
+	const Vector2D side = pVehicle->Side();
+
+	m_posX[i] = (T)pos.x;
+	m_posY[i] = (T)pos.y;
+	m_velX[i] = (T)vel.x;
+	m_velY[i] = (T)vel.y;
+	m_headingX[i] = (T)heading.x;
+	m_headingY[i] = (T)heading.y;
+	m_sideX[i] = (T)side.x;
+	m_sideY[i] = (T)side.y;
+	m_mass[i] = (T)pVehicle->Mass();
+	m_maxSpeed[i] = (T)pVehicle->MaxSpeed();
+	m_maxForce[i] = (T)pVehicle->MaxForce();
+	m_bRadius[i] = (T)pVehicle->BRadius();
+	m_flags[i] = pVehicle->Steering()->Flags();
+}
+
+//------------------------------- StoreFlockingState ---------------------
+//------------------------------------------------------------------------
+
+template<class T>
+void AgentStoreT<T>::StoreFlockingState(size_t i, const Vector2D& pos, const Vector2D& heading, double bRadius)
+{
+	m_posX[i] = (T)pos.x;
+	m_posY[i] = (T)pos.y;
+	m_headingX[i] = (T)heading.x;
+	m_headingY[i] = (T)heading.y;
+	m_bRadius[i] = (T)bRadius;
+}
+
+template class AgentStoreT<float>;
+template class AgentStoreT<double>;
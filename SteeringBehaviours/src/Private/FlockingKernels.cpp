@@ -0,0 +1,844 @@
+#include "Public/FlockingKernels.h"
+#include "Public/AgentStore.h"
+
+#include <cmath>
+#include <limits>
+
+#if defined(__AVX2__)
+#define FLOCKING_AVX2
+#include <immintrin.h>
+#elif defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define FLOCKING_SSE2
+#include <emmintrin.h>
+#endif
+
+//--------------------------- AccumulateNeighbor ----------------------------------
+// The contribution of a single neighbor n, given the vector from it to the
+// agent
+//----------------------------------------------------------------------------------
+
+template<class T>
+static inline void AccumulateNeighbor(const AgentStoreT<T>& agents, size_t n, T toX, T toY, FlockingSums& sums)
+{
+	sums.m_dPosX += agents.PosX()[n];
+	sums.m_dPosY += agents.PosY()[n];
+
+	sums.m_dHeadingX += agents.HeadingX()[n];
+	sums.m_dHeadingY += agents.HeadingY()[n];
+
+	// Normalize the vector away from the neighbor and scale it inversely
+	// proportional to the distance
+	const T length = std::sqrt(toX * toX + toY * toY);
+
+	if (length > std::numeric_limits<T>::epsilon())
+	{
+		sums.m_dSeparationX += (toX / length) / length;
+		sums.m_dSeparationY += (toY / length) / length;
+	}
+}
+
+//--------------------------- AccumulateFlockingScalar -----------------------------
+//----------------------------------------------------------------------------------
+
+template<class T>
+static void AccumulateScalar(const AgentStoreT<T>& agents, const int* neighbors, size_t count, const Vector2D& pos, FlockingSums& sums)
+{
+	const T* posX = agents.PosX();
+	const T* posY = agents.PosY();
+
+	const T x = (T)pos.x;
+	const T y = (T)pos.y;
+
+	for (size_t i = 0; i < count; ++i)
+	{
+		const int n = neighbors[i];
+
+		AccumulateNeighbor(agents, n, x - posX[n], y - posY[n], sums);
+	}
+
+	sums.m_iCount += (int)count;
+}
+
+void AccumulateFlockingScalar(const AgentStoreT<float>& agents, const int* neighbors, size_t count, const Vector2D& pos, FlockingSums& sums)
+{
+	AccumulateScalar(agents, neighbors, count, pos, sums);
+}
+
+void AccumulateFlockingScalar(const AgentStoreT<double>& agents, const int* neighbors, size_t count, const Vector2D& pos, FlockingSums& sums)
+{
+	AccumulateScalar(agents, neighbors, count, pos, sums);
+}
+
+//--------------------------- AccumulateFlockingInRange ----------------------------
+// The agents from first on, one at a time. The vector versions finish off
+// with this
+//----------------------------------------------------------------------------------
+
+template<class T>
+static void AccumulateInRange(const AgentStoreT<T>& agents, size_t self, int exclude, double radius, size_t first, FlockingSums& sums)
+{
+	const T* posX = agents.PosX();
+	const T* posY = agents.PosY();
+	const T* bRadius = agents.BRadius();
+
+	const T x = posX[self];
+	const T y = posY[self];
+
+	for (size_t n = first; n < agents.Size(); ++n)
+	{
+		if (n == self || (int)n == exclude) continue;
+
+		const T toX = x - posX[n];
+		const T toY = y - posY[n];
+
+		// The other agent's bounding radius is added to the range
+		const T range = (T)radius + bRadius[n];
+
+		if (toX * toX + toY * toY < range * range)
+		{
+			AccumulateNeighbor(agents, n, toX, toY, sums);
+
+			++sums.m_iCount;
+		}
+	}
+}
+
+// The number of bits set in a lane mask
+static inline int CountLanes(int mask)
+{
+	int count = 0;
+
+	for (; mask != 0; mask &= mask - 1)
+	{
+		++count;
+	}
+
+	return count;
+}
+
+#if defined(FLOCKING_AVX2)
+
+//--------------------------- AccumulateFlocking (AVX2, float) ---------------------
+// Eight neighbors at a time, gathering their state straight out of the store.
+// Each neighbor's terms are worked out in float, then added up in double
+//----------------------------------------------------------------------------------
+
+static inline double HorizontalSum(__m256d v)
+{
+	__m128d pair = _mm_add_pd(_mm256_castpd256_pd128(v), _mm256_extractf128_pd(v, 1));
+
+	return _mm_cvtsd_f64(_mm_add_sd(pair, _mm_unpackhi_pd(pair, pair)));
+}
+
+// Adds the eight lanes of v to the four of sum, widened to double first so
+// the running sums lose nothing to float rounding
+static inline __m256d AddWidened(__m256d sum, __m256 v)
+{
+	sum = _mm256_add_pd(sum, _mm256_cvtps_pd(_mm256_castps256_ps128(v)));
+
+	return _mm256_add_pd(sum, _mm256_cvtps_pd(_mm256_extractf128_ps(v, 1)));
+}
+
+void AccumulateFlocking(const AgentStoreT<float>& agents, const int* neighbors, size_t count, const Vector2D& pos, FlockingSums& sums)
+{
+	const float* posX = agents.PosX();
+	const float* posY = agents.PosY();
+	const float* headingX = agents.HeadingX();
+	const float* headingY = agents.HeadingY();
+
+	const __m256 x = _mm256_set1_ps((float)pos.x);
+	const __m256 y = _mm256_set1_ps((float)pos.y);
+	const __m256 epsilon = _mm256_set1_ps(std::numeric_limits<float>::epsilon());
+
+	__m256d sumPosX = _mm256_setzero_pd();
+	__m256d sumPosY = _mm256_setzero_pd();
+	__m256d sumHeadingX = _mm256_setzero_pd();
+	__m256d sumHeadingY = _mm256_setzero_pd();
+	__m256d sumSeparationX = _mm256_setzero_pd();
+	__m256d sumSeparationY = _mm256_setzero_pd();
+
+	size_t i = 0;
+
+	for (; i + 8 <= count; i += 8)
+	{
+		const __m256i idx = _mm256_loadu_si256((const __m256i*)(neighbors + i));
+
+		const __m256 px = _mm256_i32gather_ps(posX, idx, 4);
+		const __m256 py = _mm256_i32gather_ps(posY, idx, 4);
+
+		sumPosX = AddWidened(sumPosX, px);
+		sumPosY = AddWidened(sumPosY, py);
+
+		sumHeadingX = AddWidened(sumHeadingX, _mm256_i32gather_ps(headingX, idx, 4));
+		sumHeadingY = AddWidened(sumHeadingY, _mm256_i32gather_ps(headingY, idx, 4));
+
+		const __m256 toX = _mm256_sub_ps(x, px);
+		const __m256 toY = _mm256_sub_ps(y, py);
+		const __m256 length = _mm256_sqrt_ps(_mm256_add_ps(_mm256_mul_ps(toX, toX), _mm256_mul_ps(toY, toY)));
+
+		// Lanes too close to normalize contribute nothing
+		const __m256 valid = _mm256_cmp_ps(length, epsilon, _CMP_GT_OQ);
+
+		const __m256 sepX = _mm256_div_ps(_mm256_div_ps(toX, length), length);
+		const __m256 sepY = _mm256_div_ps(_mm256_div_ps(toY, length), length);
+
+		sumSeparationX = AddWidened(sumSeparationX, _mm256_and_ps(sepX, valid));
+		sumSeparationY = AddWidened(sumSeparationY, _mm256_and_ps(sepY, valid));
+	}
+
+	sums.m_dPosX += HorizontalSum(sumPosX);
+	sums.m_dPosY += HorizontalSum(sumPosY);
+	sums.m_dHeadingX += HorizontalSum(sumHeadingX);
+	sums.m_dHeadingY += HorizontalSum(sumHeadingY);
+	sums.m_dSeparationX += HorizontalSum(sumSeparationX);
+	sums.m_dSeparationY += HorizontalSum(sumSeparationY);
+	sums.m_iCount += (int)i;
+
+	AccumulateFlockingScalar(agents, neighbors + i, count - i, pos, sums);
+}
+
+//--------------------------- AccumulateFlocking (AVX2) ----------------------------
+// Four neighbors at a time, gathering their state straight out of the store
+//----------------------------------------------------------------------------------
+
+void AccumulateFlocking(const AgentStoreT<double>& agents, const int* neighbors, size_t count, const Vector2D& pos, FlockingSums& sums)
+{
+	const double* posX = agents.PosX();
+	const double* posY = agents.PosY();
+	const double* headingX = agents.HeadingX();
+	const double* headingY = agents.HeadingY();
+
+	const __m256d x = _mm256_set1_pd(pos.x);
+	const __m256d y = _mm256_set1_pd(pos.y);
+	const __m256d epsilon = _mm256_set1_pd(std::numeric_limits<double>::epsilon());
+
+	__m256d sumPosX = _mm256_setzero_pd();
+	__m256d sumPosY = _mm256_setzero_pd();
+	__m256d sumHeadingX = _mm256_setzero_pd();
+	__m256d sumHeadingY = _mm256_setzero_pd();
+	__m256d sumSeparationX = _mm256_setzero_pd();
+	__m256d sumSeparationY = _mm256_setzero_pd();
+
+	size_t i = 0;
+
+	for (; i + 4 <= count; i += 4)
+	{
+		const __m128i idx = _mm_loadu_si128((const __m128i*)(neighbors + i));
+
+		const __m256d px = _mm256_i32gather_pd(posX, idx, 8);
+		const __m256d py = _mm256_i32gather_pd(posY, idx, 8);
+
+		sumPosX = _mm256_add_pd(sumPosX, px);
+		sumPosY = _mm256_add_pd(sumPosY, py);
+
+		sumHeadingX = _mm256_add_pd(sumHeadingX, _mm256_i32gather_pd(headingX, idx, 8));
+		sumHeadingY = _mm256_add_pd(sumHeadingY, _mm256_i32gather_pd(headingY, idx, 8));
+
+		const __m256d toX = _mm256_sub_pd(x, px);
+		const __m256d toY = _mm256_sub_pd(y, py);
+		const __m256d length = _mm256_sqrt_pd(_mm256_add_pd(_mm256_mul_pd(toX, toX), _mm256_mul_pd(toY, toY)));
+
+		// Lanes too close to normalize contribute nothing
+		const __m256d valid = _mm256_cmp_pd(length, epsilon, _CMP_GT_OQ);
+
+		const __m256d sepX = _mm256_div_pd(_mm256_div_pd(toX, length), length);
+		const __m256d sepY = _mm256_div_pd(_mm256_div_pd(toY, length), length);
+
+		sumSeparationX = _mm256_add_pd(sumSeparationX, _mm256_and_pd(sepX, valid));
+		sumSeparationY = _mm256_add_pd(sumSeparationY, _mm256_and_pd(sepY, valid));
+	}
+
+	sums.m_dPosX += HorizontalSum(sumPosX);
+	sums.m_dPosY += HorizontalSum(sumPosY);
+	sums.m_dHeadingX += HorizontalSum(sumHeadingX);
+	sums.m_dHeadingY += HorizontalSum(sumHeadingY);
+	sums.m_dSeparationX += HorizontalSum(sumSeparationX);
+	sums.m_dSeparationY += HorizontalSum(sumSeparationY);
+	sums.m_iCount += (int)i;
+
+	AccumulateFlockingScalar(agents, neighbors + i, count - i, pos, sums);
+}
+
+//--------------------------- AccumulateFlockingInRange (AVX2, float) --------------
+// Eight agents at a time, loaded straight from the store. Lanes out of range,
+// and those holding the agent itself or the one excluded, are masked out of
+// the sums
+//----------------------------------------------------------------------------------
+
+void AccumulateFlockingInRange(const AgentStoreT<float>& agents, size_t self, int exclude, double radius, FlockingSums& sums)
+{
+	const float* posX = agents.PosX();
+	const float* posY = agents.PosY();
+	const float* headingX = agents.HeadingX();
+	const float* headingY = agents.HeadingY();
+	const float* bRadius = agents.BRadius();
+
+	const __m256 x = _mm256_set1_ps(posX[self]);
+	const __m256 y = _mm256_set1_ps(posY[self]);
+	const __m256 viewRadius = _mm256_set1_ps((float)radius);
+	const __m256 epsilon = _mm256_set1_ps(std::numeric_limits<float>::epsilon());
+
+	// The offset of each lane, to find self and exclude by
+	const __m256i lanes = _mm256_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7);
+	const __m256i selfIndex = _mm256_set1_epi32((int)self);
+	const __m256i excludeIndex = _mm256_set1_epi32(exclude);
+
+	__m256d sumPosX = _mm256_setzero_pd();
+	__m256d sumPosY = _mm256_setzero_pd();
+	__m256d sumHeadingX = _mm256_setzero_pd();
+	__m256d sumHeadingY = _mm256_setzero_pd();
+	__m256d sumSeparationX = _mm256_setzero_pd();
+	__m256d sumSeparationY = _mm256_setzero_pd();
+
+	int count = 0;
+	size_t n = 0;
+
+	for (; n + 8 <= agents.Size(); n += 8)
+	{
+		const __m256 px = _mm256_loadu_ps(posX + n);
+		const __m256 py = _mm256_loadu_ps(posY + n);
+
+		const __m256 toX = _mm256_sub_ps(x, px);
+		const __m256 toY = _mm256_sub_ps(y, py);
+		const __m256 distanceSq = _mm256_add_ps(_mm256_mul_ps(toX, toX), _mm256_mul_ps(toY, toY));
+
+		// The other agent's bounding radius is added to the range
+		const __m256 range = _mm256_add_ps(viewRadius, _mm256_loadu_ps(bRadius + n));
+
+		const __m256i index = _mm256_add_epi32(_mm256_set1_epi32((int)n), lanes);
+		const __m256 skip = _mm256_castsi256_ps(_mm256_or_si256(_mm256_cmpeq_epi32(index, selfIndex), _mm256_cmpeq_epi32(index, excludeIndex)));
+
+		const __m256 inRange = _mm256_andnot_ps(skip, _mm256_cmp_ps(distanceSq, _mm256_mul_ps(range, range), _CMP_LT_OQ));
+
+		// Most of the store is usually out of view
+		const int mask = _mm256_movemask_ps(inRange);
+
+		if (mask == 0) continue;
+
+		count += CountLanes(mask);
+
+		sumPosX = AddWidened(sumPosX, _mm256_and_ps(px, inRange));
+		sumPosY = AddWidened(sumPosY, _mm256_and_ps(py, inRange));
+
+		sumHeadingX = AddWidened(sumHeadingX, _mm256_and_ps(_mm256_loadu_ps(headingX + n), inRange));
+		sumHeadingY = AddWidened(sumHeadingY, _mm256_and_ps(_mm256_loadu_ps(headingY + n), inRange));
+
+		const __m256 length = _mm256_sqrt_ps(distanceSq);
+
+		// Lanes too close to normalize contribute nothing
+		const __m256 valid = _mm256_and_ps(inRange, _mm256_cmp_ps(length, epsilon, _CMP_GT_OQ));
+
+		const __m256 sepX = _mm256_div_ps(_mm256_div_ps(toX, length), length);
+		const __m256 sepY = _mm256_div_ps(_mm256_div_ps(toY, length), length);
+
+		sumSeparationX = AddWidened(sumSeparationX, _mm256_and_ps(sepX, valid));
+		sumSeparationY = AddWidened(sumSeparationY, _mm256_and_ps(sepY, valid));
+	}
+
+	sums.m_dPosX += HorizontalSum(sumPosX);
+	sums.m_dPosY += HorizontalSum(sumPosY);
+	sums.m_dHeadingX += HorizontalSum(sumHeadingX);
+	sums.m_dHeadingY += HorizontalSum(sumHeadingY);
+	sums.m_dSeparationX += HorizontalSum(sumSeparationX);
+	sums.m_dSeparationY += HorizontalSum(sumSeparationY);
+	sums.m_iCount += count;
+
+	AccumulateInRange(agents, self, exclude, radius, n, sums);
+}
+
+//--------------------------- AccumulateFlockingInRange (AVX2) ---------------------
+// Four agents at a time, as above
+//----------------------------------------------------------------------------------
+
+void AccumulateFlockingInRange(const AgentStoreT<double>& agents, size_t self, int exclude, double radius, FlockingSums& sums)
+{
+	const double* posX = agents.PosX();
+	const double* posY = agents.PosY();
+	const double* headingX = agents.HeadingX();
+	const double* headingY = agents.HeadingY();
+	const double* bRadius = agents.BRadius();
+
+	const __m256d x = _mm256_set1_pd(posX[self]);
+	const __m256d y = _mm256_set1_pd(posY[self]);
+	const __m256d viewRadius = _mm256_set1_pd(radius);
+	const __m256d epsilon = _mm256_set1_pd(std::numeric_limits<double>::epsilon());
+
+	// The offset of each lane, repeated in both halves so a 32 bit compare
+	// sets the whole lane
+	const __m256i lanes = _mm256_setr_epi32(0, 0, 1, 1, 2, 2, 3, 3);
+	const __m256i selfIndex = _mm256_set1_epi32((int)self);
+	const __m256i excludeIndex = _mm256_set1_epi32(exclude);
+
+	__m256d sumPosX = _mm256_setzero_pd();
+	__m256d sumPosY = _mm256_setzero_pd();
+	__m256d sumHeadingX = _mm256_setzero_pd();
+	__m256d sumHeadingY = _mm256_setzero_pd();
+	__m256d sumSeparationX = _mm256_setzero_pd();
+	__m256d sumSeparationY = _mm256_setzero_pd();
+
+	int count = 0;
+	size_t n = 0;
+
+	for (; n + 4 <= agents.Size(); n += 4)
+	{
+		const __m256d px = _mm256_loadu_pd(posX + n);
+		const __m256d py = _mm256_loadu_pd(posY + n);
+
+		const __m256d toX = _mm256_sub_pd(x, px);
+		const __m256d toY = _mm256_sub_pd(y, py);
+		const __m256d distanceSq = _mm256_add_pd(_mm256_mul_pd(toX, toX), _mm256_mul_pd(toY, toY));
+
+		// The other agent's bounding radius is added to the range
+		const __m256d range = _mm256_add_pd(viewRadius, _mm256_loadu_pd(bRadius + n));
+
+		const __m256i index = _mm256_add_epi32(_mm256_set1_epi32((int)n), lanes);
+		const __m256d skip = _mm256_castsi256_pd(_mm256_or_si256(_mm256_cmpeq_epi32(index, selfIndex), _mm256_cmpeq_epi32(index, excludeIndex)));
+
+		const __m256d inRange = _mm256_andnot_pd(skip, _mm256_cmp_pd(distanceSq, _mm256_mul_pd(range, range), _CMP_LT_OQ));
+
+		// Most of the store is usually out of view
+		const int mask = _mm256_movemask_pd(inRange);
+
+		if (mask == 0) continue;
+
+		count += CountLanes(mask);
+
+		sumPosX = _mm256_add_pd(sumPosX, _mm256_and_pd(px, inRange));
+		sumPosY = _mm256_add_pd(sumPosY, _mm256_and_pd(py, inRange));
+
+		sumHeadingX = _mm256_add_pd(sumHeadingX, _mm256_and_pd(_mm256_loadu_pd(headingX + n), inRange));
+		sumHeadingY = _mm256_add_pd(sumHeadingY, _mm256_and_pd(_mm256_loadu_pd(headingY + n), inRange));
+
+		const __m256d length = _mm256_sqrt_pd(distanceSq);
+
+		// Lanes too close to normalize contribute nothing
+		const __m256d valid = _mm256_and_pd(inRange, _mm256_cmp_pd(length, epsilon, _CMP_GT_OQ));
+
+		const __m256d sepX = _mm256_div_pd(_mm256_div_pd(toX, length), length);
+		const __m256d sepY = _mm256_div_pd(_mm256_div_pd(toY, length), length);
+
+		sumSeparationX = _mm256_add_pd(sumSeparationX, _mm256_and_pd(sepX, valid));
+		sumSeparationY = _mm256_add_pd(sumSeparationY, _mm256_and_pd(sepY, valid));
+	}
+
+	sums.m_dPosX += HorizontalSum(sumPosX);
+	sums.m_dPosY += HorizontalSum(sumPosY);
+	sums.m_dHeadingX += HorizontalSum(sumHeadingX);
+	sums.m_dHeadingY += HorizontalSum(sumHeadingY);
+	sums.m_dSeparationX += HorizontalSum(sumSeparationX);
+	sums.m_dSeparationY += HorizontalSum(sumSeparationY);
+	sums.m_iCount += count;
+
+	AccumulateInRange(agents, self, exclude, radius, n, sums);
+}
+
+#define FLOCKING_KERNEL_NAME "avx2"
+
+#elif defined(FLOCKING_SSE2)
+
+//--------------------------- AccumulateFlocking (SSE2, float) ---------------------
+// Four neighbors at a time, loaded by hand as in the double version below.
+// Each neighbor's terms are worked out in float, then added up in double
+//----------------------------------------------------------------------------------
+
+static inline double HorizontalSum(__m128d v)
+{
+	return _mm_cvtsd_f64(_mm_add_sd(v, _mm_unpackhi_pd(v, v)));
+}
+
+// Adds the four lanes of v to the two of sum, widened to double first so
+// the running sums lose nothing to float rounding
+static inline __m128d AddWidened(__m128d sum, __m128 v)
+{
+	sum = _mm_add_pd(sum, _mm_cvtps_pd(v));
+
+	return _mm_add_pd(sum, _mm_cvtps_pd(_mm_movehl_ps(v, v)));
+}
+
+void AccumulateFlocking(const AgentStoreT<float>& agents, const int* neighbors, size_t count, const Vector2D& pos, FlockingSums& sums)
+{
+	const float* posX = agents.PosX();
+	const float* posY = agents.PosY();
+	const float* headingX = agents.HeadingX();
+	const float* headingY = agents.HeadingY();
+
+	const __m128 x = _mm_set1_ps((float)pos.x);
+	const __m128 y = _mm_set1_ps((float)pos.y);
+	const __m128 epsilon = _mm_set1_ps(std::numeric_limits<float>::epsilon());
+
+	__m128d sumPosX = _mm_setzero_pd();
+	__m128d sumPosY = _mm_setzero_pd();
+	__m128d sumHeadingX = _mm_setzero_pd();
+	__m128d sumHeadingY = _mm_setzero_pd();
+	__m128d sumSeparationX = _mm_setzero_pd();
+	__m128d sumSeparationY = _mm_setzero_pd();
+
+	size_t i = 0;
+
+	for (; i + 4 <= count; i += 4)
+	{
+		const int n0 = neighbors[i];
+		const int n1 = neighbors[i + 1];
+		const int n2 = neighbors[i + 2];
+		const int n3 = neighbors[i + 3];
+
+		const __m128 px = _mm_set_ps(posX[n3], posX[n2], posX[n1], posX[n0]);
+		const __m128 py = _mm_set_ps(posY[n3], posY[n2], posY[n1], posY[n0]);
+
+		sumPosX = AddWidened(sumPosX, px);
+		sumPosY = AddWidened(sumPosY, py);
+
+		sumHeadingX = AddWidened(sumHeadingX, _mm_set_ps(headingX[n3], headingX[n2], headingX[n1], headingX[n0]));
+		sumHeadingY = AddWidened(sumHeadingY, _mm_set_ps(headingY[n3], headingY[n2], headingY[n1], headingY[n0]));
+
+		const __m128 toX = _mm_sub_ps(x, px);
+		const __m128 toY = _mm_sub_ps(y, py);
+		const __m128 length = _mm_sqrt_ps(_mm_add_ps(_mm_mul_ps(toX, toX), _mm_mul_ps(toY, toY)));
+
+		// Lanes too close to normalize contribute nothing
+		const __m128 valid = _mm_cmpgt_ps(length, epsilon);
+
+		const __m128 sepX = _mm_div_ps(_mm_div_ps(toX, length), length);
+		const __m128 sepY = _mm_div_ps(_mm_div_ps(toY, length), length);
+
+		sumSeparationX = AddWidened(sumSeparationX, _mm_and_ps(sepX, valid));
+		sumSeparationY = AddWidened(sumSeparationY, _mm_and_ps(sepY, valid));
+	}
+
+	sums.m_dPosX += HorizontalSum(sumPosX);
+	sums.m_dPosY += HorizontalSum(sumPosY);
+	sums.m_dHeadingX += HorizontalSum(sumHeadingX);
+	sums.m_dHeadingY += HorizontalSum(sumHeadingY);
+	sums.m_dSeparationX += HorizontalSum(sumSeparationX);
+	sums.m_dSeparationY += HorizontalSum(sumSeparationY);
+	sums.m_iCount += (int)i;
+
+	AccumulateFlockingScalar(agents, neighbors + i, count - i, pos, sums);
+}
+
+//--------------------------- AccumulateFlocking (SSE2) ----------------------------
+// Two neighbors at a time. SSE2 has no gather, so each pair is loaded by hand
+//----------------------------------------------------------------------------------
+
+void AccumulateFlocking(const AgentStoreT<double>& agents, const int* neighbors, size_t count, const Vector2D& pos, FlockingSums& sums)
+{
+	const double* posX = agents.PosX();
+	const double* posY = agents.PosY();
+	const double* headingX = agents.HeadingX();
+	const double* headingY = agents.HeadingY();
+
+	const __m128d x = _mm_set1_pd(pos.x);
+	const __m128d y = _mm_set1_pd(pos.y);
+	const __m128d epsilon = _mm_set1_pd(std::numeric_limits<double>::epsilon());
+
+	__m128d sumPosX = _mm_setzero_pd();
+	__m128d sumPosY = _mm_setzero_pd();
+	__m128d sumHeadingX = _mm_setzero_pd();
+	__m128d sumHeadingY = _mm_setzero_pd();
+	__m128d sumSeparationX = _mm_setzero_pd();
+	__m128d sumSeparationY = _mm_setzero_pd();
+
+	size_t i = 0;
+
+	for (; i + 2 <= count; i += 2)
+	{
+		const int n0 = neighbors[i];
+		const int n1 = neighbors[i + 1];
+
+		const __m128d px = _mm_set_pd(posX[n1], posX[n0]);
+		const __m128d py = _mm_set_pd(posY[n1], posY[n0]);
+
+		sumPosX = _mm_add_pd(sumPosX, px);
+		sumPosY = _mm_add_pd(sumPosY, py);
+
+		sumHeadingX = _mm_add_pd(sumHeadingX, _mm_set_pd(headingX[n1], headingX[n0]));
+		sumHeadingY = _mm_add_pd(sumHeadingY, _mm_set_pd(headingY[n1], headingY[n0]));
+
+		const __m128d toX = _mm_sub_pd(x, px);
+		const __m128d toY = _mm_sub_pd(y, py);
+		const __m128d length = _mm_sqrt_pd(_mm_add_pd(_mm_mul_pd(toX, toX), _mm_mul_pd(toY, toY)));
+
+		// Lanes too close to normalize contribute nothing
+		const __m128d valid = _mm_cmpgt_pd(length, epsilon);
+
+		const __m128d sepX = _mm_div_pd(_mm_div_pd(toX, length), length);
+		const __m128d sepY = _mm_div_pd(_mm_div_pd(toY, length), length);
+
+		sumSeparationX = _mm_add_pd(sumSeparationX, _mm_and_pd(sepX, valid));
+		sumSeparationY = _mm_add_pd(sumSeparationY, _mm_and_pd(sepY, valid));
+	}
+
+	sums.m_dPosX += HorizontalSum(sumPosX);
+	sums.m_dPosY += HorizontalSum(sumPosY);
+	sums.m_dHeadingX += HorizontalSum(sumHeadingX);
+	sums.m_dHeadingY += HorizontalSum(sumHeadingY);
+	sums.m_dSeparationX += HorizontalSum(sumSeparationX);
+	sums.m_dSeparationY += HorizontalSum(sumSeparationY);
+	sums.m_iCount += (int)i;
+
+	AccumulateFlockingScalar(agents, neighbors + i, count - i, pos, sums);
+}
+
+//--------------------------- AccumulateFlockingInRange (SSE2, float) --------------
+// Four agents at a time, loaded straight from the store. Lanes out of range,
+// and those holding the agent itself or the one excluded, are masked out of
+// the sums
+//----------------------------------------------------------------------------------
+
+void AccumulateFlockingInRange(const AgentStoreT<float>& agents, size_t self, int exclude, double radius, FlockingSums& sums)
+{
+	const float* posX = agents.PosX();
+	const float* posY = agents.PosY();
+	const float* headingX = agents.HeadingX();
+	const float* headingY = agents.HeadingY();
+	const float* bRadius = agents.BRadius();
+
+	const __m128 x = _mm_set1_ps(posX[self]);
+	const __m128 y = _mm_set1_ps(posY[self]);
+	const __m128 viewRadius = _mm_set1_ps((float)radius);
+	const __m128 epsilon = _mm_set1_ps(std::numeric_limits<float>::epsilon());
+
+	// The offset of each lane, to find self and exclude by
+	const __m128i lanes = _mm_setr_epi32(0, 1, 2, 3);
+	const __m128i selfIndex = _mm_set1_epi32((int)self);
+	const __m128i excludeIndex = _mm_set1_epi32(exclude);
+
+	__m128d sumPosX = _mm_setzero_pd();
+	__m128d sumPosY = _mm_setzero_pd();
+	__m128d sumHeadingX = _mm_setzero_pd();
+	__m128d sumHeadingY = _mm_setzero_pd();
+	__m128d sumSeparationX = _mm_setzero_pd();
+	__m128d sumSeparationY = _mm_setzero_pd();
+
+	int count = 0;
+	size_t n = 0;
+
+	for (; n + 4 <= agents.Size(); n += 4)
+	{
+		const __m128 px = _mm_loadu_ps(posX + n);
+		const __m128 py = _mm_loadu_ps(posY + n);
+
+		const __m128 toX = _mm_sub_ps(x, px);
+		const __m128 toY = _mm_sub_ps(y, py);
+		const __m128 distanceSq = _mm_add_ps(_mm_mul_ps(toX, toX), _mm_mul_ps(toY, toY));
+
+		// The other agent's bounding radius is added to the range
+		const __m128 range = _mm_add_ps(viewRadius, _mm_loadu_ps(bRadius + n));
+
+		const __m128i index = _mm_add_epi32(_mm_set1_epi32((int)n), lanes);
+		const __m128 skip = _mm_castsi128_ps(_mm_or_si128(_mm_cmpeq_epi32(index, selfIndex), _mm_cmpeq_epi32(index, excludeIndex)));
+
+		const __m128 inRange = _mm_andnot_ps(skip, _mm_cmplt_ps(distanceSq, _mm_mul_ps(range, range)));
+
+		// Most of the store is usually out of view
+		const int mask = _mm_movemask_ps(inRange);
+
+		if (mask == 0) continue;
+
+		count += CountLanes(mask);
+
+		sumPosX = AddWidened(sumPosX, _mm_and_ps(px, inRange));
+		sumPosY = AddWidened(sumPosY, _mm_and_ps(py, inRange));
+
+		sumHeadingX = AddWidened(sumHeadingX, _mm_and_ps(_mm_loadu_ps(headingX + n), inRange));
+		sumHeadingY = AddWidened(sumHeadingY, _mm_and_ps(_mm_loadu_ps(headingY + n), inRange));
+
+		const __m128 length = _mm_sqrt_ps(distanceSq);
+
+		// Lanes too close to normalize contribute nothing
+		const __m128 valid = _mm_and_ps(inRange, _mm_cmpgt_ps(length, epsilon));
+
+		const __m128 sepX = _mm_div_ps(_mm_div_ps(toX, length), length);
+		const __m128 sepY = _mm_div_ps(_mm_div_ps(toY, length), length);
+
+		sumSeparationX = AddWidened(sumSeparationX, _mm_and_ps(sepX, valid));
+		sumSeparationY = AddWidened(sumSeparationY, _mm_and_ps(sepY, valid));
+	}
+
+	sums.m_dPosX += HorizontalSum(sumPosX);
+	sums.m_dPosY += HorizontalSum(sumPosY);
+	sums.m_dHeadingX += HorizontalSum(sumHeadingX);
+	sums.m_dHeadingY += HorizontalSum(sumHeadingY);
+	sums.m_dSeparationX += HorizontalSum(sumSeparationX);
+	sums.m_dSeparationY += HorizontalSum(sumSeparationY);
+	sums.m_iCount += count;
+
+	AccumulateInRange(agents, self, exclude, radius, n, sums);
+}
+
+//--------------------------- AccumulateFlockingInRange (SSE2) ---------------------
+// Two agents at a time, as above
+//----------------------------------------------------------------------------------
+
+void AccumulateFlockingInRange(const AgentStoreT<double>& agents, size_t self, int exclude, double radius, FlockingSums& sums)
+{
+	const double* posX = agents.PosX();
+	const double* posY = agents.PosY();
+	const double* headingX = agents.HeadingX();
+	const double* headingY = agents.HeadingY();
+	const double* bRadius = agents.BRadius();
+
+	const __m128d x = _mm_set1_pd(posX[self]);
+	const __m128d y = _mm_set1_pd(posY[self]);
+	const __m128d viewRadius = _mm_set1_pd(radius);
+	const __m128d epsilon = _mm_set1_pd(std::numeric_limits<double>::epsilon());
+
+	// The offset of each lane, repeated in both halves so a 32 bit compare
+	// sets the whole lane
+	const __m128i lanes = _mm_setr_epi32(0, 0, 1, 1);
+	const __m128i selfIndex = _mm_set1_epi32((int)self);
+	const __m128i excludeIndex = _mm_set1_epi32(exclude);
+
+	__m128d sumPosX = _mm_setzero_pd();
+	__m128d sumPosY = _mm_setzero_pd();
+	__m128d sumHeadingX = _mm_setzero_pd();
+	__m128d sumHeadingY = _mm_setzero_pd();
+	__m128d sumSeparationX = _mm_setzero_pd();
+	__m128d sumSeparationY = _mm_setzero_pd();
+
+	int count = 0;
+	size_t n = 0;
+
+	for (; n + 2 <= agents.Size(); n += 2)
+	{
+		const __m128d px = _mm_loadu_pd(posX + n);
+		const __m128d py = _mm_loadu_pd(posY + n);
+
+		const __m128d toX = _mm_sub_pd(x, px);
+		const __m128d toY = _mm_sub_pd(y, py);
+		const __m128d distanceSq = _mm_add_pd(_mm_mul_pd(toX, toX), _mm_mul_pd(toY, toY));
+
+		// The other agent's bounding radius is added to the range
+		const __m128d range = _mm_add_pd(viewRadius, _mm_loadu_pd(bRadius + n));
+
+		const __m128i index = _mm_add_epi32(_mm_set1_epi32((int)n), lanes);
+		const __m128d skip = _mm_castsi128_pd(_mm_or_si128(_mm_cmpeq_epi32(index, selfIndex), _mm_cmpeq_epi32(index, excludeIndex)));
+
+		const __m128d inRange = _mm_andnot_pd(skip, _mm_cmplt_pd(distanceSq, _mm_mul_pd(range, range)));
+
+		// Most of the store is usually out of view
+		const int mask = _mm_movemask_pd(inRange);
+
+		if (mask == 0) continue;
+
+		count += CountLanes(mask);
+
+		sumPosX = _mm_add_pd(sumPosX, _mm_and_pd(px, inRange));
+		sumPosY = _mm_add_pd(sumPosY, _mm_and_pd(py, inRange));
+
+		sumHeadingX = _mm_add_pd(sumHeadingX, _mm_and_pd(_mm_loadu_pd(headingX + n), inRange));
+		sumHeadingY = _mm_add_pd(sumHeadingY, _mm_and_pd(_mm_loadu_pd(headingY + n), inRange));
+
+		const __m128d length = _mm_sqrt_pd(distanceSq);
+
+		// Lanes too close to normalize contribute nothing
+		const __m128d valid = _mm_and_pd(inRange, _mm_cmpgt_pd(length, epsilon));
+
+		const __m128d sepX = _mm_div_pd(_mm_div_pd(toX, length), length);
+		const __m128d sepY = _mm_div_pd(_mm_div_pd(toY, length), length);
+
+		sumSeparationX = _mm_add_pd(sumSeparationX, _mm_and_pd(sepX, valid));
+		sumSeparationY = _mm_add_pd(sumSeparationY, _mm_and_pd(sepY, valid));
+	}
+
+	sums.m_dPosX += HorizontalSum(sumPosX);
+	sums.m_dPosY += HorizontalSum(sumPosY);
+	sums.m_dHeadingX += HorizontalSum(sumHeadingX);
+	sums.m_dHeadingY += HorizontalSum(sumHeadingY);
+	sums.m_dSeparationX += HorizontalSum(sumSeparationX);
+	sums.m_dSeparationY += HorizontalSum(sumSeparationY);
+	sums.m_iCount += count;
+
+	AccumulateInRange(agents, self, exclude, radius, n, sums);
+}
+
+#define FLOCKING_KERNEL_NAME "sse2"
+
+#else
+
+//--------------------------- AccumulateFlocking -----------------------------------
+// No vector instructions available
+//----------------------------------------------------------------------------------
+
+void AccumulateFlocking(const AgentStoreT<float>& agents, const int* neighbors, size_t count, const Vector2D& pos, FlockingSums& sums)
+{
+	AccumulateScalar(agents, neighbors, count, pos, sums);
+}
+
+void AccumulateFlocking(const AgentStoreT<double>& agents, const int* neighbors, size_t count, const Vector2D& pos, FlockingSums& sums)
+{
+	AccumulateScalar(agents, neighbors, count, pos, sums);
+}
+
+void AccumulateFlockingInRange(const AgentStoreT<float>& agents, size_t self, int exclude, double radius, FlockingSums& sums)
+{
+	AccumulateInRange(agents, self, exclude, radius, 0, sums);
+}
+
+void AccumulateFlockingInRange(const AgentStoreT<double>& agents, size_t self, int exclude, double radius, FlockingSums& sums)
+{
+	AccumulateInRange(agents, self, exclude, radius, 0, sums);
+}
+
+#define FLOCKING_KERNEL_NAME "scalar"
+
+#endif
+
+//--------------------------- FlockingKernelName -----------------------------------
+//----------------------------------------------------------------------------------
+
+const char* FlockingKernelName()
+{
+#ifdef STEERING_FLOAT
+	return FLOCKING_KERNEL_NAME "-float";
+#else
+	return FLOCKING_KERNEL_NAME;
+#endif
+}
+
+//--------------------------- FlockingSeparation -----------------------------------
+// The sum of the vectors away from each neighbor is the force itself
+//----------------------------------------------------------------------------------
+
+Vector2D FlockingSeparation(const FlockingSums& sums)
+{
+	return Vector2D(sums.m_dSeparationX, sums.m_dSeparationY);
+}
+
+//--------------------------- FlockingAlignment ------------------------------------
+// Steers from the agent's heading towards the average heading of its neighbors
+//----------------------------------------------------------------------------------
+
+Vector2D FlockingAlignment(const FlockingSums& sums, const Vector2D& heading)
+{
+	Vector2D averageHeading;
+
+	if (sums.m_iCount > 0)
+	{
+		averageHeading = Vector2D(sums.m_dHeadingX, sums.m_dHeadingY) / (double)sums.m_iCount;
+		averageHeading -= heading;
+	}
+
+	return averageHeading;
+}
+
+//--------------------------- FlockingCohesion -------------------------------------
+// Seeks the center of mass of the neighbors, normalized
+//----------------------------------------------------------------------------------
+
+Vector2D FlockingCohesion(const FlockingSums& sums, const Vector2D& pos, const Vector2D& velocity, double maxSpeed)
+{
+	Vector2D steeringForce;
+
+	if (sums.m_iCount > 0)
+	{
+		const Vector2D centerOfMass = Vector2D(sums.m_dPosX, sums.m_dPosY) / (double)sums.m_iCount;
+
+		// The same as SteeringBehavior::Seek
+		const Vector2D desiredVelocity = Vec2DNormalize(centerOfMass - pos) * maxSpeed;
+
+		steeringForce = desiredVelocity - velocity;
+	}
+
+	return Vec2DNormalize(steeringForce);
+}
@@ -5,22 +5,41 @@
 #include "Public/Path.h"
 #include "Public/Obstacle.h"
 #include "Public/SteeringBehaviors.h"
-#include "Public/Resource.h"
 #include "Public/2D/Geometry.h"
 #include "Public/2D/Wall2D.h"
 #include "Public/2D/Transformations.h"
-#include "Public/2D/Geometry.h"
 #include "Public/Misc/Smoother.h"
 #include "Public/Misc/StreamUtils.h"
-#include "Public/Misc/WindowsUtils.h"
+#include "Public/Misc/Profiler.h"
 
 #include <list>
+#include <cassert>
+#include <algorithm>
+
+//------------------------------- WorldSetup -----------------------------
+//------------------------------------------------------------------------
+
+WorldSetup::WorldSetup()
+	:m_iNumAgents(Prm.NumAgents()),
+	m_iNumObstacles(Prm.NumObstacles()),
+	m_iNumCellsX(Prm.NumCellsX()),
+	m_iNumCellsY(Prm.NumCellsY())
+{
+}
+
+// The arena memory one agent takes up: the vehicle and the parts it
+// creates, each with the record the arena keeps to destroy it
+static const size_t AgentFootprint =
+	sizeof(Vehicle) + sizeof(SteeringBehavior) + sizeof(Smoother<Vector2D>) + sizeof(Path) + 4 * 4 * sizeof(void*);
 
 //------------------------------- ctor -----------------------------------
 //------------------------------------------------------------------------
 
-GameWorld::GameWorld(int cx, int cy)
-	:m_cxClient(cx),
+GameWorld::GameWorld(int cx, int cy, unsigned int seed, const WorldSetup& setup, Arena* arena)
+	:m_pArena(arena),
+	m_bOwnsArena(arena == nullptr),
+	m_dMaxObstacleRadius(0.0),
+	m_cxClient(cx),
 	m_cyClient(cy),
 	m_bPaused(false),
 	m_vCrosshair(Vector2D(cxClient() / 2.0, cyClient() / 2.0)),
@@ -36,24 +55,49 @@ GameWorld::GameWorld(int cx, int cy)
 	m_pPath(nullptr),
 	m_bRenderNeighbors(false),
 	m_bViewKeys(false),
-	m_bShowCellSpaceInfo(false)
+	m_bShowCellSpaceInfo(false),
+	m_iNumObstacles(setup.m_iNumObstacles),
+	m_bBucketsDirty(true),
+	m_iSeed(seed),
+	m_random(seed),
+	m_dFixedTimeStep(0.0),
+	m_dTimeAccumulator(0.0),
+	m_iFrame(0),
+	m_pRecording(nullptr)
 {
+	if (m_bOwnsArena)
+	{
+		// Room for every agent in one chunk
+		m_pArena = new Arena(setup.m_iNumAgents * AgentFootprint + 1024);
+	}
+
+	m_pThreadPool = new ThreadPool(Prm.NumWorkerThreads());
+
 	// Setup the spatial subdivision class
-	m_pCellSpace = new CellSpacePartition<Vehicle*>((double)cx, (double)cy, Prm.NumCellsX(), Prm.NumCellsY(), Prm.NumAgents());
+	m_pCellSpace = new CellSpacePartition<Vehicle*, Real>((double)cx, (double)cy, setup.m_iNumCellsX, setup.m_iNumCellsY, setup.m_iNumAgents);
+
+	// Size the obstacle cells so the range of a detection box spans about
+	// three of them
+	const double obstacleCellSize = 2 * Prm.MinDetectionBoxLength() + Prm.MaxObstacleRadius();
+
+	m_pObstacleSpace = new CellSpacePartition<BaseGameEntity*>((double)cx, (double)cy,
+		std::max(1, (int)(cx / obstacleCellSize)), std::max(1, (int)(cy / obstacleCellSize)), setup.m_iNumObstacles);
 
 	double border = 30;
-	m_pPath = new Path(5, border, border, cx - border, cy - border, true);
+	m_pPath = new Path(5, border, border, cx - border, cy - border, true, m_random);
 
 	// Setup the agents
-	for (int a = 0; a < Prm.NumAgents(); ++a)
+	for (int a = 0; a < setup.m_iNumAgents; ++a)
 	{
 		// Determine a random starting position
-		Vector2D spawnPos = Vector2D(cx / 2.0 + RandomClamped() * cx / 2.0, cy / 2.0 + RandomClamped() * cy / 2.0);
+		const double spawnX = cx / 2.0 + m_random.RandomClamped() * cx / 2.0;
+		const double spawnY = cy / 2.0 + m_random.RandomClamped() * cy / 2.0;
+		const double rotation = m_random.RandFloat() * TwoPi;
 
-		Vehicle* pVehicle = new Vehicle(
+		Vehicle* pVehicle = m_pArena->New<Vehicle>(
 			this,
-			spawnPos, // initial position
-			RandFloat() * TwoPi, // start rotation
+			Vector2D(spawnX, spawnY), // initial position
+			rotation, // start rotation
 			Vector2D(0, 0), // velocity
 			Prm.VehicleMass(), // mass
 			Prm.MaxSteeringForce(), // max force
@@ -63,6 +107,7 @@ GameWorld::GameWorld(int cx, int cy)
 		);
 
 		pVehicle->Steering()->FlockingOn();
+		pVehicle->SetIndex(a);
 
 		m_vehicles.push_back(pVehicle);
 
@@ -72,20 +117,26 @@ GameWorld::GameWorld(int cx, int cy)
 
 #define SHOAL
 #ifdef SHOAL
-		m_vehicles[Prm.NumAgents() - 1]->Steering()->FlockingOff();
-		m_vehicles[Prm.NumAgents() - 1]->SetScale(Vector2D(10, 10));
-		m_vehicles[Prm.NumAgents() - 1]->Steering()->WanderOn();
-		m_vehicles[Prm.NumAgents() - 1]->SetMaxSpeed(70);
+	// The last agent plays the predator, so there has to be one
+	if (!m_vehicles.empty())
+	{
+		m_vehicles[setup.m_iNumAgents - 1]->Steering()->FlockingOff();
+		m_vehicles[setup.m_iNumAgents - 1]->SetScale(Vector2D(10, 10));
+		m_vehicles[setup.m_iNumAgents - 1]->Steering()->WanderOn();
+		m_vehicles[setup.m_iNumAgents - 1]->SetMaxSpeed(70);
 
-		for (int i = 0; i < Prm.NumAgents(); ++i)
+		for (int i = 0; i < setup.m_iNumAgents; ++i)
 		{
-			m_vehicles[i]->Steering()->EvadeOn(m_vehicles[Prm.NumAgents() - 1]);
+			m_vehicles[i]->Steering()->EvadeOn(m_vehicles[setup.m_iNumAgents - 1]);
 		}
+	}
 #endif
 
 		// Create any obstacles or walls
 		 CreateObstacles();
 		 CreateWalls();
+
+		 IndexObstacles();
 }
 
 //------------------------------- dtor -----------------------------------
@@ -93,9 +144,14 @@ GameWorld::GameWorld(int cx, int cy)
 
 GameWorld::~GameWorld()
 {
-	for (unsigned int a = 0; a < m_vehicles.size(); ++a)
+	// Destroys the vehicles, their steering behaviors, paths and smoothers
+	if (m_bOwnsArena)
+	{
+		delete m_pArena;
+	}
+	else
 	{
-		delete m_vehicles[a];
+		m_pArena->Rewind();
 	}
 
 	for (unsigned int ob = 0; ob < m_obstacles.size(); ++ob)
@@ -105,6 +161,10 @@ GameWorld::~GameWorld()
 
 	delete m_pCellSpace;
 
+	delete m_pObstacleSpace;
+
+	delete m_pThreadPool;
+
 	delete m_pPath;
 }
 
@@ -121,11 +181,137 @@ void GameWorld::Update(double timeElapsed)
 
 	m_dAvFrameTime = frameRateSmoother.Update(timeElapsed);
 
-	// Update the vehicles
+	if (m_dFixedTimeStep <= 0.0)
+	{
+		Step(timeElapsed);
+
+		return;
+	}
+
+	// Catch up with the clock a whole step at a time. After a long stall the
+	// time left over is dropped rather than simulated in one burst
+	m_dTimeAccumulator += timeElapsed;
+
+	for (int numSteps = 0; m_dTimeAccumulator >= m_dFixedTimeStep; ++numSteps)
+	{
+		if (numSteps == MaxStepsPerUpdate)
+		{
+			m_dTimeAccumulator = 0.0;
+
+			break;
+		}
+
+		Step(m_dFixedTimeStep);
+
+		m_dTimeAccumulator -= m_dFixedTimeStep;
+	}
+}
+
+//------------------------------- Step -----------------------------------
+//------------------------------------------------------------------------
+
+void GameWorld::Step(double timeElapsed)
+{
+	// Take the snapshot the steering calculations read from
+	m_agentState.Resize(m_vehicles.size());
+
+	m_pThreadPool->ParallelFor(m_vehicles.size(), VehiclesPerTask, [&](size_t begin, size_t end)
+	{
+		PROFILE_SCOPE("Snapshot");
+
+		for (size_t a = begin; a < end; ++a)
+		{
+			m_agentState.Store(a, m_vehicles[a]);
+		}
+	});
+
+	// Bring the cell space up to date once for the whole frame. The vehicles
+	// are added in the same order as m_vehicles, so the indices of the
+	// neighbors it finds are also indices into the agent store
+	if (IsSpacePartitioningOn())
+	{
+		PROFILE_SCOPE("CellSpaceUpdate");
+
+		m_pCellSpace->Update();
+	}
+
+	// Phase one: every vehicle works out its steering force while the world
+	// is left untouched, a bucket of like vehicles at a time. No behavior
+	// writes state another vehicle reads, so every bucket can be split
+	// between threads without changing the result
+	if (m_bBucketsDirty)
+	{
+		RebuildBuckets();
+	}
+
+	for (unsigned int b = 0; b < m_buckets.size(); ++b)
+	{
+		Vehicle* const* vehicles = m_buckets[b].m_vehicles.data();
+
+		m_pThreadPool->ParallelFor(m_buckets[b].m_vehicles.size(), VehiclesPerTask, [&](size_t begin, size_t end)
+		{
+			PROFILE_SCOPE("Steering");
+
+			SteeringBehavior::CalculateBatch(vehicles + begin, end - begin, timeElapsed);
+		});
+	}
+
+	// Phase two: move the vehicles. Each one only writes its own state
+	m_pThreadPool->ParallelFor(m_vehicles.size(), VehiclesPerTask, [&](size_t begin, size_t end)
+	{
+		PROFILE_SCOPE("Integrate");
+
+		Vehicle::IntegrateBatch(m_vehicles.data() + begin, end - begin);
+	});
+
+	++m_iFrame;
+
+	PROFILE_FRAME();
+}
+
+//------------------------------- RebuildBuckets  ----------------------------------
+//----------------------------------------------------------------------------------
+
+void GameWorld::RebuildBuckets()
+{
+	m_buckets.clear();
+
 	for (unsigned int a = 0; a < m_vehicles.size(); ++a)
 	{
-		m_vehicles[a]->Update(timeElapsed);
+		const SteeringBehavior* steering = m_vehicles[a]->Steering();
+
+		// There are only ever a handful of buckets
+		unsigned int b = 0;
+
+		while (b < m_buckets.size() &&
+			(m_buckets[b].m_iFlags != steering->Flags() || m_buckets[b].m_summingMethod != steering->GetSummingMethod()))
+		{
+			++b;
+		}
+
+		if (b == m_buckets.size())
+		{
+			SteeringBucket bucket;
+			bucket.m_iFlags = steering->Flags();
+			bucket.m_summingMethod = steering->GetSummingMethod();
+
+			m_buckets.push_back(bucket);
+		}
+
+		m_buckets[b].m_vehicles.push_back(m_vehicles[a]);
 	}
+
+	m_bBucketsDirty = false;
+}
+
+//------------------------------- SetNumThreads  -----------------------------------
+//----------------------------------------------------------------------------------
+
+void GameWorld::SetNumThreads(unsigned int numThreads)
+{
+	delete m_pThreadPool;
+
+	m_pThreadPool = new ThreadPool(numThreads);
 }
 
 //------------------------------- CreateWalls  -----------------------------------
@@ -161,6 +347,18 @@ void GameWorld::CreateWalls()
 	}
 
 	m_Walls.push_back(Wall2D(walls[numWallVerts - 1], walls[0]));
+
+	BuildWallGrid();
+}
+
+//------------------------------- BuildWallGrid  ---------------------------------
+// The cells are as big as a feeler is long, so no feeler spans more than
+// two cells in either direction
+//--------------------------------------------------------------------------------
+
+void GameWorld::BuildWallGrid()
+{
+	m_wallGrid.Build(m_Walls, m_cxClient, m_cyClient, Prm.WallDetectionFeelerLength());
 }
 
 //------------------------------- CreateObstacles  -----------------------------------
@@ -171,7 +369,7 @@ void GameWorld::CreateWalls()
 void GameWorld::CreateObstacles()
 {
 	// Create a number of randomly sized tiddylywinks
-	for (int o = 0; o < Prm.NumObstacles(); ++o)
+	for (int o = 0; o < m_iNumObstacles; ++o)
 	{
 		bool bOverlapped = true;
 
@@ -188,16 +386,15 @@ void GameWorld::CreateObstacles()
 
 			if (numTries > numAllowableTries) return;
 
-			int radius = RandInt((int)Prm.MinObstacleRadius(), (int)Prm.MaxObstacleRadius());
+			int radius = m_random.RandInt((int)Prm.MinObstacleRadius(), (int)Prm.MaxObstacleRadius());
 
 			const int border = 10;
 			const int minGapBetweenObstacles = 20;
 
-			Obstacle* ob = new Obstacle(
-				RandInt(radius + border, m_cxClient - radius - border),
-				RandInt(radius + border, m_cyClient - radius - 30 - border),
-				radius
-			);
+			const int x = m_random.RandInt(radius + border, m_cxClient - radius - border);
+			const int y = m_random.RandInt(radius + border, m_cyClient - radius - 30 - border);
+
+			Obstacle* ob = new Obstacle(x, y, radius);
 
 			if (!Overlapped(ob, m_obstacles, minGapBetweenObstacles))
 			{
@@ -214,142 +411,103 @@ void GameWorld::CreateObstacles()
 	}
 }
 
-//------------------------------- Set Crosshair -----------------------------------
-// The user can set the position of the crosshair by right clicking the mouse.
-// This method makes sure the click is not inside any enabled obstacles and sets
-// the position appropriately
+//------------------------------- IndexObstacles  --------------------------------
 //---------------------------------------------------------------------------------
 
-void GameWorld::SetCrosshair(POINTS p)
+void GameWorld::IndexObstacles()
 {
-	Vector2D proposedPosition((double)p.x, (double)p.y);
+	m_pObstacleSpace->EmptyCells();
 
-	// Make sure it's not inside an obstacle
-	for (ObIt curOb = m_obstacles.begin(); curOb != m_obstacles.end(); ++curOb)
+	m_dMaxObstacleRadius = 0.0;
+
+	for (unsigned int ob = 0; ob < m_obstacles.size(); ++ob)
 	{
-		if (PointInCircle((*curOb)->Pos(), (*curOb)->BRadius(), proposedPosition)) return;
+		m_pObstacleSpace->AddEntity(m_obstacles[ob]);
+
+		m_dMaxObstacleRadius = std::max(m_dMaxObstacleRadius, m_obstacles[ob]->BRadius());
 	}
 
-	m_vCrosshair.x = (double)p.x;
-	m_vCrosshair.y = (double)p.y;
+	m_pObstacleSpace->Rebuild();
 }
 
-//------------------------------- HandleKeyPresses -----------------------------------
-//------------------------------------------------------------------------------------
+//------------------------------- ObstaclesInRange  ------------------------------
+// The grid finds the obstacles whose centers are close enough for any
+// obstacle's circle to be in range. Each is then given the exact test
+// TagNeighbors makes
+//---------------------------------------------------------------------------------
 
-void GameWorld::HandleYKey()
+void GameWorld::ObstaclesInRange(const Vector2D& pos, double range, std::vector<int>& obstacles) const
 {
-	m_bShowObstacles = !m_bShowObstacles;
+	m_pObstacleSpace->CalculateNeighborIndices(pos, range + m_dMaxObstacleRadius, obstacles);
 
-	if (!m_bShowObstacles)
+	obstacles.erase(std::remove_if(obstacles.begin(), obstacles.end(), [&](int ob)
 	{
-		m_obstacles.clear();
+		const double obRange = range + m_obstacles[ob]->BRadius();
 
-		for (unsigned int i = 0; i < m_vehicles.size(); ++i)
-		{
-			m_vehicles[i]->Steering()->ObstacleAvoidanceOff();
-		}
-	}
-	else
-	{
-		CreateObstacles();
+		return (m_obstacles[ob]->Pos() - pos).LengthSq() >= obRange * obRange;
+	}), obstacles.end());
 
-		for (unsigned int i = 0; i < m_vehicles.size(); ++i)
-		{
-			m_vehicles[i]->Steering()->ObstacleAvoidanceOn();
-		}
-	}
+	std::sort(obstacles.begin(), obstacles.end());
 }
 
-void GameWorld::HandleUKey()
-{
-	if (m_pPath)
-	{
-		delete m_pPath;
-		double border = 60;
-
-		m_pPath = new Path(RandInt(3, 7), border, border, cxClient() - border, cyClient() - border, true);
-		m_bShowPath = true;
-
-		for (unsigned int i = 0; i < m_vehicles.size(); ++i)
-		{
-			m_vehicles[i]->Steering()->SetPath(m_pPath->GetPath());
-		}
-	}
-}
+//------------------------------- Set Crosshair -----------------------------------
+// The user can set the position of the crosshair by right clicking the mouse.
+// This method makes sure the click is not inside any enabled obstacles and sets
+// the position appropriately
+//---------------------------------------------------------------------------------
 
-void GameWorld::HandleIKey()
+void GameWorld::SetCrosshair(Vector2D proposedPosition)
 {
-	for (unsigned int i = 0; i < m_vehicles.size(); ++i)
-	{
-		m_vehicles[i]->ToggleSmoothing();
-	}
-}
+	RecordEvent(WorldEvent::ET_SetCrosshair, 0, proposedPosition);
 
-void GameWorld::HandleKeyPresses(WPARAM wParam)
-{
-	switch (wParam)
+	// Make sure it's not inside an obstacle
+	for (ObIt curOb = m_obstacles.begin(); curOb != m_obstacles.end(); ++curOb)
 	{
-		case 'U':
-			HandleUKey();
-			break;
-
-		case 'P':
-			TogglePause();
-			break;
-
-		case 'O':
-			ToggleRenderNeighbors();
-			break;
-
-		case 'I':
-			HandleIKey();
-			break;
-
-		case 'Y':
-			HandleYKey();
-			break;
-
-		default: 
-			break;
+		if (PointInCircle((*curOb)->Pos(), (*curOb)->BRadius(), proposedPosition)) return;
 	}
+
+	m_vCrosshair = proposedPosition;
 }
 
-//------------------------------- HandleMenuItems -----------------------------------
-//-----------------------------------------------------------------------------------
+//------------------------------- World toggles -----------------------------------
+// These are driven by the Win32 front end (keys and menu items) but carry no
+// dependency on it, so a headless driver can use them as well
+//---------------------------------------------------------------------------------
 
-void GameWorld::ToggleObstacles(HWND hwnd)
+void GameWorld::ToggleObstacles()
 {
+	RecordEvent(WorldEvent::ET_ToggleObstacles);
+
 	m_bShowObstacles = !m_bShowObstacles;
 
 	if (!m_bShowObstacles)
 	{
 		m_obstacles.clear();
 
+		IndexObstacles();
+
 		for (unsigned int i = 0; i < m_vehicles.size(); ++i)
 		{
 			m_vehicles[i]->Steering()->ObstacleAvoidanceOff();
 		}
-
-		// Uncheck the menu
-		ChangeMenuState(hwnd, ID_OB_OBSTACLES, MFS_UNCHECKED);
 	}
 	else
 	{
 		CreateObstacles();
 
+		IndexObstacles();
+
 		for (unsigned int i = 0; i < m_vehicles.size(); ++i)
 		{
 			m_vehicles[i]->Steering()->ObstacleAvoidanceOn();
 		}
-
-		// Check the menu
-		ChangeMenuState(hwnd, ID_OB_OBSTACLES, MFS_CHECKED);
 	}
 }
 
-void GameWorld::ToggleWalls(HWND hwnd)
+void GameWorld::ToggleWalls()
 {
+	RecordEvent(WorldEvent::ET_ToggleWalls);
+
 	m_bShowWalls = !m_bShowWalls;
 
 	if (m_bShowWalls)
@@ -360,46 +518,41 @@ void GameWorld::ToggleWalls(HWND hwnd)
 		{
 			m_vehicles[i]->Steering()->WallAvoidanceOn();
 		}
-
-		// Check the menu
-		ChangeMenuState(hwnd, ID_OB_WALLS, MFS_CHECKED);
 	}
 	else
 	{
 		m_Walls.clear();
 
+		BuildWallGrid();
+
 		for (unsigned int i = 0; i < m_vehicles.size(); ++i)
 		{
 			m_vehicles[i]->Steering()->WallAvoidanceOff();
 		}
-
-		// Uncheck the menu
-		ChangeMenuState(hwnd, ID_OB_WALLS, MFS_UNCHECKED);
 	}
 }
 
-void GameWorld::ToggleMenuSmoothing(HWND hwnd)
+void GameWorld::ToggleSmoothing()
 {
-	if (m_vehicles.size() > 0)
-	{
-		for (unsigned int i = 0; i < m_vehicles.size(); ++i)
-		{
-			m_vehicles[i]->ToggleSmoothing();
-		}
+	RecordEvent(WorldEvent::ET_ToggleSmoothing);
 
-		CheckMenuItemAppropriately(hwnd, ID_MENU_SMOOTHING, m_vehicles[0]->IsSmoothingOn());
+	for (unsigned int i = 0; i < m_vehicles.size(); ++i)
+	{
+		m_vehicles[i]->ToggleSmoothing();
 	}
 }
 
-void GameWorld::ToggleSpacePartitioning(HWND hwnd)
+void GameWorld::ToggleSpacePartitioning()
 {
+	RecordEvent(WorldEvent::ET_ToggleSpacePartitioning);
+
 	for (unsigned int i = 0; i < m_vehicles.size(); ++i)
 	{
 		m_vehicles[i]->Steering()->ToggleSpacePartitioningOnOff();
 	}
 
 	// If toggled on, empty the cell space and then re-add all the vehicles
-	if (m_vehicles[0]->Steering()->IsSpacePartitioningOn())
+	if (IsSpacePartitioningOn())
 	{
 		m_pCellSpace->EmptyCells();
 
@@ -407,121 +560,145 @@ void GameWorld::ToggleSpacePartitioning(HWND hwnd)
 		{
 			m_pCellSpace->AddEntity(m_vehicles[i]);
 		}
+
+		m_pCellSpace->Rebuild();
 	}
 	else
 	{
-		ChangeMenuState(hwnd, IDR_PARTITIONING, MFS_UNCHECKED);
-		ChangeMenuState(hwnd, IDM_PARTITION_VIEW_NEIGHBORS, MFS_UNCHECKED);
 		m_bShowCellSpaceInfo = false;
 	}
 }
 
-void GameWorld::ToggleCellSpacePartitioning(HWND hwnd)
+void GameWorld::SetSummingMethod(SteeringBehavior::SummingMethod sm)
 {
-	m_bShowCellSpaceInfo = !m_bShowCellSpaceInfo;
+	RecordEvent(WorldEvent::ET_SetSummingMethod, (int)sm);
 
-	if (m_bShowCellSpaceInfo)
+	for (unsigned int i = 0; i < m_vehicles.size(); ++i)
 	{
-		ChangeMenuState(hwnd, IDM_PARTITION_VIEW_NEIGHBORS, MFS_CHECKED);
+		m_vehicles[i]->Steering()->SetSummingMethod(sm);
+	}
+}
+
+void GameWorld::CreateRandomPath()
+{
+	RecordEvent(WorldEvent::ET_CreateRandomPath);
 
-		if (!m_vehicles[0]->Steering()->IsSpacePartitioningOn())
+	if (m_pPath)
+	{
+		delete m_pPath;
+		double border = 60;
+
+		m_pPath = new Path(m_random.RandInt(3, 7), border, border, cxClient() - border, cyClient() - border, true, m_random);
+		m_bShowPath = true;
+
+		for (unsigned int i = 0; i < m_vehicles.size(); ++i)
 		{
-			SendMessage(hwnd, WM_COMMAND, IDR_PARTITIONING, NULL);
+			m_vehicles[i]->Steering()->SetPath(m_pPath->GetPath());
 		}
 	}
-	else
-	{
-		ChangeMenuState(hwnd, IDM_PARTITION_VIEW_NEIGHBORS, MFS_UNCHECKED);
-	}
 }
 
-void GameWorld::ToggleSumming(HWND hwnd)
+//------------------------------- Recording --------------------------------
+//--------------------------------------------------------------------------
+
+void GameWorld::StartRecording(WorldRecording* pRecording)
 {
-	ChangeMenuState(hwnd, IDR_WEIGHTED_SUM, MFS_CHECKED);
-	ChangeMenuState(hwnd, IDR_PRIORITIZED, MFS_UNCHECKED);
-	ChangeMenuState(hwnd, IDR_DITHERED, MFS_UNCHECKED);
+	assert(m_iFrame == 0 && "<GameWorld::StartRecording>: the world has already been stepped");
+	assert(m_dFixedTimeStep > 0.0 && "<GameWorld::StartRecording>: not in fixed step mode");
 
-	for (unsigned int i = 0; i < m_vehicles.size(); ++i)
-	{
-		m_vehicles[i]->Steering()->SetSummingMethod(SteeringBehavior::WeightedAverage);
-	}
+	m_pRecording = pRecording;
+	m_pRecording->Begin(m_iSeed, m_dFixedTimeStep);
 }
 
-void GameWorld::TogglePrioritizeSummingMethod(HWND hwnd)
+void GameWorld::StopRecording()
 {
-	ChangeMenuState(hwnd, IDR_WEIGHTED_SUM, MFS_UNCHECKED);
-	ChangeMenuState(hwnd, IDR_PRIORITIZED, MFS_CHECKED);
-	ChangeMenuState(hwnd, IDR_DITHERED, MFS_UNCHECKED);
+	if (!m_pRecording) return;
 
-	for (unsigned int i = 0; i < m_vehicles.size(); ++i)
-	{
-		m_vehicles[i]->Steering()->SetSummingMethod(SteeringBehavior::Prioritized);
-	}
+	m_pRecording->SetNumFrames(m_iFrame);
+	m_pRecording = nullptr;
 }
 
-void GameWorld::ToggleDithered(HWND hwnd)
+void GameWorld::RecordEvent(WorldEvent::EventType type, int value, Vector2D pos)
 {
-	ChangeMenuState(hwnd, IDR_WEIGHTED_SUM, MFS_UNCHECKED);
-	ChangeMenuState(hwnd, IDR_PRIORITIZED, MFS_UNCHECKED);
-	ChangeMenuState(hwnd, IDR_DITHERED, MFS_CHECKED);
+	if (!m_pRecording) return;
 
-	for (unsigned int i = 0; i < m_vehicles.size(); ++i)
-	{
-		m_vehicles[i]->Steering()->SetSummingMethod(SteeringBehavior::Dithered);
-	}
+	WorldEvent event;
+	event.m_iFrame = m_iFrame;
+	event.m_type = type;
+	event.m_iValue = value;
+	event.m_vPos = pos;
+
+	m_pRecording->AddEvent(event);
 }
 
-void GameWorld::HandleMenuItems(WPARAM wParam, HWND hwnd)
+//------------------------------- ApplyEvent -------------------------------
+//--------------------------------------------------------------------------
+
+void GameWorld::ApplyEvent(const WorldEvent& event)
 {
-	switch (wParam)
+	switch (event.m_type)
 	{
-		case ID_OB_OBSTACLES:
-			ToggleObstacles(hwnd);
-			break;
+	case WorldEvent::ET_SetCrosshair:
+		SetCrosshair(event.m_vPos);
+		break;
 
-		case ID_OB_WALLS:
-			ToggleWalls(hwnd);
-			break;
+	case WorldEvent::ET_ToggleObstacles:
+		ToggleObstacles();
+		break;
 
-		case IDR_PARTITIONING:
-			ToggleSpacePartitioning(hwnd);
-			break;
+	case WorldEvent::ET_ToggleWalls:
+		ToggleWalls();
+		break;
 
-		case IDM_PARTITION_VIEW_NEIGHBORS:
-			ToggleCellSpacePartitioning(hwnd);
-			break;
+	case WorldEvent::ET_ToggleSmoothing:
+		ToggleSmoothing();
+		break;
 
-		case IDR_WEIGHTED_SUM:
-			ToggleSumming(hwnd);
-			break;
+	case WorldEvent::ET_ToggleSpacePartitioning:
+		ToggleSpacePartitioning();
+		break;
 
-		case IDR_PRIORITIZED:
-			TogglePrioritizeSummingMethod(hwnd);
-			break;
+	case WorldEvent::ET_SetSummingMethod:
+		SetSummingMethod((SteeringBehavior::SummingMethod)event.m_iValue);
+		break;
 
-		case IDR_DITHERED:
+	case WorldEvent::ET_CreateRandomPath:
+		CreateRandomPath();
+		break;
+	}
+}
 
-			break;
+//------------------------------- Replay -----------------------------------
+// Feeds each recorded input in before the step it originally preceded
+//--------------------------------------------------------------------------
 
-		case ID_VIEW_KEYS:
-			ToggleViewKeys();
-			CheckMenuItemAppropriately(hwnd, ID_VIEW_FPS, RenderFPS());
-			break;
+void GameWorld::Replay(const WorldRecording& recording)
+{
+	assert(m_iFrame == 0 && "<GameWorld::Replay>: the world has already been stepped");
+	assert(recording.Seed() == m_iSeed && "<GameWorld::Replay>: the world was created with a different seed");
 
-		case ID_VIEW_FPS:
-			ToogleShowFPS();
-			CheckMenuItemAppropriately(hwnd, ID_VIEW_FPS, RenderFPS());
-			break;
+	const std::vector<WorldEvent>& events = recording.Events();
+	unsigned int next = 0;
 
-		case ID_MENU_SMOOTHING:
-			ToggleMenuSmoothing(hwnd);
-			break;
+	for (int frame = 0; frame < recording.NumFrames(); ++frame)
+	{
+		while (next < events.size() && events[next].m_iFrame <= m_iFrame)
+		{
+			ApplyEvent(events[next++]);
+		}
 
-		default:
-			break;
+		Step(recording.TimeStep());
+	}
+
+	// Anything that arrived after the last step
+	while (next < events.size())
+	{
+		ApplyEvent(events[next++]);
 	}
 }
 
+#ifndef HEADLESS
+
 //------------------------------- Render -----------------------------------
 //--------------------------------------------------------------------------
 
@@ -546,6 +723,13 @@ void GameWorld::Render()
 		gdi->Circle(m_obstacles[ob]->Pos(), m_obstacles[ob]->BRadius());
 	}
 
+	// Steering no longer tags the neighbors it finds, so tag those of the
+	// first agent here for the vehicles to show
+	if (m_bRenderNeighbors && !m_vehicles.empty())
+	{
+		TagVehiclesWithinViewRange(m_vehicles[0], Prm.ViewDistance());
+	}
+
 	// Render the agents
 	for (unsigned int a = 0; a < m_vehicles.size(); ++a)
 	{
@@ -564,10 +748,11 @@ void GameWorld::Render()
 
 			gdi->RedPen();
 
-			CellSpace()->CalculateNeighbors(m_vehicles[a]->Pos(), Prm.ViewDistance());
-			for (BaseGameEntity* pV = CellSpace()->Begin(); !CellSpace()->End(); pV = CellSpace()->Next())
+			std::vector<Vehicle*> neighbors;
+			CellSpace()->CalculateNeighbors(m_vehicles[a]->Pos(), Prm.ViewDistance(), neighbors);
+			for (unsigned int n = 0; n < neighbors.size(); ++n)
 			{
-				gdi->Circle(pV->Pos(), pV->BRadius());
+				gdi->Circle(neighbors[n]->Pos(), neighbors[n]->BRadius());
 			}
 
 			gdi->GreenPen();
@@ -602,4 +787,6 @@ void GameWorld::Render()
 
 	if (m_bShowCellSpaceInfo) 
 		m_pCellSpace->RenderCells();
-}
\ No newline at end of file
+}
+
+#endif
@@ -1,24 +1,30 @@
 #include "Public/Path.h"
 #include "Public/2D/Transformations.h"
 #include "Public/Misc/Utils.h"
+#include "Public/Misc/RandomStream.h"
+
+#include <algorithm>
+
+#ifndef HEADLESS
 #include "Public/Misc/Cgdi.h"
+#endif
 
 //------------------------------- CreateRandomPath -----------------------
 //------------------------------------------------------------------------
 
-void Path::CreateRandomPath(int numWaypoints, double minX, double minY, double maxX, double maxY)
+void Path::CreateRandomPath(int numWaypoints, double minX, double minY, double maxX, double maxY, RandomStream& random)
 {
 	m_wayPoints.clear();
 
 	double midX = (maxX + minX) / 2.0;
 	double midY = (maxY + minY) / 2.0;
 
-	double smaller = min(midX, midY);
+	double smaller = (std::min)(midX, midY);
 	double spacing = TwoPi / (double)numWaypoints;
 
 	for (int i = 0; i < numWaypoints; ++i)
 	{
-		double radialDist = RandInRange(smaller * 0.2f, smaller);
+		double radialDist = random.RandInRange(smaller * 0.2f, smaller);
 
 		Vector2D temp(radialDist, 0.0f);
 
@@ -49,6 +55,8 @@ void Path::SetNextWaypoint()
 	}
 }
 
+#ifndef HEADLESS
+
 //------------------------------- Render -----------------------
 //--------------------------------------------------------------
 
@@ -72,3 +80,5 @@ void Path::Render() const
 		gdi->Line(*(--it), *m_wayPoints.begin());
 	}
 }
+
+#endif
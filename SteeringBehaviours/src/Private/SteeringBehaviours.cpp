@@ -1,22 +1,40 @@
 #include "Public/SteeringBehaviors.h"
 #include "Public/Vehicle.h"
 #include "Public/GameWorld.h"
+#include "Public/FlockingKernels.h"
 
 #include "Public/2D/Wall2D.h"
+#include "Public/2D/WallGrid.h"
 #include "Public/2D/Transformations.h"
 #include "Public/2D/Geometry.h"
 #include "Public/Misc/Utils.h"
-#include "Public/Misc/Cgdi.h"
+#include "Public/Misc/RandomStream.h"
 #include "Public/Misc/CellSpacePartition.h"
 #include "Public/Misc/StreamUtils.h"
+#include "Public/Misc/Profiler.h"
 #include "Public/Entities/BaseGameEntity.h"
 #include "Public/Entities/EntityTemplates.h"
 
+#ifndef HEADLESS
+#include "Public/Misc/Cgdi.h"
+#endif
+
 #include <cassert>
+#include <algorithm>
 
 using std::string;
 using std::vector;
 
+//--------------------------- Query scratch space ---------------------
+// The indices found by neighbor, obstacle and wall queries. Each is filled
+// and read within a single behavior, so the vehicles stepped on one thread
+// can share them rather than each keeping its own
+//---------------------------------------------------------------------
+
+static thread_local std::vector<int> t_neighbors;
+static thread_local std::vector<int> t_nearObstacles;
+static thread_local std::vector<int> t_wallCandidates;
+
 //--------------------------- ctor ------------------------------------
 //---------------------------------------------------------------------
 
@@ -32,7 +50,6 @@ SteeringBehavior::SteeringBehavior(Vehicle* agent)
 	m_dWeightWallAvoidance(Prm.WallAvoidanceWeight()),
 	m_dViewDistance(Prm.ViewDistance()),
 	m_dWallDetectionFeelerLength(Prm.WallDetectionFeelerLength()),
-	m_feelers(3),
 	m_Deceleration(normal),
 	m_pTargetAgent1(nullptr),
 	m_pTargetAgent2(nullptr),
@@ -53,22 +70,22 @@ SteeringBehavior::SteeringBehavior(Vehicle* agent)
 	m_SummingMethod(Prioritized)
 {
 	// stuff for the wander behavior
-	double theta = RandFloat() * TwoPi;
+	double theta = m_pVehicle->World()->Random().RandFloat() * TwoPi;
 
 	// Create a vector to a target position on the wander circle
 	m_vWanderTarget = Vector2D(m_dWanderRadius * cos(theta), m_dWanderRadius * sin(theta));
 
-	// Create a path
-	m_pPath = new Path();
+	// Create a path. It lives in the world's arena next to its vehicle
+	m_pPath = m_pVehicle->World()->AgentArena().New<Path>();
 	m_pPath->LoopOn();
 }
 
 //--------------------------- dtor ------------------------------------
+// The path is destroyed by the arena it was created in
 //---------------------------------------------------------------------
 
 SteeringBehavior::~SteeringBehavior()
 {
-	delete m_pPath;
 }
 
 //--------------------------- Calculate ------------------------------------
@@ -77,43 +94,167 @@ SteeringBehavior::~SteeringBehavior()
 //--------------------------------------------------------------------------
 
 Vector2D SteeringBehavior::Calculate()
+{
+	// Use a pipeline compiled for this exact set of behaviors if there is one
+	switch (m_iFlags)
+	{
+	case PM_Flock:
+		return CalculateFor<PM_Flock>();
+
+	case PM_Shoal:
+		return CalculateFor<PM_Shoal>();
+
+	case PM_Shark:
+		return CalculateFor<PM_Shark>();
+
+	default:
+		return CalculateFor<PM_Any>();
+	}
+}
+
+//--------------------------- CalculateBatch -------------------------------
+// The same as Calculate for a run of vehicles that share their behaviors
+//--------------------------------------------------------------------------
+
+void SteeringBehavior::CalculateBatch(Vehicle* const* vehicles, size_t count, double timeElapsed)
+{
+	if (count == 0) return;
+
+	switch (vehicles[0]->Steering()->m_iFlags)
+	{
+	case PM_Flock:
+		CalculateBatch<PM_Flock>(vehicles, count, timeElapsed);
+		break;
+
+	case PM_Shoal:
+		CalculateBatch<PM_Shoal>(vehicles, count, timeElapsed);
+		break;
+
+	case PM_Shark:
+		CalculateBatch<PM_Shark>(vehicles, count, timeElapsed);
+		break;
+
+	default:
+		CalculateBatch<PM_Any>(vehicles, count, timeElapsed);
+	}
+}
+
+template <int Mask>
+void SteeringBehavior::CalculateBatch(Vehicle* const* vehicles, size_t count, double timeElapsed)
+{
+	for (size_t i = 0; i < count; ++i)
+	{
+		assert(vehicles[i]->Steering()->m_iFlags == vehicles[0]->Steering()->m_iFlags && "<SteeringBehavior::CalculateBatch>: mixed behaviors");
+
+		vehicles[i]->SetTimeElapsed(timeElapsed);
+		vehicles[i]->Steering()->CalculateFor<Mask>();
+	}
+}
+
+//--------------------------- CalculateFor ---------------------------------
+//--------------------------------------------------------------------------
+
+template <int Mask>
+Vector2D SteeringBehavior::CalculateFor()
 {
 	// Reset the steering force
 	m_vSteeringForce.Zero();
 
-	// Use space partitioning to calculate the neighbours of this vehicle
-	// if switched on. If not, use the standard tagging system
-	if (On(BT_Separation) || On(BT_Alignment) || On(BT_Cohesion))
+	m_random.Seed(RandomKey(m_pVehicle->World()->Seed(), m_pVehicle->Index(), m_pVehicle->World()->Frame()));
+
+	GatherFlocking();
+
+	m_vSteeringForce = CalculatePipeline<Mask>();
+
+	return m_vSteeringForce;
+}
+
+//--------------------------- GatherFlocking -------------------------------
+// Gathers what all three flocking behaviors need in one pass. Uses space
+// partitioning to find the neighbours of this vehicle if switched on. If
+// not, tests every agent in the world on the way through
+//--------------------------------------------------------------------------
+
+void SteeringBehavior::GatherFlocking()
+{
+	if (!On(BT_Separation) && !On(BT_Alignment) && !On(BT_Cohesion)) return;
+
+	PROFILE_SCOPE("Flocking");
+
+	m_flockingSums = FlockingSums();
+
+	if (!IsSpacePartitioningOn())
+	{
+		// Don't flock with the evade target
+		const int exclude = m_pTargetAgent1 ? m_pTargetAgent1->Index() : -1;
+
+		AccumulateFlockingInRange(m_pVehicle->World()->AgentState(), m_pVehicle->Index(), exclude, m_dViewDistance, m_flockingSums);
+
+		// The same counters the cell space query keeps, with every agent as a candidate
+		PROFILE_COUNT("QueryCalls", 1);
+		PROFILE_COUNT("QueryCandidates", m_pVehicle->World()->AgentState().Size());
+		PROFILE_COUNT("QueryNeighbors", m_flockingSums.m_iCount);
+	}
+	else
 	{
-		if (!IsSpacePartitioningOn())
-		{
-			m_pVehicle->World()->TagVehiclesWithinViewRange(m_pVehicle, m_dViewDistance);
-		}
-		else
 		{
-			m_pVehicle->World()->CellSpace()->CalculateNeighbors(m_pVehicle->Pos(), m_dViewDistance);
+			PROFILE_SCOPE("NeighborQuery");
+
+			m_pVehicle->World()->CellSpace()->CalculateNeighborIndices(m_pVehicle->Pos(), m_dViewDistance, t_neighbors);
 		}
+
+		// The query finds this vehicle too
+		t_neighbors.erase(std::remove(t_neighbors.begin(), t_neighbors.end(), m_pVehicle->Index()), t_neighbors.end());
+
+		AccumulateFlocking(m_pVehicle->World()->AgentState(), t_neighbors.data(), t_neighbors.size(), m_pVehicle->Pos(), m_flockingSums);
 	}
+}
 
+//--------------------------- CalculatePipeline -----------------------------------
+// Sums the behaviors in Mask according to the method set in m_summingMethod
+//---------------------------------------------------------------------------------
+
+template <int Mask>
+Vector2D SteeringBehavior::CalculatePipeline()
+{
 	switch (m_SummingMethod)
 	{
 	case WeightedAverage:
-		m_vSteeringForce = CalculateWeightedSum();
-		break;
+		return CalculateWeightedSum<Mask>();
 
 	case Prioritized:
-		m_vSteeringForce = CalculatePrioritized();
-		break;
+		return CalculatePrioritized<Mask>();
 
 	case Dithered:
-		m_vSteeringForce = CalculateDithered();
-		break;
+		return CalculateDithered<Mask>();
 
 	default:
-		m_vSteeringForce = Vector2D(0, 0);
+		return Vector2D(0, 0);
 	}
+}
 
-	return m_vSteeringForce;
+//--------------------------- SetFlags -------------------------------------------
+//---------------------------------------------------------------------------------
+
+void SteeringBehavior::SetFlags(int flags)
+{
+	if (flags == m_iFlags) return;
+
+	m_iFlags = flags;
+
+	m_pVehicle->World()->BehaviorsChanged();
+}
+
+//--------------------------- SetSummingMethod -----------------------------------
+//---------------------------------------------------------------------------------
+
+void SteeringBehavior::SetSummingMethod(SummingMethod sm)
+{
+	if (sm == m_SummingMethod) return;
+
+	m_SummingMethod = sm;
+
+	m_pVehicle->World()->BehaviorsChanged();
 }
 
 //--------------------------- ForwardComponent ------------------------------------
@@ -194,19 +335,20 @@ void SteeringBehavior::CreateFeelers()
 // the result to the max available steering force before returning
 //---------------------------------------------------------------------------------
 
+template <int Mask>
 Vector2D SteeringBehavior::CalculateWeightedSum()
 {
-	if (On(BT_WallAvoidance))
+	if (Active<Mask>(BT_WallAvoidance))
 	{
-		m_vSteeringForce += WallAvoidance(m_pVehicle->World()->Walls()) * m_dWeightWallAvoidance;
+		m_vSteeringForce += WallAvoidance(m_pVehicle->World()->Walls(), m_pVehicle->World()->WallIndex()) * m_dWeightWallAvoidance;
 	}
 
-	if (On(BT_ObstacleAvoidance))
+	if (Active<Mask>(BT_ObstacleAvoidance))
 	{
 		m_vSteeringForce += ObstacleAvoidance(m_pVehicle->World()->Obstacles()) * m_dWeightObstacleAvoidance;
 	}
 
-	if (On(BT_Evade))
+	if (Active<Mask>(BT_Evade))
 	{
 		assert(m_pTargetAgent1 && "Evade target not assigned");
 
@@ -215,69 +357,49 @@ Vector2D SteeringBehavior::CalculateWeightedSum()
 
 	// These next three can be combined for flocking behavior (wander is
 	// also a good behavior to add into this mix
-	if (!IsSpacePartitioningOn())
+	if (Active<Mask>(BT_Separation))
 	{
-		if (On(BT_Separation))
-		{
-			m_vSteeringForce += Separation(m_pVehicle->World()->Agents()) * m_dWeightSeparation;
-		}
-
-		if (On(BT_Alignment))
-		{
-			m_vSteeringForce += Alignment(m_pVehicle->World()->Agents()) * m_dWeightAlignment;
-		}
-
-		if (On(BT_Cohesion))
-		{
-			m_vSteeringForce += Cohesion(m_pVehicle->World()->Agents()) * m_dWeightCohesion;
-		}
+		m_vSteeringForce += SeparationPlus(m_flockingSums) * m_dWeightSeparation;
 	}
-	else
-	{
-		if (On(BT_Separation))
-		{
-			m_vSteeringForce += SeparationPlus(m_pVehicle->World()->Agents()) * m_dWeightSeparation;
-		}
 
-		if (On(BT_Alignment))
-		{
-			m_vSteeringForce += AlignmentPlus(m_pVehicle->World()->Agents()) * m_dWeightAlignment;
-		}
+	if (Active<Mask>(BT_Alignment))
+	{
+		m_vSteeringForce += AlignmentPlus(m_flockingSums) * m_dWeightAlignment;
+	}
 
-		if (On(BT_Cohesion))
-		{
-			m_vSteeringForce += CohesionPlus(m_pVehicle->World()->Agents()) * m_dWeightCohesion;
-		}
+	if (Active<Mask>(BT_Cohesion))
+	{
+		m_vSteeringForce += CohesionPlus(m_flockingSums) * m_dWeightCohesion;
 	}
 
-	if (On(BT_Wander))
+	if (Active<Mask>(BT_Wander))
 	{
 		m_vSteeringForce += Wander() * m_dWeightWander;
 	}
 
-	if (On(BT_Seek))
+	if (Active<Mask>(BT_Seek))
 	{
 		m_vSteeringForce += Seek(m_pVehicle->World()->Crosshair()) * m_dWeightSeek;
 	}
 
-	if (On(BT_Arrive))
+	if (Active<Mask>(BT_Arrive))
 	{
 		m_vSteeringForce += Arrive(m_pVehicle->World()->Crosshair(), m_Deceleration) * m_dWeightArrive;
 	}
 
-	if (On(BT_Flee))
+	if (Active<Mask>(BT_Flee))
 	{
 		m_vSteeringForce += Flee(m_pVehicle->World()->Crosshair()) * m_dWeightFlee;
 	}
 
-	if (On(BT_Pursuit))
+	if (Active<Mask>(BT_Pursuit))
 	{
 		assert(m_pTargetAgent1 && "Pursuit target not assigned");
 
 		m_vSteeringForce += Pursuit(m_pTargetAgent1) * m_dWeightPursuit;
 	}
 
-	if (On(BT_OffsetPursuit))
+	if (Active<Mask>(BT_OffsetPursuit))
 	{
 		assert(m_pTargetAgent1 && "Pursuit target not assigned");
 		assert(!m_vOffset.IsZero() && "No offset assigned");
@@ -285,21 +407,21 @@ Vector2D SteeringBehavior::CalculateWeightedSum()
 		m_vSteeringForce += OffsetPursuit(m_pTargetAgent1, m_vOffset) * m_dWeightOffsetPursuit;
 	}
 
-	if (On(BT_Interpose))
+	if (Active<Mask>(BT_Interpose))
 	{
 		assert(m_pTargetAgent1 && m_pTargetAgent2 && "Interpose agents not assigned");
 
 		m_vSteeringForce += Interpose(m_pTargetAgent1, m_pTargetAgent2) * m_dWeightInterpose;
 	}
 
-	if (On(BT_Hide))
+	if (Active<Mask>(BT_Hide))
 	{
 		assert(m_pTargetAgent1 && "Hide target not assigned");
 
 		m_vSteeringForce += Hide(m_pTargetAgent1, m_pVehicle->World()->Obstacles()) * m_dWeightHide;
 	}
 
-	if (On(BT_FollowPath))
+	if (Active<Mask>(BT_FollowPath))
 	{
 		m_vSteeringForce += FollowPath() * m_dWeightFollowPath;
 	}
@@ -315,25 +437,26 @@ Vector2D SteeringBehavior::CalculateWeightedSum()
 // at which time the function returns the steering force accumulated to that point
 //---------------------------------------------------------------------------------
 
+template <int Mask>
 Vector2D SteeringBehavior::CalculatePrioritized()
 {
 	Vector2D force;
 
-	if (On(BT_WallAvoidance))
+	if (Active<Mask>(BT_WallAvoidance))
 	{
-		force = WallAvoidance(m_pVehicle->World()->Walls()) * m_dWeightWallAvoidance;
+		force = WallAvoidance(m_pVehicle->World()->Walls(), m_pVehicle->World()->WallIndex()) * m_dWeightWallAvoidance;
 
 		if (!AccumulateForce(m_vSteeringForce, force)) return m_vSteeringForce;
 	}
 
-	if (On(BT_ObstacleAvoidance))
+	if (Active<Mask>(BT_ObstacleAvoidance))
 	{
 		force = ObstacleAvoidance(m_pVehicle->World()->Obstacles()) * m_dWeightObstacleAvoidance;
 
 		if (!AccumulateForce(m_vSteeringForce, force)) return m_vSteeringForce;
 	}
 
-	if (On(BT_Evade))
+	if (Active<Mask>(BT_Evade))
 	{
 		assert(m_pTargetAgent1 && "Evade target not assigned");
 
@@ -342,7 +465,7 @@ Vector2D SteeringBehavior::CalculatePrioritized()
 		if (!AccumulateForce(m_vSteeringForce, force)) return m_vSteeringForce;
 	}
 
-	if (On(BT_Flee))
+	if (Active<Mask>(BT_Flee))
 	{
 		force = Flee(m_pVehicle->World()->Crosshair()) * m_dWeightFlee;
 
@@ -350,75 +473,49 @@ Vector2D SteeringBehavior::CalculatePrioritized()
 	}
 
 	// These next three can be combined for flocking behavior (wander is also a good behavior to add into this mix)
-	if (!IsSpacePartitioningOn())
+	if (Active<Mask>(BT_Separation))
 	{
-		if (On(BT_Separation))
-		{
-			force = Separation(m_pVehicle->World()->Agents()) * m_dWeightSeparation;
-
-			if (!AccumulateForce(m_vSteeringForce, force)) return m_vSteeringForce;
-		}
+		force = SeparationPlus(m_flockingSums) * m_dWeightSeparation;
 
-		if (On(BT_Alignment))
-		{
-			force = Alignment(m_pVehicle->World()->Agents()) * m_dWeightAlignment;
-
-			if (!AccumulateForce(m_vSteeringForce, force)) return m_vSteeringForce;
-		}
-
-		if (On(BT_Cohesion))
-		{
-			force = Cohesion(m_pVehicle->World()->Agents()) * m_dWeightCohesion;
-
-			if (!AccumulateForce(m_vSteeringForce, force)) return m_vSteeringForce;
-		}
+		if (!AccumulateForce(m_vSteeringForce, force)) return m_vSteeringForce;
 	}
-	else
-	{
-		if (On(BT_Separation))
-		{
-			force = SeparationPlus(m_pVehicle->World()->Agents()) * m_dWeightSeparation;
 
-			if (!AccumulateForce(m_vSteeringForce, force)) return m_vSteeringForce;
-		}
-
-		if (On(BT_Alignment))
-		{
-			force = AlignmentPlus(m_pVehicle->World()->Agents()) * m_dWeightAlignment;
+	if (Active<Mask>(BT_Alignment))
+	{
+		force = AlignmentPlus(m_flockingSums) * m_dWeightAlignment;
 
-			if (!AccumulateForce(m_vSteeringForce, force)) return m_vSteeringForce;
-		}
+		if (!AccumulateForce(m_vSteeringForce, force)) return m_vSteeringForce;
+	}
 
-		if (On(BT_Cohesion))
-		{
-			force = CohesionPlus(m_pVehicle->World()->Agents()) * m_dWeightCohesion;
+	if (Active<Mask>(BT_Cohesion))
+	{
+		force = CohesionPlus(m_flockingSums) * m_dWeightCohesion;
 
-			if (!AccumulateForce(m_vSteeringForce, force)) return m_vSteeringForce;
-		}
+		if (!AccumulateForce(m_vSteeringForce, force)) return m_vSteeringForce;
 	}
 
-	if (On(BT_Seek))
+	if (Active<Mask>(BT_Seek))
 	{
 		force = Seek(m_pVehicle->World()->Crosshair()) * m_dWeightSeek;
 
 		if (!AccumulateForce(m_vSteeringForce, force)) return m_vSteeringForce;
 	}
 
-	if (On(BT_Arrive))
+	if (Active<Mask>(BT_Arrive))
 	{
 		force = Arrive(m_pVehicle->World()->Crosshair(), m_Deceleration) * m_dWeightArrive;
 
 		if (!AccumulateForce(m_vSteeringForce, force)) return m_vSteeringForce;
 	}
 
-	if (On(BT_Wander))
+	if (Active<Mask>(BT_Wander))
 	{
 		force = Wander() * m_dWeightWander;
 
 		if (!AccumulateForce(m_vSteeringForce, force)) return m_vSteeringForce;
 	}
 
-	if (On(BT_Pursuit))
+	if (Active<Mask>(BT_Pursuit))
 	{
 		assert(m_pTargetAgent1 && "Pursuit target not assigned");
 
@@ -427,7 +524,7 @@ Vector2D SteeringBehavior::CalculatePrioritized()
 		if (!AccumulateForce(m_vSteeringForce, force)) return m_vSteeringForce;
 	}
 
-	if (On(BT_OffsetPursuit))
+	if (Active<Mask>(BT_OffsetPursuit))
 	{
 		assert(m_pTargetAgent1 && "Pursuit target not assigned");
 		assert(!m_vOffset.IsZero() && "No offset assigned");
@@ -437,7 +534,7 @@ Vector2D SteeringBehavior::CalculatePrioritized()
 		if (!AccumulateForce(m_vSteeringForce, force)) return m_vSteeringForce;
 	}
 
-	if (On(BT_Interpose))
+	if (Active<Mask>(BT_Interpose))
 	{
 		assert(m_pTargetAgent1 && m_pTargetAgent2 && "Interpose agents not assigned");
 
@@ -446,7 +543,7 @@ Vector2D SteeringBehavior::CalculatePrioritized()
 		if (!AccumulateForce(m_vSteeringForce, force)) return m_vSteeringForce;
 	}
 
-	if (On(BT_Hide))
+	if (Active<Mask>(BT_Hide))
 	{
 		assert(m_pTargetAgent1 && "Hide target not assigned");
 
@@ -455,7 +552,7 @@ Vector2D SteeringBehavior::CalculatePrioritized()
 		if (!AccumulateForce(m_vSteeringForce, force)) return m_vSteeringForce;
 	}
 
-	if (On(BT_FollowPath))
+	if (Active<Mask>(BT_FollowPath))
 	{
 		force = FollowPath() * m_dWeightFollowPath;
 
@@ -474,14 +571,15 @@ Vector2D SteeringBehavior::CalculatePrioritized()
 // so on.
 //---------------------------------------------------------------------------------
 
+template <int Mask>
 Vector2D SteeringBehavior::CalculateDithered()
 {
 	// Reset the steering force
 	m_vSteeringForce.Zero();
 
-	if (On(BT_WallAvoidance) && RandFloat() < Prm.PrWallAvoidance())
+	if (Active<Mask>(BT_WallAvoidance) && m_random.RandFloat() < Prm.PrWallAvoidance())
 	{
-		m_vSteeringForce = WallAvoidance(m_pVehicle->World()->Walls()) * (m_dWeightWallAvoidance / Prm.PrWallAvoidance());
+		m_vSteeringForce = WallAvoidance(m_pVehicle->World()->Walls(), m_pVehicle->World()->WallIndex()) * (m_dWeightWallAvoidance / Prm.PrWallAvoidance());
 
 		if (!m_vSteeringForce.IsZero())
 		{
@@ -491,7 +589,7 @@ Vector2D SteeringBehavior::CalculateDithered()
 		}
 	}
 
-	if (On(BT_ObstacleAvoidance) && RandFloat() < Prm.PrObstacleAvoidance())
+	if (Active<Mask>(BT_ObstacleAvoidance) && m_random.RandFloat() < Prm.PrObstacleAvoidance())
 	{
 		m_vSteeringForce = ObstacleAvoidance(m_pVehicle->World()->Obstacles()) * (m_dWeightObstacleAvoidance / Prm.PrObstacleAvoidance());
 
@@ -503,36 +601,19 @@ Vector2D SteeringBehavior::CalculateDithered()
 		}
 	}
 
-	if (!IsSpacePartitioningOn())
+	if (Active<Mask>(BT_Separation) && m_random.RandFloat() < Prm.PrSeparation())
 	{
-		if (On(BT_Separation) && RandFloat() < Prm.PrSeparation())
-		{
-			m_vSteeringForce += Separation(m_pVehicle->World()->Agents()) * m_dWeightSeparation / Prm.PrSeparation();
-
-			if (!m_vSteeringForce.IsZero())
-			{
-				m_vSteeringForce.Truncate(m_pVehicle->MaxForce());
+		m_vSteeringForce += SeparationPlus(m_flockingSums) * m_dWeightSeparation / Prm.PrSeparation();
 
-				return m_vSteeringForce;
-			}
-		}
-	}
-	else
-	{
-		if (On(BT_Separation) && RandFloat() < Prm.PrSeparation())
+		if (!m_vSteeringForce.IsZero())
 		{
-			m_vSteeringForce += SeparationPlus(m_pVehicle->World()->Agents()) * m_dWeightSeparation / Prm.PrSeparation();
-
-			if (!m_vSteeringForce.IsZero())
-			{
-				m_vSteeringForce.Truncate(m_pVehicle->MaxForce());
+			m_vSteeringForce.Truncate(m_pVehicle->MaxForce());
 
-				return m_vSteeringForce;
-			}
+			return m_vSteeringForce;
 		}
 	}
 
-	if (On(BT_Flee) && RandFloat() < Prm.PrFlee())
+	if (Active<Mask>(BT_Flee) && m_random.RandFloat() < Prm.PrFlee())
 	{
 		m_vSteeringForce += Flee(m_pVehicle->World()->Crosshair()) * m_dWeightFlee / Prm.PrFlee();
 
@@ -544,7 +625,7 @@ Vector2D SteeringBehavior::CalculateDithered()
 		}
 	}
 
-	if (On(BT_Evade) && RandFloat() < Prm.PrEvade())
+	if (Active<Mask>(BT_Evade) && m_random.RandFloat() < Prm.PrEvade())
 	{
 		assert(m_pTargetAgent1 && "Evade target not assigned");
 
@@ -558,60 +639,31 @@ Vector2D SteeringBehavior::CalculateDithered()
 		}
 	}
 
-	if (!IsSpacePartitioningOn())
+	if (Active<Mask>(BT_Alignment) && m_random.RandFloat() < Prm.PrAlignment())
 	{
-		if (On(BT_Alignment) && RandFloat() < Prm.PrAlignment())
-		{
-			m_vSteeringForce += Alignment(m_pVehicle->World()->Agents()) * m_dWeightAlignment / Prm.PrAlignment();
-
-			if (!m_vSteeringForce.IsZero())
-			{
-				m_vSteeringForce.Truncate(m_pVehicle->MaxForce());
-
-				return m_vSteeringForce;
-			}
-		}
+		m_vSteeringForce += AlignmentPlus(m_flockingSums) * m_dWeightAlignment / Prm.PrAlignment();
 
-		if (On(BT_Cohesion) && RandFloat() < Prm.PrCohesion())
+		if (!m_vSteeringForce.IsZero())
 		{
-			m_vSteeringForce += Cohesion(m_pVehicle->World()->Agents()) * m_dWeightCohesion / Prm.PrCohesion();
-
-			if (!m_vSteeringForce.IsZero())
-			{
-				m_vSteeringForce.Truncate(m_pVehicle->MaxForce());
+			m_vSteeringForce.Truncate(m_pVehicle->MaxForce());
 
-				return m_vSteeringForce;
-			}
+			return m_vSteeringForce;
 		}
 	}
-	else
-	{
-		if (On(BT_Alignment) && RandFloat() < Prm.PrAlignment())
-		{
-			m_vSteeringForce += AlignmentPlus(m_pVehicle->World()->Agents()) * m_dWeightAlignment / Prm.PrAlignment();
 
-			if (!m_vSteeringForce.IsZero())
-			{
-				m_vSteeringForce.Truncate(m_pVehicle->MaxForce());
-
-				return m_vSteeringForce;
-			}
-		}
+	if (Active<Mask>(BT_Cohesion) && m_random.RandFloat() < Prm.PrCohesion())
+	{
+		m_vSteeringForce += CohesionPlus(m_flockingSums) * m_dWeightCohesion / Prm.PrCohesion();
 
-		if (On(BT_Cohesion) && RandFloat() < Prm.PrCohesion())
+		if (!m_vSteeringForce.IsZero())
 		{
-			m_vSteeringForce += CohesionPlus(m_pVehicle->World()->Agents()) * m_dWeightCohesion / Prm.PrCohesion();
-
-			if (!m_vSteeringForce.IsZero())
-			{
-				m_vSteeringForce.Truncate(m_pVehicle->MaxForce());
+			m_vSteeringForce.Truncate(m_pVehicle->MaxForce());
 
-				return m_vSteeringForce;
-			}
+			return m_vSteeringForce;
 		}
 	}
 
-	if (On(BT_Wander) && RandFloat() < Prm.PrWander())
+	if (Active<Mask>(BT_Wander) && m_random.RandFloat() < Prm.PrWander())
 	{
 		m_vSteeringForce += Wander() * m_dWeightWander / Prm.PrWander();
 
@@ -623,7 +675,7 @@ Vector2D SteeringBehavior::CalculateDithered()
 		}
 	}
 
-	if (On(BT_Seek) && RandFloat() < Prm.PrSeek())
+	if (Active<Mask>(BT_Seek) && m_random.RandFloat() < Prm.PrSeek())
 	{
 		m_vSteeringForce += Seek(m_pVehicle->World()->Crosshair()) * m_dWeightSeek / Prm.PrSeek();
 
@@ -635,7 +687,7 @@ Vector2D SteeringBehavior::CalculateDithered()
 		}
 	}
 
-	if (On(BT_Arrive) && RandFloat() < Prm.PrArrive())
+	if (Active<Mask>(BT_Arrive) && m_random.RandFloat() < Prm.PrArrive())
 	{
 		m_vSteeringForce += Arrive(m_pVehicle->World()->Crosshair(), m_Deceleration) * m_dWeightArrive / Prm.PrArrive();
 
@@ -656,11 +708,12 @@ Vector2D SteeringBehavior::CalculateDithered()
 // and directly opposite the hunter
 //---------------------------------------------------------------------------------
 
+// How far away the agent is to be from the chosen obstacle's bounding radius
+static const double DistanceFromBoundary = 30.0;
+
 Vector2D SteeringBehavior::GetHidingPosition(const Vector2D& posObstacle, const double radiusObstacle, const Vector2D& posHunter)
 {
-	// Calculate how far away the agent is to be from the chosen obstacle's bounding radius
-	const double distanceFromBoundary = 30.0;
-	double distAway = radiusObstacle + distanceFromBoundary;
+	double distAway = radiusObstacle + DistanceFromBoundary;
 
 	// Calculate the heading toward the object from the hunter
 	Vector2D toOb = Vec2DNormalize(posObstacle - posHunter);
@@ -713,7 +766,7 @@ Vector2D SteeringBehavior::Arrive(const Vector2D& targetPos, const Deceleration&
 		double speed = dist / ((double)deceleration * decelerationTweaker);
 
 		// Make sure the velocity does not exceed the max
-		speed = min(speed, m_pVehicle->MaxSpeed());
+		speed = (std::min)(speed, m_pVehicle->MaxSpeed());
 
 		// From here proceed just like Seek except we don't need to normalize the
 		// toTarget vector because we have already gone to the trouble of calculating
@@ -803,12 +856,19 @@ Vector2D SteeringBehavior::Evade(const Vehicle* pursuer)
 
 Vector2D SteeringBehavior::Wander()
 {
+	PROFILE_SCOPE("Wander");
+
 	// This behavior is dependent on the update rate, so this line must be included
 	// when using time independent framerate
 	double jitterThisTimeSlice = m_dWanderJitter * m_pVehicle->TimeElapsed();
 
-	// First, add a small random vector to the target's position
-	m_vWanderTarget += Vector2D(RandomClamped() * jitterThisTimeSlice, RandomClamped() * jitterThisTimeSlice);
+	// First, add a small random vector to the target's position. Each
+	// component is the difference of two random numbers, as RandomClamped
+	// would give
+	double r[4];
+	m_random.RandFloats(r, 4);
+
+	m_vWanderTarget += Vector2D((r[0] - r[1]) * jitterThisTimeSlice, (r[2] - r[3]) * jitterThisTimeSlice);
 
 	// Reproject this new vector back on to a unit circle
 	m_vWanderTarget.Normalize();
@@ -833,12 +893,16 @@ Vector2D SteeringBehavior::Wander()
 
 Vector2D SteeringBehavior::ObstacleAvoidance(const std::vector<BaseGameEntity*>& obstacles)
 {
+	PROFILE_SCOPE("ObstacleAvoidance");
+
 	// The detection box length is proportional to the agent's velocity
 	m_dDBoxLength = Prm.MinDetectionBoxLength() +
 		(m_pVehicle->Speed() / m_pVehicle->MaxSpeed()) * Prm.MinDetectionBoxLength();
 
-	// Tag all obstacles within range of the box for processing
-	m_pVehicle->World()->TagObstaclesWithingViewRange(m_pVehicle, m_dDBoxLength);
+	// Find all obstacles within range of the box for processing
+	m_pVehicle->World()->ObstaclesInRange(m_pVehicle->Pos(), m_dDBoxLength, t_nearObstacles);
+
+	PROFILE_COUNT("ObstacleCandidates", t_nearObstacles.size());
 
 	// This will keep track of the closest intersecting obstacle (CIB)
 	BaseGameEntity* closestIntersectingObstacle = nullptr;
@@ -849,59 +913,53 @@ Vector2D SteeringBehavior::ObstacleAvoidance(const std::vector<BaseGameEntity*>&
 	// This will record the transformed local coordinates of the CIB
 	Vector2D localPosOfClosestObstacles;
 
-	std::vector<BaseGameEntity*>::const_iterator curOb = obstacles.begin();
-
-	while (curOb != obstacles.end())
+	for (unsigned int n = 0; n < t_nearObstacles.size(); ++n)
 	{
-		// If the obstacle has been tagged within range proceed
-		if ((*curOb)->IsTagged())
+		BaseGameEntity* ob = obstacles[t_nearObstacles[n]];
+
+		// Calculate this obstacle's position in local space
+		Vector2D localPos = PointToLocalSpace(ob->Pos(),
+			m_pVehicle->Heading(), m_pVehicle->Side(), m_pVehicle->Pos());
+
+		// If the local position has a negative x value then it must lay behind
+		// the agent. (in which case it can be ignored)
+		if (localPos.x >= 0)
 		{
-			// Calculate this obstacle's position in local space
-			Vector2D localPos = PointToLocalSpace((*curOb)->Pos(),
-				m_pVehicle->Heading(), m_pVehicle->Side(), m_pVehicle->Pos());
+			// If the distance from the x axis to the object's position is less than its radius + 
+			// half the width of the detection box, then there is a potential intersection
+			double expandedRadius = ob->BRadius() + m_pVehicle->BRadius();
 
-			// If the local position has a negative x value then it must lay behind
-			// the agent. (in which case it can be ignored)
-			if (localPos.x >= 0)
+			if (fabs(localPos.y) < expandedRadius)
 			{
-				// If the distance from the x axis to the object's position is less than its radius + 
-				// half the width of the detection box, then there is a potential intersection
-				double expandedRadius = (*curOb)->BRadius() + m_pVehicle->BRadius();
-
-				if (fabs(localPos.y) < expandedRadius)
-				{
-					// Now to do a line/circle intersection test. The center of the circle is represented by (cx, cy).
-					// The intersection points are given by the formula x = cX +/- sqrt(r^2 - cY^2) for y=0. We only
-					// need to look at the smallest positive value of x because that will be the closest point of
-					// intersection.
-					double cX = localPos.x;
-					double cY = localPos.y;
+				// Now to do a line/circle intersection test. The center of the circle is represented by (cx, cy).
+				// The intersection points are given by the formula x = cX +/- sqrt(r^2 - cY^2) for y=0. We only
+				// need to look at the smallest positive value of x because that will be the closest point of
+				// intersection.
+				double cX = localPos.x;
+				double cY = localPos.y;
 
-					// We only need to calculate the sqrt part of the above equation once
-					double sqrtPart = sqrt(expandedRadius * expandedRadius - cY * cY);
+				// We only need to calculate the sqrt part of the above equation once
+				double sqrtPart = sqrt(expandedRadius * expandedRadius - cY * cY);
 
-					double ip = cX - sqrtPart;
+				double ip = cX - sqrtPart;
 
-					if (ip <= 0.0)
-					{
-						ip = cX + sqrtPart;
-					}
+				if (ip <= 0.0)
+				{
+					ip = cX + sqrtPart;
+				}
 
-					// Test to see if this is the closest so far. If it is keep a record of the obstacle and its 
-					// local coordinates
-					if (ip < distToClosestIP)
-					{
-						distToClosestIP = ip;
+				// Test to see if this is the closest so far. If it is keep a record of the obstacle and its 
+				// local coordinates
+				if (ip < distToClosestIP)
+				{
+					distToClosestIP = ip;
 
-						closestIntersectingObstacle = *curOb;
+					closestIntersectingObstacle = ob;
 
-						localPosOfClosestObstacles = localPos;
-					}
+					localPosOfClosestObstacles = localPos;
 				}
 			}
 		}
-
-		++curOb;
 	}
 
 	// If we have found an intersecting obstacle, calculate a steering force away from it
@@ -930,9 +988,11 @@ Vector2D SteeringBehavior::ObstacleAvoidance(const std::vector<BaseGameEntity*>&
 // it may encounter
 //---------------------------------------------------------------------------------
 
-Vector2D SteeringBehavior::WallAvoidance(const std::vector<Wall2D>& walls)
+Vector2D SteeringBehavior::WallAvoidance(const std::vector<Wall2D>& walls, const WallGrid& grid)
 {
-	// The feelers are contained in a std::vector, m_feelers
+	PROFILE_SCOPE("WallAvoidance");
+
+	// The feelers are contained in a std::array, m_feelers
 	CreateFeelers();
 
 	double distToThisIP = 0.0;
@@ -948,9 +1008,16 @@ Vector2D SteeringBehavior::WallAvoidance(const std::vector<Wall2D>& walls)
 	// Examine each feelere in turn
 	for (unsigned int flr = 0; flr < m_feelers.size(); ++flr)
 	{
-		// Run through each wall checking for any intersection points
-		for (unsigned int w = 0; w < walls.size(); ++w)
+		// Run through each wall near the feeler checking for any intersection
+		// points. They come in index order, as the full list would
+		grid.Candidates(m_pVehicle->Pos(), m_feelers[flr], t_wallCandidates);
+
+		PROFILE_COUNT("WallCandidates", t_wallCandidates.size());
+
+		for (unsigned int c = 0; c < t_wallCandidates.size(); ++c)
 		{
+			const int w = t_wallCandidates[c];
+
 			if (LineIntersection2D(m_pVehicle->Pos(), m_feelers[flr],
 				walls[w].From(), walls[w].To(), distToThisIP, point))
 			{
@@ -989,6 +1056,8 @@ Vector2D SteeringBehavior::WallAvoidance(const std::vector<Wall2D>& walls)
 
 Vector2D SteeringBehavior::FollowPath()
 {
+	PROFILE_SCOPE("FollowPath");
+
 	// Move to next target if close enough to current target (working in distance squared space)
 	if (Vec2DDistanceSq(m_pPath->CurrentWaypoint(), m_pVehicle->Pos()) < m_dWaypointSeekDistSq)
 	{
@@ -1032,258 +1101,97 @@ Vector2D SteeringBehavior::Interpose(const Vehicle* vehicleA, const Vehicle* veh
 }
 
 //--------------------------- Hide -----------------------------------------------
-// 
+// Steers to the hiding spot nearest the agent. The obstacles are searched in
+// widening circles around the agent. An obstacle outside the circle is at
+// least range from the agent, so its hiding spot is at least range minus
+// DistanceFromBoundary away. Once a spot closer than that is found no
+// obstacle further out can beat it
 //--------------------------------------------------------------------------------
 
 Vector2D SteeringBehavior::Hide(const Vehicle* hunter, const std::vector<BaseGameEntity*>& obstacles)
 {
+	PROFILE_SCOPE("Hide");
+
 	double distToClosest = MaxDouble;
 	Vector2D bestHidingSpot;
 
-	std::vector<BaseGameEntity*>::const_iterator curOb = obstacles.begin();
-	std::vector<BaseGameEntity*>::const_iterator closest;
-
-	while (curOb != obstacles.end())
-	{
-		// Calculate the position of the hiding spot for this obstacle
-		Vector2D hidingSpot = GetHidingPosition((*curOb)->Pos(), (*curOb)->BRadius(), hunter->Pos());
-
-		// Work in distance-squared space to find the closest hiding spot to the agent
-		double dist = Vec2DDistanceSq(hidingSpot, m_pVehicle->Pos());
+	double range = 4 * DistanceFromBoundary;
 
-		if (dist < distToClosest)
-		{
-			distToClosest = dist;
-			bestHidingSpot = hidingSpot;
-			closest = curOb;
-		}
-
-		++curOb;
-	}
-
-	// If no suitable obstacles found then Evade the hunter
-	if (distToClosest == MaxFloat)
+	while (!obstacles.empty())
 	{
-		return Evade(hunter);
-	}
-
-	// Use Arrive on the hiding spot
-	return Arrive(bestHidingSpot, fast);
-}
+		m_pVehicle->World()->ObstaclesInRange(m_pVehicle->Pos(), range, t_nearObstacles);
 
-//--------------------------- Cohesion -------------------------------------------
-// Returns a steering force that attempts to move the agent towards the center of
-// mass of the agents in its immediate area
-//--------------------------------------------------------------------------------
+		distToClosest = MaxDouble;
 
-Vector2D SteeringBehavior::Cohesion(const std::vector<Vehicle*>& agents)
-{
-	// First find the center of mass of all the agents
-	Vector2D centerOfMass, steeringForce;
-	int neighborCount = 0;
-
-	// Iterate through the neighbors and sum up all the position vectors
-	for (unsigned int a = 0; a < agents.size(); ++a)
-	{
-		// Make sure this agent is not included in the calculations and that the
-		// agent being examined is close enough; also make sure it doesn't include
-		// the evade target
-		if ((agents[a] != m_pVehicle) && agents[a]->IsTagged() && (agents[a] != m_pTargetAgent1))
+		for (unsigned int n = 0; n < t_nearObstacles.size(); ++n)
 		{
-			centerOfMass += agents[a]->Pos();
-			++neighborCount;
-		}
-	}
-
-	if (neighborCount > 0)
-	{
-		// The center of mass is the average of the sum of positions
-		centerOfMass /= (double)neighborCount;
-
-		// Now seek towards that position
-		steeringForce = Seek(centerOfMass);
-	}
-
-	// The magnitude of cohesion is usually much larger than separation or allignment so it usually helps
-	// to normalize it
-	return Vec2DNormalize(steeringForce);
-}
-
-//--------------------------- Separation -------------------------------------------
-// This calculates a force repelling from the other neighbours
-//----------------------------------------------------------------------------------
+			const BaseGameEntity* ob = obstacles[t_nearObstacles[n]];
 
-Vector2D SteeringBehavior::Separation(const std::vector<Vehicle*>& agents)
-{
-	Vector2D steeringForce;
+			// Calculate the position of the hiding spot for this obstacle
+			Vector2D hidingSpot = GetHidingPosition(ob->Pos(), ob->BRadius(), hunter->Pos());
 
-	for (unsigned int a = 0; a < agents.size(); ++a)
-	{
-		// Make sure this agent isn't included in the calculations and that the
-		// agent being examined is close enough. Also, make sure it doesn't include
-		// the evade target
-		if (agents[a] != m_pVehicle && agents[a]->IsTagged() && agents[a] != m_pTargetAgent1)
-		{
-			Vector2D toAgent = m_pVehicle->Pos() - agents[a]->Pos();
+			// Work in distance-squared space to find the closest hiding spot to the agent
+			double dist = Vec2DDistanceSq(hidingSpot, m_pVehicle->Pos());
 
-			// Scale the force inversely proportional to the agents
-			// distance from its neighbour
-			steeringForce += Vec2DNormalize(toAgent) / toAgent.Length();
+			if (dist < distToClosest)
+			{
+				distToClosest = dist;
+				bestHidingSpot = hidingSpot;
+			}
 		}
-	}
-
-	return steeringForce;
-}
 
-//--------------------------- Alignment -----------------------------------------
-// Returns a force that attempts to align these agents heading with that of its
-// neighbours
-//-------------------------------------------------------------------------------
+		const double safeDist = range - DistanceFromBoundary;
 
-Vector2D SteeringBehavior::Alignment(const std::vector<Vehicle*>& agents)
-{
-	// Used to record the average heading of the neighbours
-	Vector2D averageHeading;
+		if (distToClosest < safeDist * safeDist || t_nearObstacles.size() == obstacles.size()) break;
 
-	// Used to count the number of vehicles in the neighborhood
-	int neighbourCount = 0;
-
-	// Iterate through all the tagged vehicles and sum their heading vectors
-	for (unsigned int a = 0; a < agents.size(); ++a)
-	{
-		// Make sure this agent isn't included in the calculations and that the agent
-		// being examined is close enough. Also, make sure it doesn't include any
-		// evade target
-		if (agents[a] != m_pVehicle && agents[a]->IsTagged() && agents[a] != m_pTargetAgent1)
-		{
-			averageHeading += agents[a]->Heading();
-
-			++neighbourCount;
-		}
+		range *= 2;
 	}
 
-	// If the neighborhood contained one or more vehicles, average their heading
-	// vectors
-	if (neighbourCount > 0)
+	// If no suitable obstacles found then Evade the hunter
+	if (distToClosest == MaxDouble)
 	{
-		averageHeading /= (double)neighbourCount;
-
-		averageHeading -= m_pVehicle->Heading();
+		return Evade(hunter);
 	}
 
-	return averageHeading;
+	// Use Arrive on the hiding spot
+	return Arrive(bestHidingSpot, fast);
 }
 
 //--------------------------- CohesionPlus -----------------------------------------
 // Returns a steering force that attempts to move the agent towards the center of 
 // mass of the agents in its immediate area
-// It uses spatial partitioning
+// It works from the sums gathered by the flocking kernels
 //----------------------------------------------------------------------------------
 
-Vector2D SteeringBehavior::CohesionPlus(const std::vector<Vehicle*>& agents)
+Vector2D SteeringBehavior::CohesionPlus(const FlockingSums& sums)
 {
-	// First, find the center of mass of all agents
-	Vector2D centerOfMass, steeringForce;
-
-	int neighbourCount = 0;
-
-	// Iterate through the neighbours and sum up all the position vectors
-	for (BaseGameEntity* pV = m_pVehicle->World()->CellSpace()->Begin();
-		!m_pVehicle->World()->CellSpace()->End();
-		pV = m_pVehicle->World()->CellSpace()->Next())
-	{
-		// Make sure this agent isn't included in the calculations and that the
-		// agent being examined is close enough
-		if (pV != m_pVehicle)
-		{
-			centerOfMass += pV->Pos();
-
-			++neighbourCount;
-		}
-	}
-
-	if (neighbourCount > 0)
-	{
-		// The center of mass is the average of the sum of positions
-		centerOfMass /= (double)neighbourCount;
-
-		// Now, seek towards that position
-		steeringForce = Seek(centerOfMass);
-	}
-
 	// The magnitude of cohesion is usually much larger than separation or alignment so
-	// it usually helps to normalize it
-	return Vec2DNormalize(steeringForce);
+	// it comes back normalized
+	return FlockingCohesion(sums, m_pVehicle->Pos(), m_pVehicle->Velocity(), m_pVehicle->MaxSpeed());
 }
 
 //--------------------------- SeparationPlus ---------------------------------------
 // This calculates a force repelling from the other neighbours
-// It uses spatial partitioning
+// It works from the sums gathered by the flocking kernels
 //----------------------------------------------------------------------------------
 
-Vector2D SteeringBehavior::SeparationPlus(const std::vector<Vehicle*>& agents)
+Vector2D SteeringBehavior::SeparationPlus(const FlockingSums& sums)
 {
-	Vector2D steeringForce;
-
-	// Iterate through the neighbours and sum up all the position vectors
-	for (BaseGameEntity* pV = m_pVehicle->World()->CellSpace()->Begin();
-		!m_pVehicle->World()->CellSpace()->End();
-		pV = m_pVehicle->World()->CellSpace()->Next())
-	{
-		// Make sure this agent isn't included in the calculations and that the
-		// agent being examined is close enough
-		if (pV != m_pVehicle)
-		{
-			Vector2D toAgent = m_pVehicle->Pos() - pV->Pos();
-
-			// Scale the force inversely proportional to the agents distance from
-			// its neighbour
-			steeringForce += Vec2DNormalize(toAgent) / toAgent.Length();
-		}
-	}
-
-	return steeringForce;
+	return FlockingSeparation(sums);
 }
 
 //--------------------------- AlignmentPlus ---------------------------------------
 // Returns a force that attempts to align this agents with that of its neighbours
-// It uses spatial partitioning
+// It works from the sums gathered by the flocking kernels
 //---------------------------------------------------------------------------------
 
-Vector2D SteeringBehavior::AlignmentPlus(const std::vector<Vehicle*>& agents)
+Vector2D SteeringBehavior::AlignmentPlus(const FlockingSums& sums)
 {
-	// This will record the average heading of the neighbours
-	Vector2D averageHeading;
-
-	// This count the number of vehicles in the neighbourhood
-	double neighbourCount = 0.0;
-
-	// Iterate through the neighbours and sum up all the position vectors
-	for (MovingEntity* pV = m_pVehicle->World()->CellSpace()->Begin();
-		!m_pVehicle->World()->CellSpace()->End();
-		pV = m_pVehicle->World()->CellSpace()->Next())
-	{
-		// Make sure this agent isn't included in the calculations and that the agent
-		// being examined is close enough
-		if (pV != m_pVehicle)
-		{
-			averageHeading += pV->Heading();
-
-			++neighbourCount;
-		}
-	}
-
-	// If the neighbourhood contained one or more vehicles, average their
-	// heading vectors.
-	if (neighbourCount > 0.0)
-	{
-		averageHeading /= neighbourCount;
-		averageHeading -= m_pVehicle->Heading();
-	}
-
-	return averageHeading;
+	return FlockingAlignment(sums, m_pVehicle->Heading());
 }
 
+#ifndef HEADLESS
+
 // For receiving keyboard input from user
 #define KEYDOWN(vkCode) ((GetAsyncKeyState(vkCode) & 0x8000) ? 1 : 0)
 
@@ -1381,8 +1289,8 @@ void SteeringBehavior::RenderAids()
 		// The detection box length is proportional to the agent's velocity
 		m_dDBoxLength = Prm.MinDetectionBoxLength() + (m_pVehicle->Speed() / m_pVehicle->MaxSpeed()) * Prm.MinDetectionBoxLength();
 
-		// Tag all obstacles within range of the box for processing
-		m_pVehicle->World()->TagObstaclesWithingViewRange(m_pVehicle, m_dDBoxLength);
+		// Find all obstacles within range of the box for processing
+		m_pVehicle->World()->ObstaclesInRange(m_pVehicle->Pos(), m_dDBoxLength, t_nearObstacles);
 
 		// This will keep track of the closest intersecting obstacle (CIB)
 		BaseGameEntity* closestIntersectingObstacle = nullptr;
@@ -1393,30 +1301,24 @@ void SteeringBehavior::RenderAids()
 		// This will record the transformed local coordinates of the CIB
 		Vector2D localPosOfClosestObstacle;
 
-		std::vector<BaseGameEntity*>::const_iterator curOb = m_pVehicle->World()->Obstacles().begin();
-
-		while (curOb != m_pVehicle->World()->Obstacles().end())
+		for (unsigned int n = 0; n < t_nearObstacles.size(); ++n)
 		{
-			// If the obstacle has been tagged within range proceed
-			if ((*curOb)->IsTagged())
-			{
-				// Calculate this obstacle's position in local space
-				Vector2D localPos = PointToLocalSpace((*curOb)->Pos(), m_pVehicle->Heading(), m_pVehicle->Side(), m_pVehicle->Pos());
+			const BaseGameEntity* ob = m_pVehicle->World()->Obstacles()[t_nearObstacles[n]];
+
+			// Calculate this obstacle's position in local space
+			Vector2D localPos = PointToLocalSpace(ob->Pos(), m_pVehicle->Heading(), m_pVehicle->Side(), m_pVehicle->Pos());
 
-				// If the local position has a negative x value then it must lay behind the agent. (in which case it can be ignored)
-				if (localPos.x >= 0)
+			// If the local position has a negative x value then it must lay behind the agent. (in which case it can be ignored)
+			if (localPos.x >= 0)
+			{
+				// If the distance from the x axis to the object's position is less than its radius + half the width
+				// of the detection box then there is a potential intersection.
+				if (fabs(localPos.y) < (ob->BRadius() + m_pVehicle->BRadius()))
 				{
-					// If the distance from the x axis to the object's position is less than its radius + half the width
-					// of the detection box then there is a potential intersection.
-					if (fabs(localPos.y) < ((*curOb)->BRadius() + m_pVehicle->BRadius()))
-					{
-						gdi->ThickRedPen();
-						gdi->ClosedShape(box);
-					}
+					gdi->ThickRedPen();
+					gdi->ClosedShape(box);
 				}
 			}
-
-			++curOb;
 		}
 	}
 
@@ -1476,3 +1378,5 @@ void SteeringBehavior::RenderAids()
 		if (KEYDOWN('C')) { m_dWaypointSeekDistSq -= 1.0; Clamp(m_dWaypointSeekDistSq, 0.0f, 400.0f); }
 	}
 }
+
+#endif
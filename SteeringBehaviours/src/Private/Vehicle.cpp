@@ -4,7 +4,10 @@
 #include "Public/2D/C2DMatrix.h"
 #include "Public/2D/Transformations.h"
 #include "Public/Misc/CellSpacePartition.h"
+
+#ifndef HEADLESS
 #include "Public/Misc/Cgdi.h"
+#endif
 
 Vehicle::Vehicle(GameWorld* world,
 	Vector2D position,
@@ -30,64 +33,60 @@ Vehicle::Vehicle(GameWorld* world,
 	m_pSteering(nullptr),
 	m_vSmoothedHeading(Vector2D(0, 0)),
 	m_bSmoothingOn(false),
-	m_dTimeElapsed(0.0f)
+	m_dTimeElapsed(0.0f),
+	m_iIndex(-1)
 {
-	InitializeBuffer();
-
-	// Sets up the steering behavior class
-	m_pSteering = new SteeringBehavior(this);
+	// Sets up the steering behavior class. It and the smoother are put next
+	// to the vehicle in the world's arena
+	m_pSteering = world->AgentArena().New<SteeringBehavior>(this);
 
 	// Sets up the smoother
-	m_pHeadingSmoother = new Smoother<Vector2D>(0, Vector2D(0.0f, 0.0f));
+	m_pHeadingSmoother = world->AgentArena().New<Smoother<Vector2D>>(0, Vector2D(0.0f, 0.0f));
 }
 
 // --------------------- Destructor  ---------------------------------
+// The steering behavior and smoother belong to the world's arena, which
+// destroys them along with everything else
 // -------------------------------------------------------------------
 
 Vehicle::~Vehicle()
 {
-	delete m_pSteering;
-	delete m_pHeadingSmoother;
 }
 
 // --------------------- Update  -------------------------------------
-// Fills the vehicle's shape buffer with its vertices
+// Updates the vehicle's position from a series of steering behaviours
 // -------------------------------------------------------------------
 
-void Vehicle::InitializeBuffer()
+void Vehicle::Update(double timeElapsed)
 {
-	const int numVehicleVerts = 3;
+	CalculateSteering(timeElapsed);
 
-	Vector2D vehicle[numVehicleVerts] = { 
-		Vector2D(-1.0f, 0.6f), 
-		Vector2D(1.0f, 0.0f), 
-		Vector2D(-1.0f, -0.6f) 
-	};
-
-	// Setup the vertex buffers and calculate the bounding radius
-	for (int vtx = 0; vtx < numVehicleVerts; ++vtx)
-	{
-		m_vecVehicleVB.push_back(vehicle[vtx]);
-	}
+	Integrate();
 }
 
-// --------------------- Update  -------------------------------------
-// Updates the vehicle's position from a series of steering behaviours
+// --------------------- CalculateSteering  --------------------------
+// Calculates the combined force from each steering behaviour in the
+// vehicle's list. Only reads the rest of the world
 // -------------------------------------------------------------------
 
-void Vehicle::Update(double timeElapsed)
+void Vehicle::CalculateSteering(double timeElapsed)
 {
 	// Update the time elapsed
 	m_dTimeElapsed = timeElapsed;
 
-	// Keep a record of its old position so we can update its cell later
-	Vector2D oldPos = Pos();
+	m_pSteering->Calculate();
+}
+
+// --------------------- Integrate  ----------------------------------
+// Moves the vehicle according to the steering force calculated by
+// the last call to CalculateSteering
+// -------------------------------------------------------------------
 
-	Vector2D steeringForce;
+void Vehicle::Integrate()
+{
+	const double timeElapsed = m_dTimeElapsed;
 
-	// Calculate the combined force from each steering behaviour in the
-	// vehicle's list
-	steeringForce = m_pSteering->Calculate();
+	Vector2D steeringForce = m_pSteering->Force();
 
 	// Acceleration = Force / Mass
 	Vector2D acceleration = steeringForce / m_dMass;
@@ -111,18 +110,33 @@ void Vehicle::Update(double timeElapsed)
 	// Treat the screen as a toroid
 	WrapAround(m_vPos, m_pWorld->cxClient(), m_pWorld->cyClient());
 
-	// Update the vehicle's current cell if SP is turned on
-	if (Steering()->IsSpacePartitioningOn())
+	if (IsSmoothingOn())
 	{
-		World()->CellSpace()->UpdateEntity(this, oldPos);
+		m_vSmoothedHeading = m_pHeadingSmoother->Update(Heading());
 	}
+}
 
-	if (IsSmoothingOn())
+// --------------------- IntegrateBatch  -----------------------------
+// -------------------------------------------------------------------
+
+void Vehicle::IntegrateBatch(Vehicle* const* vehicles, size_t count)
+{
+	for (size_t a = 0; a < count; ++a)
 	{
-		m_vSmoothedHeading = m_pHeadingSmoother->Update(Heading());
+		vehicles[a]->Integrate();
 	}
 }
 
+#ifndef HEADLESS
+
+// The vertices of the vehicle shape, shared by every vehicle
+static const std::vector<Vector2D> VehicleShape =
+{
+	Vector2D(-1.0f, 0.6f),
+	Vector2D(1.0f, 0.0f),
+	Vector2D(-1.0f, -0.6f)
+};
+
 // --------------------- Render  -------------------------------------
 // -------------------------------------------------------------------
 
@@ -156,7 +170,7 @@ void Vehicle::Render()
 	if (IsSmoothingOn())
 	{
 		m_vecVehicleVBTrans = WorldTransform(
-			m_vecVehicleVB, 
+			VehicleShape, 
 			Pos(), 
 			SmoothedHeading(), 
 			SmoothedHeading().Perp(), 
@@ -166,7 +180,7 @@ void Vehicle::Render()
 	else
 	{
 		m_vecVehicleVBTrans = WorldTransform(
-			m_vecVehicleVB,
+			VehicleShape,
 			Pos(),
 			Heading(),
 			Side(),
@@ -182,3 +196,5 @@ void Vehicle::Render()
 		Steering()->RenderAids();
 	}
 }
+
+#endif
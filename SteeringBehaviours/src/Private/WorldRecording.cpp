@@ -0,0 +1,78 @@
+#include "Public/WorldRecording.h"
+
+#include <iostream>
+#include <iomanip>
+#include <limits>
+#include <string>
+
+//------------------------------- Begin ----------------------------------
+//------------------------------------------------------------------------
+
+void WorldRecording::Begin(unsigned int seed, double timeStep)
+{
+	m_iSeed = seed;
+	m_dTimeStep = timeStep;
+	m_iNumFrames = 0;
+
+	m_events.clear();
+}
+
+//------------------------------- Write ----------------------------------
+//------------------------------------------------------------------------
+
+void WorldRecording::Write(std::ostream& os) const
+{
+	const std::streamsize oldPrecision = os.precision(std::numeric_limits<double>::max_digits10);
+
+	os << "seed " << m_iSeed << "\n";
+	os << "timestep " << m_dTimeStep << "\n";
+	os << "frames " << m_iNumFrames << "\n";
+	os << "events " << m_events.size() << "\n";
+
+	for (unsigned int e = 0; e < m_events.size(); ++e)
+	{
+		const WorldEvent& event = m_events[e];
+
+		os << event.m_iFrame << " " << (int)event.m_type << " " << event.m_iValue << " "
+			<< event.m_vPos.x << " " << event.m_vPos.y << "\n";
+	}
+
+	os.precision(oldPrecision);
+}
+
+//------------------------------- Read -----------------------------------
+//------------------------------------------------------------------------
+
+bool WorldRecording::Read(std::istream& is)
+{
+	std::string seedTag, timeStepTag, framesTag, eventsTag;
+	unsigned int numEvents = 0;
+
+	is >> seedTag >> m_iSeed >> timeStepTag >> m_dTimeStep >> framesTag >> m_iNumFrames >> eventsTag >> numEvents;
+
+	if (!is || seedTag != "seed" || timeStepTag != "timestep" || framesTag != "frames" || eventsTag != "events")
+	{
+		return false;
+	}
+
+	m_events.clear();
+
+	for (unsigned int e = 0; e < numEvents; ++e)
+	{
+		WorldEvent event;
+		int type = 0;
+
+		is >> event.m_iFrame >> type >> event.m_iValue >> event.m_vPos.x >> event.m_vPos.y;
+
+		if (!is || type < WorldEvent::ET_SetCrosshair || type > WorldEvent::ET_CreateRandomPath)
+		{
+			return false;
+		}
+
+		event.m_type = (WorldEvent::EventType)type;
+
+		m_events.push_back(event);
+	}
+
+	return true;
+}
@@ -0,0 +1,88 @@
+#pragma once
+
+#include <vector>
+
+#include "Public/2D/Vector2D.h"
+
+class Vehicle;
+
+// The precision of the agent store and the flocking kernels. Building with
+// STEERING_FLOAT halves the memory the steering hot path streams through and
+// doubles the width of the vector kernels. The vehicles and the rest of the
+// simulation stay in double either way
+#ifdef STEERING_FLOAT
+typedef float Real;
+#else
+typedef double Real;
+#endif
+
+//--------------------------------------------------------------------------
+// A structure-of-arrays copy of the per-agent state the steering hot path
+// reads. Element i always describes the world's i-th vehicle.
+//
+// The world refills it at the start of every update, before any steering is
+// calculated, so it doubles as the read-only snapshot the steering phase
+// works from. The vehicles themselves remain the authoritative state.
+//
+// The simulation only uses the one for Real, but both precisions are built,
+// so the two can be checked against each other from the same snapshot
+//--------------------------------------------------------------------------
+
+template<class T>
+class AgentStoreT
+{
+private:
+
+	std::vector<T> m_posX;
+	std::vector<T> m_posY;
+	std::vector<T> m_velX;
+	std::vector<T> m_velY;
+	std::vector<T> m_headingX;
+	std::vector<T> m_headingY;
+	std::vector<T> m_sideX;
+	std::vector<T> m_sideY;
+	std::vector<T> m_mass;
+	std::vector<T> m_maxSpeed;
+	std::vector<T> m_maxForce;
+	std::vector<T> m_bRadius;
+
+	// The active steering behaviors of each agent
+	std::vector<int> m_flags;
+
+public:
+
+	size_t Size() const { return m_posX.size(); }
+
+	void Resize(size_t numAgents);
+
+	// Copies the state of a vehicle into element i
+	void Store(size_t i, const Vehicle* pVehicle);
+
+	// Sets only the state the flocking kernels read, for filling a store
+	// without any vehicles behind it
+	void StoreFlockingState(size_t i, const Vector2D& pos, const Vector2D& heading, double bRadius);
+
+	const T* PosX() const { return m_posX.data(); }
+	const T* PosY() const { return m_posY.data(); }
+	const T* VelX() const { return m_velX.data(); }
+	const T* VelY() const { return m_velY.data(); }
+	const T* HeadingX() const { return m_headingX.data(); }
+	const T* HeadingY() const { return m_headingY.data(); }
+	const T* SideX() const { return m_sideX.data(); }
+	const T* SideY() const { return m_sideY.data(); }
+	const T* Mass() const { return m_mass.data(); }
+	const T* MaxSpeed() const { return m_maxSpeed.data(); }
+	const T* MaxForce() const { return m_maxForce.data(); }
+	const T* BRadius() const { return m_bRadius.data(); }
+	const int* Flags() const { return m_flags.data(); }
+
+	Vector2D Pos(size_t i) const { return Vector2D(m_posX[i], m_posY[i]); }
+	Vector2D Velocity(size_t i) const { return Vector2D(m_velX[i], m_velY[i]); }
+	Vector2D Heading(size_t i) const { return Vector2D(m_headingX[i], m_headingY[i]); }
+};
+
+// Defined in AgentStore.cpp for these two only
+extern template class AgentStoreT<float>;
+extern template class AgentStoreT<double>;
+
+typedef AgentStoreT<Real> AgentStore;
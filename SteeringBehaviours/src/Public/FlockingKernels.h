@@ -0,0 +1,80 @@
+#pragma once
+
+#include <cstddef>
+
+#include "Public/2D/Vector2D.h"
+
+template<class T> class AgentStoreT;
+
+//--------------------------------------------------------------------------
+// Batch kernels for the flocking behaviors. One pass over an agent's
+// neighbors gathers everything separation, alignment and cohesion need from
+// the agent store; the behaviors then finish the job from these sums.
+//
+// AccumulateFlocking and AccumulateFlockingInRange use AVX2 or SSE2 when
+// the compiler targets them and work one agent at a time otherwise. Each
+// neighbor's terms are computed with the same operations in every version,
+// but the vector kernels add them up in a different order, so results agree
+// to within rounding.
+//
+// The kernels work in the precision of the agent store, so on a float store
+// each vector instruction handles twice as many neighbors. Both precisions
+// are always built; the simulation uses the one for Real. Every neighbor's
+// terms are widened to double before they are added, so the sums are kept
+// in double either way
+//--------------------------------------------------------------------------
+
+struct FlockingSums
+{
+	// Sum of the neighbors' positions, used by cohesion
+	double m_dPosX;
+	double m_dPosY;
+
+	// Sum of the neighbors' headings, used by alignment
+	double m_dHeadingX;
+	double m_dHeadingY;
+
+	// Sum of the vectors away from each neighbor scaled by the inverse of
+	// its distance, used by separation
+	double m_dSeparationX;
+	double m_dSeparationY;
+
+	int m_iCount;
+
+	FlockingSums()
+		:m_dPosX(0.0), m_dPosY(0.0),
+		m_dHeadingX(0.0), m_dHeadingY(0.0),
+		m_dSeparationX(0.0), m_dSeparationY(0.0),
+		m_iCount(0)
+	{}
+};
+
+// Adds the contribution of agents[neighbors[0 .. count)] to sums for an agent
+// standing at pos. The agent itself must not be in the list. Neighbors at
+// the agent's exact position add nothing to separation
+void AccumulateFlocking(const AgentStoreT<float>& agents, const int* neighbors, size_t count, const Vector2D& pos, FlockingSums& sums);
+void AccumulateFlocking(const AgentStoreT<double>& agents, const int* neighbors, size_t count, const Vector2D& pos, FlockingSums& sums);
+
+// The reference version of the above, one neighbor at a time
+void AccumulateFlockingScalar(const AgentStoreT<float>& agents, const int* neighbors, size_t count, const Vector2D& pos, FlockingSums& sums);
+void AccumulateFlockingScalar(const AgentStoreT<double>& agents, const int* neighbors, size_t count, const Vector2D& pos, FlockingSums& sums);
+
+// Finds the neighbors of agents[self] and adds their contribution to sums in
+// a single sweep over the whole store, for when there is no spatial partition
+// to ask. An agent is a neighbor when its bounding circle overlaps the view
+// circle of the given radius, the same test TagNeighbors makes. Nothing but
+// sums is written, so any number of agents can do this at once. Pass -1 as
+// exclude if there is no other agent to leave out
+void AccumulateFlockingInRange(const AgentStoreT<float>& agents, size_t self, int exclude, double radius, FlockingSums& sums);
+void AccumulateFlockingInRange(const AgentStoreT<double>& agents, size_t self, int exclude, double radius, FlockingSums& sums);
+
+// Names the instruction set AccumulateFlocking was compiled for, with a
+// "-float" suffix in a float build
+const char* FlockingKernelName();
+
+// The flocking forces, finished off from the sums. SteeringBehavior's
+// SeparationPlus, AlignmentPlus and CohesionPlus call these with the
+// vehicle's own state
+Vector2D FlockingSeparation(const FlockingSums& sums);
+Vector2D FlockingAlignment(const FlockingSums& sums, const Vector2D& heading);
+Vector2D FlockingCohesion(const FlockingSums& sums, const Vector2D& pos, const Vector2D& velocity, double maxSpeed);
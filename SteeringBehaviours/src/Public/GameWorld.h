@@ -1,14 +1,20 @@
 #pragma once
 
-#include <windows.h>
 #include <vector>
 
 #include "Public/2D/Vector2D.h"
+#include "Public/2D/WallGrid.h"
 #include "Public/Time/PrecisionTimer.h"
 #include "Public/Misc/CellSpacePartition.h"
+#include "Public/Misc/ThreadPool.h"
+#include "Public/Misc/RandomStream.h"
+#include "Public/Misc/Arena.h"
 #include "Public/Entities/BaseGameEntity.h"
 #include "Public/Entities/EntityTemplates.h"
 #include "Vehicle.h"
+#include "AgentStore.h"
+#include "SteeringBehaviors.h"
+#include "WorldRecording.h"
 
 class Obstacle;
 class Wall2D;
@@ -16,24 +22,112 @@ class Path;
 
 typedef std::vector<BaseGameEntity*>::iterator ObIt;
 
+//--------------------------------------------------------------------------
+// How many of each thing a world is built with. The defaults are the
+// values in params.ini
+//--------------------------------------------------------------------------
+
+struct WorldSetup
+{
+	int m_iNumAgents;
+	int m_iNumObstacles;
+
+	// The cell space partition is a grid this many cells across and down
+	int m_iNumCellsX;
+	int m_iNumCellsY;
+
+	WorldSetup();
+};
+
 class GameWorld
 {
 private:
 
+	// Holds the vehicles and their components, each agent's parts next to
+	// each other. Rewinding it destroys them all at once
+	Arena* m_pArena;
+
+	// False if the arena was handed to the ctor, so outlives the world
+	bool m_bOwnsArena;
+
 	// A container of all the moving entities
 	std::vector<Vehicle*> m_vehicles;
 
+	// A snapshot of the vehicles taken at the start of each update
+	AgentStore m_agentState;
+
 	// Any obstacles
 	std::vector<BaseGameEntity*> m_obstacles;
 
 	// Container containing any walls in the environment
 	std::vector<Wall2D> m_Walls;
 
-	CellSpacePartition<Vehicle*>* m_pCellSpace;
+	// Finds the walls near a point. Rebuilt whenever the walls change
+	WallGrid m_wallGrid;
+
+	// The vehicles binned into a grid, keeping their positions in the same
+	// precision as the agent store
+	CellSpacePartition<Vehicle*, Real>* m_pCellSpace;
+
+	// The obstacles binned into a grid of their own. They don't move, so it
+	// is only rebuilt when the obstacles change
+	CellSpacePartition<BaseGameEntity*>* m_pObstacleSpace;
+
+	// The largest bounding radius of any obstacle, which bounds how far an
+	// obstacle's center can be from a point its circle is in range of
+	double m_dMaxObstacleRadius;
+
+	// Runs the vehicle updates across several threads
+	ThreadPool* m_pThreadPool;
+
+	// The vehicles that have one combination of active behaviors and summing
+	// method, in the order they appear in m_vehicles
+	struct SteeringBucket
+	{
+		int m_iFlags;
+		SteeringBehavior::SummingMethod m_summingMethod;
+
+		std::vector<Vehicle*> m_vehicles;
+	};
+
+	// The vehicles grouped so each group can be steered by one pipeline.
+	// Rebuilt only when some vehicle's behaviors change
+	std::vector<SteeringBucket> m_buckets;
+	bool m_bBucketsDirty;
+
+	void RebuildBuckets();
+
+	// How many vehicles each thread pool task updates
+	static const size_t VehiclesPerTask = 64;
 
 	// Any path we may create for the vehicles to follow
 	Path* m_pPath;
 
+	// The seed alone decides how a run unfolds. The world's own random
+	// numbers come from m_random, and each vehicle's steering keys its own
+	// stream off the seed
+	unsigned int m_iSeed;
+	RandomStream m_random;
+
+	// If positive, Update advances the world in steps of exactly this long
+	double m_dFixedTimeStep;
+
+	// Time Update has been given but not yet simulated in fixed step mode
+	double m_dTimeAccumulator;
+
+	// The most steps one Update will take to catch up with the clock
+	static const int MaxStepsPerUpdate = 8;
+
+	// How many steps the world has taken
+	int m_iFrame;
+
+	// Where the inputs are being recorded to, if anywhere
+	WorldRecording* m_pRecording;
+
+	void RecordEvent(WorldEvent::EventType type, int value = 0, Vector2D pos = Vector2D());
+
+	void ApplyEvent(const WorldEvent& event);
+
 	// Set true to pause the motion
 	bool m_bPaused;
 
@@ -59,19 +153,68 @@ private:
 	bool m_bViewKeys;
 	bool m_bShowCellSpaceInfo;
 
+	// How many obstacles CreateObstacles tries to place
+	int m_iNumObstacles;
+
 	void CreateObstacles();
 
+	// Bins m_obstacles into m_pObstacleSpace
+	void IndexObstacles();
+
 	void CreateWalls();
 
+	// Indexes m_Walls for the wall avoidance feelers
+	void BuildWallGrid();
+
 public:
 
-	GameWorld(int cx, int cy);
+	// The agents are created in arena if one is given, and it is rewound when
+	// the world is destroyed. Passing the same arena to each new world lets
+	// it reuse the memory of the last, so nothing else may be put in it
+	GameWorld(int cx, int cy, unsigned int seed = 0, const WorldSetup& setup = WorldSetup(), Arena* arena = nullptr);
 
 	~GameWorld();
 
+	// Advances the world by the time elapsed, or in fixed step mode by as
+	// many whole steps as fit in the time elapsed so far
 	void Update(double timeElapsed);
 
+	// Advances the world by exactly one step of the given length
+	void Step(double timeElapsed);
+
+	// Zero goes back to stepping by whatever time Update is given
+	void SetFixedTimeStep(double timeStep) { m_dFixedTimeStep = timeStep; m_dTimeAccumulator = 0.0; }
+	double FixedTimeStep() const { return m_dFixedTimeStep; }
+
+	int Frame() const { return m_iFrame; }
+
+	unsigned int Seed() const { return m_iSeed; }
+	RandomStream& Random() { return m_random; }
+
+	// Where the agents and their components are created
+	Arena& AgentArena() const { return *m_pArena; }
+
+	// Records every input from now on. Only a new world in fixed step mode
+	// can be recorded
+	void StartRecording(WorldRecording* pRecording);
+	void StopRecording();
+
+	// Plays a recording back as fast as possible. The world must be new and
+	// created with the recording's seed
+	void Replay(const WorldRecording& recording);
+
+	// Called by a vehicle's steering when its behaviors or summing method
+	// change. Must not be called while the world is updating
+	void BehaviorsChanged() { m_bBucketsDirty = true; }
+
+	// Replaces the thread pool used by Update. Zero means one thread per
+	// hardware thread
+	void SetNumThreads(unsigned int numThreads);
+	unsigned int NumThreads() const { return m_pThreadPool->NumThreads(); }
+
+#ifndef HEADLESS
 	void Render();
+#endif
 
 	void NonPenetrationConstraint(Vehicle* v) { EnforceNonPenetrationConstraint(v, m_vehicles); }
 	
@@ -80,38 +223,39 @@ public:
 		TagNeighbors(pVehicle, m_vehicles, range);
 	}
 
-	void TagObstaclesWithingViewRange(BaseGameEntity* pVehicle, double range)
-	{
-		TagNeighbors(pVehicle, m_obstacles, range);
-	}
+	// Fills obstacles with the index of every obstacle within range of pos,
+	// allowing for the obstacle's bounding radius. They're the obstacles
+	// TagNeighbors would tag, in ascending order. Nothing is written to the
+	// obstacles, so any number of threads may ask at once
+	void ObstaclesInRange(const Vector2D& pos, double range, std::vector<int>& obstacles) const;
 
 	const std::vector<Wall2D>& Walls() const { return m_Walls; }
-	CellSpacePartition<Vehicle*>* CellSpace() const { return m_pCellSpace; }
+	const WallGrid& WallIndex() const { return m_wallGrid; }
+	CellSpacePartition<Vehicle*, Real>* CellSpace() const { return m_pCellSpace; }
 	const std::vector<BaseGameEntity*>& Obstacles() const { return m_obstacles; }
 	const std::vector<Vehicle*>& Agents() const { return m_vehicles; }
-
-	// Handle WM_COMMAND messages
-	void HandleYKey();
-	void HandleUKey();
-	void HandleIKey();
-	void HandleKeyPresses(WPARAM wParam);
-
-	void ToggleObstacles(HWND hwnd);
-	void ToggleWalls(HWND hwnd);
-	void ToggleMenuSmoothing(HWND hwnd);
-	void ToggleSpacePartitioning(HWND hwnd);
-	void ToggleCellSpacePartitioning(HWND hwnd);
-	void ToggleSumming(HWND hwnd);
-	void TogglePrioritizeSummingMethod(HWND hwnd);
-	void ToggleDithered(HWND hwnd);
-	void HandleMenuItems(WPARAM wParam, HWND hwnd);
+	const AgentStore& AgentState() const { return m_agentState; }
+
+	// These are the operations the front end (or a headless driver) can
+	// perform on the world. None of them depend on the windowing system
+	void ToggleObstacles();
+	void ToggleWalls();
+	void ToggleSmoothing();
+	void ToggleSpacePartitioning();
+	void ToggleShowCellSpaceInfo() { m_bShowCellSpaceInfo = !m_bShowCellSpaceInfo; }
+	void SetSummingMethod(SteeringBehavior::SummingMethod sm);
+	void CreateRandomPath();
+
+	bool IsSmoothingOn() const { return !m_vehicles.empty() && m_vehicles[0]->IsSmoothingOn(); }
+	bool IsSpacePartitioningOn() const { return !m_vehicles.empty() && m_vehicles[0]->Steering()->IsSpacePartitioningOn(); }
+	bool ShowCellSpaceInfo() const { return m_bShowCellSpaceInfo; }
 
 	void TogglePause() { m_bPaused = !m_bPaused; }
 	bool Paused() const { return m_bPaused; }
 
+	// The crosshair is not moved if the proposed position is inside an obstacle
 	Vector2D Crosshair() const { return m_vCrosshair; }
-	void SetCrosshair(POINTS p);
-	void SetCrosshair(Vector2D v) { m_vCrosshair = v; }
+	void SetCrosshair(Vector2D v);
 
 	// Accesors
 	int cxClient() const { return m_cxClient; }
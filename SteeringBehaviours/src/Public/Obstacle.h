@@ -2,11 +2,11 @@
 
 #include "Public/2D/Vector2D.h"
 #include "Public/Entities/BaseGameEntity.h"
+#ifndef HEADLESS
 #include "Public/Misc/Cgdi.h"
+#endif
 
-#include <Windows.h>
-
-class Obstacle : public BaseGameEntity
+class Obstacle final : public BaseGameEntity
 {
 public:
 
@@ -19,7 +19,9 @@ public:
 	// implemented
 	void Update(double timeElapsed) override {};
 
+#ifndef HEADLESS
 	void Render() override { gdi->BlackPen(); gdi->Circle(Pos(), BRadius()); }
+#endif
 
 	bool HandleMessage(const Telegram& msg) override { return false; }
 
@@ -74,6 +74,10 @@ private:
 	double m_dPrHide;
 	double m_dPrArrive;
 
+	// Threads used to update the agents, counting the main thread. Zero
+	// means one per hardware thread
+	int m_iNumWorkerThreads;
+
 	ParamLoader()
 		:IniFileLoaderBase("params.ini"),
 		m_iNumAgents(GetNextParameterInt()),
@@ -123,7 +127,9 @@ private:
 		m_dPrFlee(GetNextParameterFloat()),
 		m_dPrEvade(GetNextParameterFloat()),
 		m_dPrHide(GetNextParameterFloat()),
-		m_dPrArrive(GetNextParameterFloat())
+		m_dPrArrive(GetNextParameterFloat()),
+		// Threading
+		m_iNumWorkerThreads(GetNextParameterInt())
 	{}
 
 public:
@@ -182,4 +188,6 @@ public:
 	inline double PrEvade() const { return m_dPrEvade; }
 	inline double PrHide() const { return m_dPrHide; }
 	inline double PrArrive() const { return m_dPrArrive; }
+
+	inline int NumWorkerThreads() const { return m_iNumWorkerThreads; }
 };
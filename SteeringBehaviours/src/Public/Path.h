@@ -5,6 +5,8 @@
 
 #include "Public/2D/Vector2D.h"
 
+class RandomStream;
+
 class Path
 {
 private:
@@ -24,14 +26,14 @@ public:
 
 	// Constructor for creating a path with initial random waypoints. 
 	// MinX/Y & MaxX/Y define the bounding box of the path.
-	Path(int numWaypoints, double minX, double minY, double maxX, double maxY, bool looped)
+	Path(int numWaypoints, double minX, double minY, double maxX, double maxY, bool looped, RandomStream& random)
 		: m_bLooped(looped)
 	{
-		CreateRandomPath(numWaypoints, minX, minY, maxX, maxY);
+		CreateRandomPath(numWaypoints, minX, minY, maxX, maxY, random);
 	}
 
 	// Creates a random path which is bound by rectangle described by the min/max values
-	void CreateRandomPath(int numWaypoints, double minX, double minY, double maxX, double maxY);
+	void CreateRandomPath(int numWaypoints, double minX, double minY, double maxX, double maxY, RandomStream& random);
 
 	// Adds a waypoint to the end of the path
 	void AddWayPoint(Vector2D newPoint) { m_wayPoints.push_back(newPoint); }
@@ -56,5 +58,7 @@ public:
 	void Clear() { m_wayPoints.clear(); }
 
 	// Renders the path in orange
+#ifndef HEADLESS
 	void Render() const;
+#endif
 };
\ No newline at end of file
@@ -1,18 +1,21 @@
 #pragma once
 
+#include <array>
 #include <vector>
-#include <Windows.h>
 #include <string>
 #include <list>
 
 #include "Public/2D/Vector2D.h"
+#include "Public/Misc/RandomStream.h"
 #include "ParamLoader.h"
 #include "Constants.h"
 #include "Path.h"
+#include "FlockingKernels.h"
 
 class Vehicle;
 class CController;
 class Wall2D;
+class WallGrid;
 class BaseGameEntity;
 
 //--------------------------- Constants ------------------------------------
@@ -68,6 +71,22 @@ private:
 		BT_OffsetPursuit = 0x10000
 	};
 
+	// The behavior combinations our populations use most. Each gets its own
+	// compiled copy of the summing methods with the flag tests folded away.
+	// Any other combination goes through the generic copy
+	enum PipelineMask
+	{
+		// Passed as the mask to have the pipeline test m_iFlags at run time
+		PM_Any = -1,
+
+		// What FlockingOn turns on
+		PM_Flock = BT_Cohesion | BT_Separation | BT_Alignment | BT_Wander,
+
+		// The fish and the shark they flee from in the shoal demo
+		PM_Shoal = PM_Flock | BT_Evade,
+		PM_Shark = BT_Wander | BT_Evade
+	};
+
 	// A pointer to the owner of this instance
 	Vehicle* m_pVehicle;
 
@@ -85,8 +104,17 @@ private:
 	// Length of the 'detection box' utilized in obstacle avoidance
 	double m_dDBoxLength;
 
-	// A vertex buffer to contain the feelers required for wall avoidance
-	std::vector<Vector2D> m_feelers;
+	// The feelers required for wall avoidance
+	std::array<Vector2D, 3> m_feelers;
+
+	// What the flocking kernel gathered from the last neighbor query
+	FlockingSums m_flockingSums;
+
+	// Where wander and the dithered summing method get their random numbers.
+	// It restarts every step at a point given by the world's seed, the
+	// vehicle's index and the frame, so the numbers don't depend on which
+	// thread runs the vehicle or when
+	RandomStream m_random;
 
 	// The length of the 'feeler/s' used in wall detection
 	double m_dWallDetectionFeelerLength;
@@ -148,17 +176,36 @@ private:
 	SummingMethod m_SummingMethod;
 
 	// This function tests if a specific bit of m_iFlags is set
-	bool On(const BehaviorType& bt) { return (m_iFlags & bt) == bt; }
+	bool On(const BehaviorType& bt) const { return (m_iFlags & bt) == bt; }
+
+	// Changes the active behaviors, letting the world know if they differ
+	void SetFlags(int flags);
+
+	// The same test for a pipeline compiled for Mask. Unless Mask is PM_Any
+	// the answer is known at compile time
+	template <int Mask>
+	bool Active(const BehaviorType& bt) const
+	{
+		if constexpr (Mask == PM_Any) return On(bt);
+		else return (Mask & bt) == bt;
+	}
 
 	bool AccumulateForce(Vector2D& sf, Vector2D& forceToAdd);
 
 	// Creates the antenna utilized by the wall avoidance behavior
 	void CreateFeelers();
 
-	// Calculates and sums the steering forces from any active behaviors
-	Vector2D CalculateWeightedSum();
-	Vector2D CalculatePrioritized();
-	Vector2D CalculateDithered();
+	// Gathers the flocking sums if any flocking behavior is active
+	void GatherFlocking();
+
+	// Calculates and sums the steering forces from any active behaviors,
+	// assuming exactly those in Mask are active
+	template <int Mask> Vector2D CalculateFor();
+	template <int Mask> Vector2D CalculatePipeline();
+	template <int Mask> static void CalculateBatch(Vehicle* const* vehicles, size_t count, double timeElapsed);
+	template <int Mask> Vector2D CalculateWeightedSum();
+	template <int Mask> Vector2D CalculatePrioritized();
+	template <int Mask> Vector2D CalculateDithered();
 
 	// Helper method for hide. Returns a position located on the other
 	// side of an obstacle to the pursuer
@@ -198,8 +245,9 @@ private:
 	Vector2D ObstacleAvoidance(const std::vector<BaseGameEntity*>& obstacles);
 
 	// This returns a steering force which will keep the agent away from any
-	// walls it may encounter
-	Vector2D WallAvoidance(const std::vector<Wall2D>& walls);
+	// walls it may encounter. Only the walls the grid puts near each feeler
+	// are tested
+	Vector2D WallAvoidance(const std::vector<Wall2D>& walls, const WallGrid& grid);
 
 	// Given a series of Vector2Ds, this method produces a force that will move
 	// the agent along the waypoints in order
@@ -217,17 +265,11 @@ private:
 	// Group Behaviours
 	//--------------------------------------------------------------------------
 
-	Vector2D Cohesion(const std::vector<Vehicle*>& agents);
-	
-	Vector2D Separation(const std::vector<Vehicle*>& agents);
-
-	Vector2D Alignment(const std::vector<Vehicle*>& agents);
-
-	// The following three are the same as above but they use cell-space
-	// partitioning to find the neighbors
-	Vector2D CohesionPlus(const std::vector<Vehicle*>& agents);
-	Vector2D SeparationPlus(const std::vector<Vehicle*>& agents);
-	Vector2D AlignmentPlus(const std::vector<Vehicle*>& agents);
+	// These finish off the sums the flocking kernels gathered over the
+	// neighbors, however they were found
+	Vector2D CohesionPlus(const FlockingSums& sums);
+	Vector2D SeparationPlus(const FlockingSums& sums);
+	Vector2D AlignmentPlus(const FlockingSums& sums);
 
 public:
 
@@ -238,6 +280,11 @@ public:
 	// Calculates and sums the steering forces from any active behaviors
 	Vector2D Calculate();
 
+	// Updates the time elapsed of count vehicles and calculates their
+	// steering forces. They must all have the same behaviors switched on
+	// and the same summing method, which is only looked at once
+	static void CalculateBatch(Vehicle* const* vehicles, size_t count, double timeElapsed);
+
 	// Calculates the component of the steering force that is parallel
 	// with the vehicle heading
 	double ForwardComponent();
@@ -247,7 +294,9 @@ public:
 	double SideComponent();
 
 	// Renders visual aids and info for seeing how each behavior is calculated
+#ifndef HEADLESS
 	void RenderAids();
+#endif
 
 	void SetTarget(const Vector2D t) { m_vTarget = t; }
 
@@ -258,47 +307,50 @@ public:
 	Vector2D GetOffset() const { return m_vOffset; }
 
 	void SetPath(std::list<Vector2D> newPath) { m_pPath->Set(newPath); }
-	void CreateRandomPath(int numWaypoints, int mx, int my, int cx, int cy) const { m_pPath->CreateRandomPath(numWaypoints, mx, my, cx, cy); }
+	void CreateRandomPath(int numWaypoints, int mx, int my, int cx, int cy, RandomStream& random) const { m_pPath->CreateRandomPath(numWaypoints, mx, my, cx, cy, random); }
 
 	Vector2D Force() const { return m_vSteeringForce; }
 
+	int Flags() const { return m_iFlags; }
+
 	void ToggleSpacePartitioningOnOff() { m_bCellSpaceOn = !m_bCellSpaceOn; }
 	bool IsSpacePartitioningOn() const { return m_bCellSpaceOn; }
 
-	void SetSummingMethod(SummingMethod sm) { m_SummingMethod = sm; }
-
-	void FleeOn() { m_iFlags |= BT_Flee; }
-	void SeekOn() { m_iFlags |= BT_Seek; }
-	void ArriveOn() { m_iFlags |= BT_Arrive; }
-	void WanderOn() { m_iFlags |= BT_Wander; }
-	void PursuitOn(Vehicle* v) { m_iFlags |= BT_Pursuit; m_pTargetAgent1 = v; }
-	void EvadeOn(Vehicle* v) { m_iFlags |= BT_Evade; m_pTargetAgent1 = v; }
-	void CohesionOn() { m_iFlags |= BT_Cohesion; }
-	void SeparationOn() { m_iFlags |= BT_Separation; }
-	void AlignmentOn() { m_iFlags |= BT_Alignment; }
-	void ObstacleAvoidanceOn() { m_iFlags |= BT_ObstacleAvoidance; }
-	void WallAvoidanceOn() { m_iFlags |= BT_WallAvoidance; }
-	void FollowPathOn() { m_iFlags |= BT_FollowPath; }
-	void InterposeOn(Vehicle* v1, Vehicle* v2) { m_iFlags |= BT_Interpose; m_pTargetAgent1 = v1; m_pTargetAgent2 = v2; }
-	void HideOn(Vehicle* v) { m_iFlags |= BT_Hide; m_pTargetAgent1 = v; }
-	void OffsetPursuitOn(Vehicle* v1, const Vector2D offset) { m_iFlags |= BT_OffsetPursuit; m_vOffset = offset; m_pTargetAgent1 = v1; }
+	void SetSummingMethod(SummingMethod sm);
+	SummingMethod GetSummingMethod() const { return m_SummingMethod; }
+
+	void FleeOn() { SetFlags(m_iFlags | BT_Flee); }
+	void SeekOn() { SetFlags(m_iFlags | BT_Seek); }
+	void ArriveOn() { SetFlags(m_iFlags | BT_Arrive); }
+	void WanderOn() { SetFlags(m_iFlags | BT_Wander); }
+	void PursuitOn(Vehicle* v) { SetFlags(m_iFlags | BT_Pursuit); m_pTargetAgent1 = v; }
+	void EvadeOn(Vehicle* v) { SetFlags(m_iFlags | BT_Evade); m_pTargetAgent1 = v; }
+	void CohesionOn() { SetFlags(m_iFlags | BT_Cohesion); }
+	void SeparationOn() { SetFlags(m_iFlags | BT_Separation); }
+	void AlignmentOn() { SetFlags(m_iFlags | BT_Alignment); }
+	void ObstacleAvoidanceOn() { SetFlags(m_iFlags | BT_ObstacleAvoidance); }
+	void WallAvoidanceOn() { SetFlags(m_iFlags | BT_WallAvoidance); }
+	void FollowPathOn() { SetFlags(m_iFlags | BT_FollowPath); }
+	void InterposeOn(Vehicle* v1, Vehicle* v2) { SetFlags(m_iFlags | BT_Interpose); m_pTargetAgent1 = v1; m_pTargetAgent2 = v2; }
+	void HideOn(Vehicle* v) { SetFlags(m_iFlags | BT_Hide); m_pTargetAgent1 = v; }
+	void OffsetPursuitOn(Vehicle* v1, const Vector2D offset) { SetFlags(m_iFlags | BT_OffsetPursuit); m_vOffset = offset; m_pTargetAgent1 = v1; }
 	void FlockingOn() { CohesionOn(); AlignmentOn(); SeparationOn(); WanderOn(); }
 
-	void FleeOff() { if (On(BT_Flee)) m_iFlags ^= BT_Flee; }
-	void SeekOff() { if (On(BT_Seek)) m_iFlags ^= BT_Seek; }
-	void ArriveOff() { if (On(BT_Arrive)) m_iFlags ^= BT_Arrive; }
-	void WanderOff() { if (On(BT_Wander)) m_iFlags ^= BT_Wander; }
-	void PursuitOff() { if (On(BT_Pursuit)) m_iFlags ^= BT_Pursuit; }
-	void EvadeOff() { if (On(BT_Evade)) m_iFlags ^= BT_Evade; }
-	void CohesionOff() { if (On(BT_Cohesion)) m_iFlags ^= BT_Cohesion; }
-	void SeparationOff() { if (On(BT_Separation)) m_iFlags ^= BT_Separation; }
-	void AlignmentOff() { if (On(BT_Alignment)) m_iFlags ^= BT_Alignment; }
-	void ObstacleAvoidanceOff() { if (On(BT_ObstacleAvoidance)) m_iFlags ^= BT_ObstacleAvoidance; }
-	void WallAvoidanceOff() { if (On(BT_WallAvoidance)) m_iFlags ^= BT_WallAvoidance; }
-	void FollowPathOff() { if (On(BT_FollowPath)) m_iFlags ^= BT_FollowPath; }
-	void InterposeOff() { if (On(BT_Interpose)) m_iFlags ^= BT_Interpose; }
-	void HideOff() { if (On(BT_Hide)) m_iFlags ^= BT_Hide; }
-	void OffsetPursuitOff() { if (On(BT_OffsetPursuit)) m_iFlags ^= BT_OffsetPursuit; }
+	void FleeOff() { SetFlags(m_iFlags & ~BT_Flee); }
+	void SeekOff() { SetFlags(m_iFlags & ~BT_Seek); }
+	void ArriveOff() { SetFlags(m_iFlags & ~BT_Arrive); }
+	void WanderOff() { SetFlags(m_iFlags & ~BT_Wander); }
+	void PursuitOff() { SetFlags(m_iFlags & ~BT_Pursuit); }
+	void EvadeOff() { SetFlags(m_iFlags & ~BT_Evade); }
+	void CohesionOff() { SetFlags(m_iFlags & ~BT_Cohesion); }
+	void SeparationOff() { SetFlags(m_iFlags & ~BT_Separation); }
+	void AlignmentOff() { SetFlags(m_iFlags & ~BT_Alignment); }
+	void ObstacleAvoidanceOff() { SetFlags(m_iFlags & ~BT_ObstacleAvoidance); }
+	void WallAvoidanceOff() { SetFlags(m_iFlags & ~BT_WallAvoidance); }
+	void FollowPathOff() { SetFlags(m_iFlags & ~BT_FollowPath); }
+	void InterposeOff() { SetFlags(m_iFlags & ~BT_Interpose); }
+	void HideOff() { SetFlags(m_iFlags & ~BT_Hide); }
+	void OffsetPursuitOff() { SetFlags(m_iFlags & ~BT_OffsetPursuit); }
 	void FlockingOff() { CohesionOff(); AlignmentOff(); SeparationOff(); WanderOff(); }
 
 	bool IsFleeOn() { return On(BT_Flee); }
@@ -318,7 +370,7 @@ public:
 	bool IsOffsetPursuitOn() { return On(BT_OffsetPursuit); }
 
 	double DBoxLength() const { return m_dDBoxLength; }
-	const std::vector<Vector2D>& GetFeelers() const { return m_feelers; }
+	const std::array<Vector2D, 3>& GetFeelers() const { return m_feelers; }
 
 	double WanderJitter() const { return m_dWanderJitter; }
 	double WanderDistance() const { return m_dWanderDistance; }
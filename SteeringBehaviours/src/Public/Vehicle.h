@@ -11,7 +11,13 @@
 class GameWorld;
 class SteeringBehavior;
 
-class Vehicle : public MovingEntity
+//--------------------------------------------------------------------------
+// Nothing derives from Vehicle, and saying so lets calls made through a
+// Vehicle* skip the virtual dispatch. Code holding a BaseGameEntity*, such as
+// the messaging layer, still goes through the virtual interface
+//--------------------------------------------------------------------------
+
+class Vehicle final : public MovingEntity
 {
 private:
 
@@ -37,11 +43,9 @@ private:
 	// steering behaviors make use of this - see Wander)
 	double m_dTimeElapsed;
 
-	// Buffer to the vehicle shape
-	std::vector<Vector2D> m_vecVehicleVB;
-
-	// Fills the buffer with vertex data
-	void InitializeBuffer();
+	// The position of this vehicle in the world's list of agents, which is
+	// also its element in the world's agent store
+	int m_iIndex;
 
 public:
 
@@ -64,12 +68,24 @@ public:
 
 	// Updates the vehicle's position and orientation
 	void Update(double timeElapsed) override;
+
+	// The two halves of Update. The world runs CalculateSteering for every
+	// vehicle before it integrates any of them, so every steering force is
+	// worked out from the same snapshot of the world
+	void CalculateSteering(double timeElapsed);
+	void Integrate();
+
+	// Integrates count vehicles. The loop is compiled alongside Integrate,
+	// so the compiler sees the call it makes and may inline it
+	static void IntegrateBatch(Vehicle* const* vehicles, size_t count);
 	
 	// Do not handle any specific message between vehicles
 	bool HandleMessage(const Telegram& msg) override { return false; };
 
 	// Renders the vehicle
+#ifndef HEADLESS
 	void Render() override;
+#endif
 
 	// Accessors methods
 	SteeringBehavior* const Steering() const { return m_pSteering; }
@@ -77,6 +93,10 @@ public:
 
 	Vector2D SmoothedHeading() const { return m_vSmoothedHeading; }
 	double TimeElapsed() const { return m_dTimeElapsed; }
+	void SetTimeElapsed(double timeElapsed) { m_dTimeElapsed = timeElapsed; }
+
+	int Index() const { return m_iIndex; }
+	void SetIndex(int index) { m_iIndex = index; }
 
 	bool IsSmoothingOn() const { return m_bSmoothingOn; }
 	void SmoothingOn() { m_bSmoothingOn = true; }
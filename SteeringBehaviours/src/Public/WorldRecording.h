@@ -0,0 +1,77 @@
+#pragma once
+
+#include <vector>
+#include <iosfwd>
+
+#include "Public/2D/Vector2D.h"
+
+//--------------------------------------------------------------------------
+// Everything needed to play a run of the world back exactly: the seed the
+// world was created with, the fixed time step it was stepped with, how many
+// steps it took and every input that reached it along the way.
+//
+// A replay only reproduces the original if the world is built from the
+// same params.ini. The number of threads doesn't matter
+//--------------------------------------------------------------------------
+
+struct WorldEvent
+{
+	enum EventType
+	{
+		ET_SetCrosshair,
+		ET_ToggleObstacles,
+		ET_ToggleWalls,
+		ET_ToggleSmoothing,
+		ET_ToggleSpacePartitioning,
+		ET_SetSummingMethod,
+		ET_CreateRandomPath
+	};
+
+	// The number of steps the world had taken when the event arrived
+	int m_iFrame;
+
+	EventType m_type;
+
+	// The summing method for ET_SetSummingMethod
+	int m_iValue;
+
+	// The proposed position for ET_SetCrosshair
+	Vector2D m_vPos;
+};
+
+class WorldRecording
+{
+private:
+
+	unsigned int m_iSeed;
+
+	double m_dTimeStep;
+
+	int m_iNumFrames;
+
+	// In the order they arrived
+	std::vector<WorldEvent> m_events;
+
+public:
+
+	WorldRecording() :m_iSeed(0), m_dTimeStep(0.0), m_iNumFrames(0) {}
+
+	// Forgets any events and starts again for a world with this seed
+	void Begin(unsigned int seed, double timeStep);
+
+	void AddEvent(const WorldEvent& event) { m_events.push_back(event); }
+
+	void SetNumFrames(int numFrames) { m_iNumFrames = numFrames; }
+
+	unsigned int Seed() const { return m_iSeed; }
+	double TimeStep() const { return m_dTimeStep; }
+	int NumFrames() const { return m_iNumFrames; }
+	const std::vector<WorldEvent>& Events() const { return m_events; }
+
+	// Plain text, one line per event. Doubles are written with enough digits
+	// to read back the identical value
+	void Write(std::ostream& os) const;
+
+	// Returns false if the stream doesn't hold a recording
+	bool Read(std::istream& is);
+};
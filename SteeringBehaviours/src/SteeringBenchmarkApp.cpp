@@ -0,0 +1,428 @@
+#include "Public/Constants.h"
+#include "Public/GameWorld.h"
+#include "Public/FlockingKernels.h"
+#include "Public/ParamLoader.h"
+#include "Public/Time/PrecisionTimer.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <cstddef>
+#include <cstdlib>
+#include <cstring>
+#include <iomanip>
+#include <iostream>
+#include <new>
+#include <sstream>
+#include <string>
+#include <vector>
+
+//--------------------------- Steering benchmark -------------------------------
+// Builds the shoal scene at several sizes and times world steps for every
+// combination of summing method, cell space partitioning, and obstacles with
+// walls. The world grows with the agent count so the crowd stays as dense as
+// in the default scene, and the cell grid and obstacle count grow with it.
+//
+// For each configuration it reports:
+//   ns/agent/step  the time one Step takes divided by the number of agents
+//   query ns       the cost of finding one agent's neighbors: a cell space
+//                  query with partitioning on, otherwise the sweep over every
+//                  agent that takes its place
+//   neighbors      how many neighbors such a query finds on average
+//   bytes/agent    heap memory the world holds once it has stepped, divided
+//                  by the number of agents
+//
+// Without partitioning every step is quadratic in the agent count, so those
+// configurations are skipped above --brute-force-limit agents.
+//
+// To compare float and double throughput, run the benchmark from a build
+// with AITECHNIQUES_FLOAT and from one without. The kernels named in the
+// output, and in the first CSV column, tell the two apart.
+//
+// Usage: SteeringBenchmark [--agents N,N,...] [--min-time seconds]
+//                          [--max-steps N] [--threads N]
+//                          [--brute-force-limit N] [--csv]
+//------------------------------------------------------------------------------
+
+//--------------------------- Heap accounting ----------------------------------
+// Everything allocated with new goes through these, including the chunks
+// of the arena a world keeps its agents in, so the bytes a world holds can
+// be counted. Memory taken straight from malloc is not. The size is kept in
+// front of each block
+//------------------------------------------------------------------------------
+
+static std::atomic<long long> g_iLiveBytes(0);
+
+static const size_t AllocationHeader = alignof(std::max_align_t);
+
+void* operator new(size_t size)
+{
+	char* block = (char*)std::malloc(size + AllocationHeader);
+
+	if (!block) throw std::bad_alloc();
+
+	*(size_t*)block = size;
+	g_iLiveBytes += (long long)size;
+
+	return block + AllocationHeader;
+}
+
+void operator delete(void* p) noexcept
+{
+	if (!p) return;
+
+	char* block = (char*)p - AllocationHeader;
+
+	g_iLiveBytes -= (long long)*(size_t*)block;
+
+	std::free(block);
+}
+
+void operator delete(void* p, size_t) noexcept
+{
+	operator delete(p);
+}
+
+//--------------------------- Options ------------------------------------------
+//------------------------------------------------------------------------------
+
+struct BenchmarkOptions
+{
+	std::vector<int> m_agentCounts = { 1000, 10000, 100000 };
+
+	// Each configuration steps until this much time has passed...
+	double m_dMinTime = 1.0;
+
+	// ...or it has taken this many steps, whichever comes first
+	int m_iMaxSteps = 1000;
+
+	// -1 keeps the thread count from params.ini
+	int m_iThreads = 1;
+
+	int m_iBruteForceLimit = 10000;
+
+	bool m_bCsv = false;
+};
+
+bool ParseAgentCounts(const char* list, std::vector<int>& counts)
+{
+	counts.clear();
+
+	std::stringstream ss(list);
+	std::string item;
+
+	while (std::getline(ss, item, ','))
+	{
+		const int count = std::atoi(item.c_str());
+
+		if (count < 2) return false;
+
+		counts.push_back(count);
+	}
+
+	return !counts.empty();
+}
+
+bool ParseOptions(int argc, char* argv[], BenchmarkOptions& options)
+{
+	for (int i = 1; i < argc; ++i)
+	{
+		const char* arg = argv[i];
+		const bool hasValue = i + 1 < argc;
+
+		if (std::strcmp(arg, "--agents") == 0 && hasValue)
+		{
+			if (!ParseAgentCounts(argv[++i], options.m_agentCounts)) return false;
+		}
+		else if (std::strcmp(arg, "--min-time") == 0 && hasValue)
+		{
+			options.m_dMinTime = std::atof(argv[++i]);
+		}
+		else if (std::strcmp(arg, "--max-steps") == 0 && hasValue)
+		{
+			options.m_iMaxSteps = std::atoi(argv[++i]);
+		}
+		else if (std::strcmp(arg, "--threads") == 0 && hasValue)
+		{
+			options.m_iThreads = std::atoi(argv[++i]);
+		}
+		else if (std::strcmp(arg, "--brute-force-limit") == 0 && hasValue)
+		{
+			options.m_iBruteForceLimit = std::atoi(argv[++i]);
+		}
+		else if (std::strcmp(arg, "--csv") == 0)
+		{
+			options.m_bCsv = true;
+		}
+		else
+		{
+			std::cerr << "Usage: " << argv[0] << " [--agents N,N,...] [--min-time seconds] [--max-steps N]"
+				<< " [--threads N] [--brute-force-limit N] [--csv]" << std::endl;
+			return false;
+		}
+	}
+
+	return options.m_iMaxSteps > 0;
+}
+
+//--------------------------- Benchmark ----------------------------------------
+//------------------------------------------------------------------------------
+
+struct BenchmarkConfig
+{
+	int m_iNumAgents;
+	SteeringBehavior::SummingMethod m_summingMethod;
+	bool m_bPartitioning;
+	bool m_bObstaclesAndWalls;
+};
+
+struct BenchmarkResult
+{
+	int m_iSteps;
+	double m_dNsPerAgentStep;
+	double m_dQueryNs;
+	double m_dNeighbors;
+	double m_dBytesPerAgent;
+};
+
+const char* SummingMethodName(SteeringBehavior::SummingMethod sm)
+{
+	switch (sm)
+	{
+	case SteeringBehavior::WeightedAverage: return "weighted";
+	case SteeringBehavior::Prioritized: return "prioritized";
+	case SteeringBehavior::Dithered: return "dithered";
+	default: return "unknown";
+	}
+}
+
+// Times neighbor queries for a sample of the agents
+void TimeQueries(GameWorld& world, bool partitioning, BenchmarkResult& result)
+{
+	const size_t numAgents = world.Agents().size();
+
+	// Enough queries to time reliably without the sweep taking forever at
+	// large agent counts
+	const size_t maxQueries = 2000;
+	const size_t stride = std::max<size_t>(1, numAgents / maxQueries);
+
+	std::vector<int> neighbors;
+	size_t numQueries = 0;
+	size_t numFound = 0;
+
+	PrecisionTimer timer;
+	timer.Start();
+
+	for (size_t a = 0; a < numAgents; a += stride)
+	{
+		if (partitioning)
+		{
+			world.CellSpace()->CalculateNeighborIndices(world.Agents()[a]->Pos(), Prm.ViewDistance(), neighbors);
+
+			// The query finds the agent itself too
+			numFound += neighbors.size() - 1;
+		}
+		else
+		{
+			FlockingSums sums;
+			AccumulateFlockingInRange(world.AgentState(), a, -1, Prm.ViewDistance(), sums);
+
+			numFound += sums.m_iCount;
+		}
+
+		++numQueries;
+	}
+
+	const double elapsed = timer.CurrentTime();
+
+	result.m_dQueryNs = elapsed * 1e9 / numQueries;
+	result.m_dNeighbors = (double)numFound / numQueries;
+}
+
+BenchmarkResult RunBenchmark(const BenchmarkConfig& config, const BenchmarkOptions& options)
+{
+	const double timeStep = 1.0 / 60.0;
+
+	// Grow the world so each agent has as much room as in the default scene
+	const double scale = std::sqrt((double)config.m_iNumAgents / Prm.NumAgents());
+
+	WorldSetup setup;
+	setup.m_iNumAgents = config.m_iNumAgents;
+	setup.m_iNumObstacles = (int)(Prm.NumObstacles() * scale * scale);
+	setup.m_iNumCellsX = std::max(1, (int)(Prm.NumCellsX() * scale));
+	setup.m_iNumCellsY = std::max(1, (int)(Prm.NumCellsY() * scale));
+
+	const long long bytesBefore = g_iLiveBytes;
+
+	GameWorld* world = new GameWorld((int)(CONST_WINDOW_WIDTH * scale), (int)(CONST_WINDOW_HEIGHT * scale), 0, setup);
+
+	if (options.m_iThreads >= 0)
+	{
+		world->SetNumThreads((unsigned int)options.m_iThreads);
+	}
+
+	world->SetSummingMethod(config.m_summingMethod);
+
+	if (config.m_bPartitioning)
+	{
+		world->ToggleSpacePartitioning();
+	}
+
+	if (config.m_bObstaclesAndWalls)
+	{
+		world->ToggleObstacles();
+		world->ToggleWalls();
+	}
+
+	// One step to let every buffer reach its working size before anything
+	// is measured
+	world->Step(timeStep);
+
+	BenchmarkResult result;
+	result.m_dBytesPerAgent = (double)(g_iLiveBytes - bytesBefore) / config.m_iNumAgents;
+
+	PrecisionTimer timer;
+	timer.Start();
+
+	double elapsed = 0.0;
+	int steps = 0;
+
+	while (steps < options.m_iMaxSteps && (steps == 0 || elapsed < options.m_dMinTime))
+	{
+		world->Step(timeStep);
+
+		++steps;
+		elapsed = timer.CurrentTime();
+	}
+
+	result.m_iSteps = steps;
+	result.m_dNsPerAgentStep = elapsed * 1e9 / ((double)steps * config.m_iNumAgents);
+
+	TimeQueries(*world, config.m_bPartitioning, result);
+
+	delete world;
+
+	return result;
+}
+
+//--------------------------- Output -------------------------------------------
+//------------------------------------------------------------------------------
+
+void PrintHeader(const BenchmarkOptions& options)
+{
+	if (options.m_bCsv)
+	{
+		std::cout << "kernels,agents,method,partitioning,obstacles,steps,ns_per_agent_step,query_ns,neighbors,bytes_per_agent" << std::endl;
+		return;
+	}
+
+	std::cout << std::left
+		<< std::setw(8) << "agents"
+		<< std::setw(13) << "method"
+		<< std::setw(7) << "cells"
+		<< std::setw(11) << "obstacles"
+		<< std::right
+		<< std::setw(7) << "steps"
+		<< std::setw(16) << "ns/agent/step"
+		<< std::setw(12) << "query ns"
+		<< std::setw(11) << "neighbors"
+		<< std::setw(13) << "bytes/agent"
+		<< std::endl;
+}
+
+void PrintResult(const BenchmarkConfig& config, const BenchmarkResult* result, const BenchmarkOptions& options)
+{
+	const char* cells = config.m_bPartitioning ? "on" : "off";
+	const char* obstacles = config.m_bObstaclesAndWalls ? "on" : "off";
+
+	if (options.m_bCsv)
+	{
+		std::cout << FlockingKernelName() << "," << config.m_iNumAgents << "," << SummingMethodName(config.m_summingMethod) << "," << cells << "," << obstacles;
+
+		if (result)
+		{
+			std::cout << "," << result->m_iSteps << "," << result->m_dNsPerAgentStep << "," << result->m_dQueryNs
+				<< "," << result->m_dNeighbors << "," << result->m_dBytesPerAgent;
+		}
+		else
+		{
+			std::cout << ",,,,,";
+		}
+
+		std::cout << std::endl;
+		return;
+	}
+
+	std::cout << std::left
+		<< std::setw(8) << config.m_iNumAgents
+		<< std::setw(13) << SummingMethodName(config.m_summingMethod)
+		<< std::setw(7) << cells
+		<< std::setw(11) << obstacles
+		<< std::right;
+
+	if (result)
+	{
+		std::cout << std::fixed
+			<< std::setw(7) << result->m_iSteps
+			<< std::setw(16) << std::setprecision(1) << result->m_dNsPerAgentStep
+			<< std::setw(12) << std::setprecision(1) << result->m_dQueryNs
+			<< std::setw(11) << std::setprecision(2) << result->m_dNeighbors
+			<< std::setw(13) << std::setprecision(0) << result->m_dBytesPerAgent
+			<< std::defaultfloat;
+	}
+	else
+	{
+		std::cout << "  skipped (above --brute-force-limit)";
+	}
+
+	std::cout << std::endl;
+}
+
+int main(int argc, char* argv[])
+{
+	BenchmarkOptions options;
+
+	if (!ParseOptions(argc, argv, options))
+	{
+		return 1;
+	}
+
+	const SteeringBehavior::SummingMethod methods[] = { SteeringBehavior::WeightedAverage, SteeringBehavior::Prioritized, SteeringBehavior::Dithered };
+
+	if (!options.m_bCsv)
+	{
+		std::cout << "kernels: " << FlockingKernelName() << std::endl;
+	}
+
+	PrintHeader(options);
+
+	for (unsigned int n = 0; n < options.m_agentCounts.size(); ++n)
+	{
+		for (int partitioning = 1; partitioning >= 0; --partitioning)
+		{
+			for (int obstacles = 0; obstacles <= 1; ++obstacles)
+			{
+				for (unsigned int m = 0; m < sizeof(methods) / sizeof(methods[0]); ++m)
+				{
+					BenchmarkConfig config;
+					config.m_iNumAgents = options.m_agentCounts[n];
+					config.m_summingMethod = methods[m];
+					config.m_bPartitioning = partitioning != 0;
+					config.m_bObstaclesAndWalls = obstacles != 0;
+
+					if (!config.m_bPartitioning && config.m_iNumAgents > options.m_iBruteForceLimit)
+					{
+						PrintResult(config, nullptr, options);
+						continue;
+					}
+
+					const BenchmarkResult result = RunBenchmark(config, options);
+
+					PrintResult(config, &result, options);
+				}
+			}
+		}
+	}
+
+	return 0;
+}
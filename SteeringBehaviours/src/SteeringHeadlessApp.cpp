@@ -0,0 +1,250 @@
+#include "Public/Constants.h"
+#include "Public/GameWorld.h"
+#include "Public/WorldRecording.h"
+#include "Public/FlockingKernels.h"
+#include "Public/ParamLoader.h"
+#include "Public/Misc/Utils.h"
+#include "Public/Misc/Profiler.h"
+#include "Public/Time/PrecisionTimer.h"
+
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <fstream>
+#include <string>
+
+//--------------------------- Headless driver ----------------------------------
+// Runs the simulation with no window and no rendering. The world is stepped
+// with a fixed time step as fast as the machine allows, so it is suitable for
+// batch runs and profiling.
+//
+// --record saves the run so --replay can repeat it exactly later. A replay
+// takes its seed, time step, step count and inputs from the file and ignores
+// the options that set them.
+//
+// --profile-csv, --profile-json and --trace write out what the profiler
+// recorded. They need a build with AITECHNIQUES_PROFILING switched on.
+//
+// Usage: SteeringHeadless [--steps N] [--dt seconds] [--seed S] [--partition]
+//                         [--threads N] [--record file | --replay file]
+//                         [--profile-csv file] [--profile-json file] [--trace file]
+//------------------------------------------------------------------------------
+
+struct HeadlessOptions
+{
+	int m_iSteps = 10000;
+	double m_dTimeStep = 1.0 / 60.0;
+	unsigned int m_iSeed = 0;
+	bool m_bPartitioning = false;
+
+	// -1 keeps the thread count from params.ini
+	int m_iThreads = -1;
+
+	std::string m_recordFile;
+	std::string m_replayFile;
+
+	std::string m_profileCsvFile;
+	std::string m_profileJsonFile;
+	std::string m_traceFile;
+};
+
+bool ParseOptions(int argc, char* argv[], HeadlessOptions& options)
+{
+	for (int i = 1; i < argc; ++i)
+	{
+		const char* arg = argv[i];
+		const bool hasValue = i + 1 < argc;
+
+		if (std::strcmp(arg, "--steps") == 0 && hasValue)
+		{
+			options.m_iSteps = std::atoi(argv[++i]);
+		}
+		else if (std::strcmp(arg, "--dt") == 0 && hasValue)
+		{
+			options.m_dTimeStep = std::atof(argv[++i]);
+		}
+		else if (std::strcmp(arg, "--seed") == 0 && hasValue)
+		{
+			options.m_iSeed = (unsigned int)std::strtoul(argv[++i], nullptr, 10);
+		}
+		else if (std::strcmp(arg, "--threads") == 0 && hasValue)
+		{
+			options.m_iThreads = std::atoi(argv[++i]);
+		}
+		else if (std::strcmp(arg, "--partition") == 0)
+		{
+			options.m_bPartitioning = true;
+		}
+		else if (std::strcmp(arg, "--record") == 0 && hasValue)
+		{
+			options.m_recordFile = argv[++i];
+		}
+		else if (std::strcmp(arg, "--replay") == 0 && hasValue)
+		{
+			options.m_replayFile = argv[++i];
+		}
+		else if (std::strcmp(arg, "--profile-csv") == 0 && hasValue)
+		{
+			options.m_profileCsvFile = argv[++i];
+		}
+		else if (std::strcmp(arg, "--profile-json") == 0 && hasValue)
+		{
+			options.m_profileJsonFile = argv[++i];
+		}
+		else if (std::strcmp(arg, "--trace") == 0 && hasValue)
+		{
+			options.m_traceFile = argv[++i];
+		}
+		else
+		{
+			std::cerr << "Usage: " << argv[0] << " [--steps N] [--dt seconds] [--seed S] [--partition] [--threads N]"
+				<< " [--record file | --replay file] [--profile-csv file] [--profile-json file] [--trace file]" << std::endl;
+			return false;
+		}
+	}
+
+	if (!options.m_recordFile.empty() && !options.m_replayFile.empty())
+	{
+		std::cerr << "--record and --replay can't be used together" << std::endl;
+		return false;
+	}
+
+	return options.m_iSteps > 0 && options.m_dTimeStep > 0.0;
+}
+
+bool WriteProfile(const std::string& file, void (Profiler::*write)(std::ostream&) const)
+{
+	if (file.empty()) return true;
+
+	std::ofstream out(file);
+	(Profiler::Instance()->*write)(out);
+
+	if (!out)
+	{
+		std::cerr << "Can't write the profile to " << file << std::endl;
+		return false;
+	}
+
+	return true;
+}
+
+int main(int argc, char* argv[])
+{
+	HeadlessOptions options;
+
+	if (!ParseOptions(argc, argv, options))
+	{
+		return 1;
+	}
+
+	WorldRecording recording;
+
+	if (!options.m_replayFile.empty())
+	{
+		std::ifstream in(options.m_replayFile);
+
+		if (!recording.Read(in))
+		{
+			std::cerr << "Can't read a recording from " << options.m_replayFile << std::endl;
+			return 1;
+		}
+
+		options.m_iSeed = recording.Seed();
+		options.m_dTimeStep = recording.TimeStep();
+		options.m_iSteps = recording.NumFrames();
+	}
+
+	GameWorld world(CONST_WINDOW_WIDTH, CONST_WINDOW_HEIGHT, options.m_iSeed);
+
+	world.SetFixedTimeStep(options.m_dTimeStep);
+
+	if (options.m_iThreads >= 0)
+	{
+		world.SetNumThreads((unsigned int)options.m_iThreads);
+	}
+
+#ifndef PROFILING
+	if (!options.m_profileCsvFile.empty() || !options.m_profileJsonFile.empty() || !options.m_traceFile.empty())
+	{
+		std::cerr << "Built without AITECHNIQUES_PROFILING, so the profile will be empty" << std::endl;
+	}
+#endif
+
+	// Only what happens from here on is of interest
+	Profiler::Instance()->Reset();
+	Profiler::Instance()->SetTracing(!options.m_traceFile.empty());
+
+	PrecisionTimer timer;
+	timer.Start();
+
+	if (!options.m_replayFile.empty())
+	{
+		world.Replay(recording);
+	}
+	else
+	{
+		if (!options.m_recordFile.empty())
+		{
+			world.StartRecording(&recording);
+		}
+
+		if (options.m_bPartitioning != world.IsSpacePartitioningOn())
+		{
+			world.ToggleSpacePartitioning();
+		}
+
+		for (int step = 0; step < options.m_iSteps; ++step)
+		{
+			world.Step(options.m_dTimeStep);
+		}
+
+		world.StopRecording();
+	}
+
+	const double elapsed = timer.CurrentTime();
+
+	if (!options.m_recordFile.empty())
+	{
+		std::ofstream out(options.m_recordFile);
+		recording.Write(out);
+
+		if (!out)
+		{
+			std::cerr << "Can't write the recording to " << options.m_recordFile << std::endl;
+			return 1;
+		}
+	}
+
+	if (!WriteProfile(options.m_profileCsvFile, &Profiler::WriteCsv) ||
+		!WriteProfile(options.m_profileJsonFile, &Profiler::WriteJson) ||
+		!WriteProfile(options.m_traceFile, &Profiler::WriteChromeTrace))
+	{
+		return 1;
+	}
+
+	// A digest of the final state, so runs can be compared with each other
+	unsigned long long checksum = 14695981039346656037ULL;
+
+	for (unsigned int a = 0; a < world.Agents().size(); ++a)
+	{
+		const Vector2D pos = world.Agents()[a]->Pos();
+		unsigned long long bits[2];
+
+		std::memcpy(bits, &pos.x, sizeof(double));
+		std::memcpy(bits + 1, &pos.y, sizeof(double));
+
+		checksum = (checksum ^ bits[0]) * 1099511628211ULL;
+		checksum = (checksum ^ bits[1]) * 1099511628211ULL;
+	}
+
+	std::cout << "agents: " << world.Agents().size()
+		<< " threads: " << world.NumThreads()
+		<< " kernels: " << FlockingKernelName()
+		<< " steps: " << options.m_iSteps
+		<< " seconds: " << elapsed
+		<< " steps/sec: " << (elapsed > 0.0 ? options.m_iSteps / elapsed : 0.0)
+		<< " checksum: " << std::hex << checksum << std::dec
+		<< std::endl;
+
+	return 0;
+}
@@ -2,6 +2,7 @@
 
 #include "Public/Constants.h"
 #include "Public/GameWorld.h"
+#include "Public/SteeringBehaviors.h"
 #include "Public/ParamLoader.h"
 #include "Public/Resource.h"
 #include "Public/Misc/Cgdi.h"
@@ -20,6 +21,141 @@ const char* g_szWindowClassName = "MyWindowClass";
 
 GameWorld* g_gameWorld;
 
+// Shared by each world in turn, so resetting with 'R' reuses the memory the
+// last world's agents were in
+Arena g_agentArena;
+
+//--------------------------- Menu and key handling ---------------------------
+// The world itself knows nothing about windows, menus or virtual key codes.
+// These helpers translate Win32 input into GameWorld operations and keep the
+// menu check marks in sync with the world state
+//------------------------------------------------------------------------------
+
+void HandleKeyPresses(WPARAM wParam)
+{
+	switch (wParam)
+	{
+		case 'U':
+			g_gameWorld->CreateRandomPath();
+			break;
+
+		case 'P':
+			g_gameWorld->TogglePause();
+			break;
+
+		case 'O':
+			g_gameWorld->ToggleRenderNeighbors();
+			break;
+
+		case 'I':
+			g_gameWorld->ToggleSmoothing();
+			break;
+
+		case 'Y':
+			g_gameWorld->ToggleObstacles();
+			break;
+
+		default:
+			break;
+	}
+}
+
+void ToggleSpacePartitioning(HWND hwnd)
+{
+	g_gameWorld->ToggleSpacePartitioning();
+
+	if (!g_gameWorld->IsSpacePartitioningOn())
+	{
+		ChangeMenuState(hwnd, IDR_PARTITIONING, MFS_UNCHECKED);
+		ChangeMenuState(hwnd, IDM_PARTITION_VIEW_NEIGHBORS, MFS_UNCHECKED);
+	}
+}
+
+void ToggleCellSpaceInfo(HWND hwnd)
+{
+	g_gameWorld->ToggleShowCellSpaceInfo();
+
+	if (g_gameWorld->ShowCellSpaceInfo())
+	{
+		ChangeMenuState(hwnd, IDM_PARTITION_VIEW_NEIGHBORS, MFS_CHECKED);
+
+		if (!g_gameWorld->IsSpacePartitioningOn())
+		{
+			SendMessage(hwnd, WM_COMMAND, IDR_PARTITIONING, NULL);
+		}
+	}
+	else
+	{
+		ChangeMenuState(hwnd, IDM_PARTITION_VIEW_NEIGHBORS, MFS_UNCHECKED);
+	}
+}
+
+void SetSummingMethod(HWND hwnd, SteeringBehavior::SummingMethod sm)
+{
+	ChangeMenuState(hwnd, IDR_WEIGHTED_SUM, sm == SteeringBehavior::WeightedAverage ? MFS_CHECKED : MFS_UNCHECKED);
+	ChangeMenuState(hwnd, IDR_PRIORITIZED, sm == SteeringBehavior::Prioritized ? MFS_CHECKED : MFS_UNCHECKED);
+	ChangeMenuState(hwnd, IDR_DITHERED, sm == SteeringBehavior::Dithered ? MFS_CHECKED : MFS_UNCHECKED);
+
+	g_gameWorld->SetSummingMethod(sm);
+}
+
+void HandleMenuItems(WPARAM wParam, HWND hwnd)
+{
+	switch (wParam)
+	{
+		case ID_OB_OBSTACLES:
+			g_gameWorld->ToggleObstacles();
+			CheckMenuItemAppropriately(hwnd, ID_OB_OBSTACLES, g_gameWorld->RenderObstacles());
+			break;
+
+		case ID_OB_WALLS:
+			g_gameWorld->ToggleWalls();
+			CheckMenuItemAppropriately(hwnd, ID_OB_WALLS, g_gameWorld->RenderWalls());
+			break;
+
+		case IDR_PARTITIONING:
+			ToggleSpacePartitioning(hwnd);
+			break;
+
+		case IDM_PARTITION_VIEW_NEIGHBORS:
+			ToggleCellSpaceInfo(hwnd);
+			break;
+
+		case IDR_WEIGHTED_SUM:
+			SetSummingMethod(hwnd, SteeringBehavior::WeightedAverage);
+			break;
+
+		case IDR_PRIORITIZED:
+			SetSummingMethod(hwnd, SteeringBehavior::Prioritized);
+			break;
+
+		case IDR_DITHERED:
+			SetSummingMethod(hwnd, SteeringBehavior::Dithered);
+			break;
+
+		case ID_VIEW_KEYS:
+			g_gameWorld->ToggleViewKeys();
+			CheckMenuItemAppropriately(hwnd, ID_VIEW_FPS, g_gameWorld->RenderFPS());
+			break;
+
+		case ID_VIEW_FPS:
+			g_gameWorld->ToogleShowFPS();
+			CheckMenuItemAppropriately(hwnd, ID_VIEW_FPS, g_gameWorld->RenderFPS());
+			break;
+
+		case ID_MENU_SMOOTHING:
+			if (g_gameWorld->Agents().size() > 0)
+			{
+				g_gameWorld->ToggleSmoothing();
+				CheckMenuItemAppropriately(hwnd, ID_MENU_SMOOTHING, g_gameWorld->IsSmoothingOn());
+			}
+			break;
+
+		default:
+			break;
+	}
+}
+
 //--------------------------- WindowsProc --------------------------------------
 // This is the callback function which handles all the windows messages
 //------------------------------------------------------------------------------
@@ -47,9 +183,6 @@ LRESULT CALLBACK WindowProc(HWND hwnd, UINT msg, WPARAM wParam, LPARAM lParam)
 			cxClient = rect.right;
 			cyClient = rect.bottom;
 
-			// Seed random number generator
-			srand((unsigned int)time(NULL));
-
 			// Create a surface to render to (backBuffer)
 
 			// Create a memory device context
@@ -66,7 +199,7 @@ LRESULT CALLBACK WindowProc(HWND hwnd, UINT msg, WPARAM wParam, LPARAM lParam)
 			// Don't forget to release the DC
 			ReleaseDC(hwnd, hdc);
 
-			g_gameWorld = new GameWorld(cxClient, cyClient);
+			g_gameWorld = new GameWorld(cxClient, cyClient, (unsigned int)time(NULL), WorldSetup(), &g_agentArena);
 
 			ChangeMenuState(hwnd, IDR_PRIORITIZED, MFS_CHECKED);
 			ChangeMenuState(hwnd, ID_VIEW_FPS, MFS_CHECKED);
@@ -76,14 +209,15 @@ LRESULT CALLBACK WindowProc(HWND hwnd, UINT msg, WPARAM wParam, LPARAM lParam)
 
 		case WM_COMMAND:
 		{
-			g_gameWorld->HandleMenuItems(wParam, hwnd);
+			HandleMenuItems(wParam, hwnd);
 		}
 
 		break;
 
 		case WM_LBUTTONUP:
 		{
-			g_gameWorld->SetCrosshair(MAKEPOINTS(lParam));
+			POINTS p = MAKEPOINTS(lParam);
+			g_gameWorld->SetCrosshair(Vector2D((double)p.x, (double)p.y));
 		}
 
 		break;
@@ -98,12 +232,12 @@ LRESULT CALLBACK WindowProc(HWND hwnd, UINT msg, WPARAM wParam, LPARAM lParam)
 			{
 				delete g_gameWorld;
 
-				g_gameWorld = new GameWorld(cxClient, cyClient);
+				g_gameWorld = new GameWorld(cxClient, cyClient, (unsigned int)time(NULL), WorldSetup(), &g_agentArena);
 			}
 			else
 			{
 				// Handle any others
-				g_gameWorld->HandleKeyPresses(wParam);
+				HandleKeyPresses(wParam);
 			}
 		}
 
@@ -0,0 +1,250 @@
+#include "Public/AgentStore.h"
+#include "Public/FlockingKernels.h"
+
+#include <algorithm>
+#include <cmath>
+#include <iostream>
+#include <limits>
+#include <random>
+#include <vector>
+
+//--------------------------- Flocking kernels test ----------------------------
+// Checks the compiled vector kernels against AccumulateFlockingScalar, for
+// stores of both precisions filled with random state.
+//
+// Neighbor lists and stores of every length up to a few vector widths are
+// tried, so each kernel's leftover neighbors go through its scalar tail at
+// every possible count. Some agents share positions, exactly the case where
+// separation has to be skipped.
+//
+// Every neighbor's terms come out the same in every version; only the order
+// they are added in differs. So each sum has to match to within a few ulps
+// of the sum of the sizes of its terms, and the neighbor counts exactly.
+//------------------------------------------------------------------------------
+
+namespace
+{
+	const double WorldSize = 100.0;
+	const double ViewDistance = 30.0;
+	const int MaxLength = 40;
+
+	template<class T>
+	double Tolerance() { return 64.0 * std::numeric_limits<T>::epsilon(); }
+
+	struct Checker
+	{
+		std::mt19937 m_rng;
+		int m_iCases = 0;
+		int m_iFailures = 0;
+
+		// The largest error seen, as a fraction of what is allowed
+		double m_dWorst = 0.0;
+
+		Checker() :m_rng(20240612) {}
+
+		double Uniform(double low, double high)
+		{
+			return std::uniform_real_distribution<double>(low, high)(m_rng);
+		}
+
+		int Index(int size)
+		{
+			return std::uniform_int_distribution<int>(0, size - 1)(m_rng);
+		}
+
+		// Random agents, about a quarter of them on top of an earlier one
+		template<class T>
+		void Fill(AgentStoreT<T>& store, size_t size)
+		{
+			store.Resize(size);
+
+			std::vector<Vector2D> positions;
+
+			for (size_t i = 0; i < size; ++i)
+			{
+				Vector2D pos(Uniform(0.0, WorldSize), Uniform(0.0, WorldSize));
+
+				if (!positions.empty() && Uniform(0.0, 1.0) < 0.25)
+				{
+					pos = positions[Index((int)positions.size())];
+				}
+
+				positions.push_back(pos);
+
+				const double angle = Uniform(0.0, 6.283185307179586);
+
+				store.StoreFlockingState(i, pos, Vector2D(std::cos(angle), std::sin(angle)), Uniform(1.0, 5.0));
+			}
+		}
+
+		// The sum of the sizes of the terms the kernels add up for these
+		// neighbors, which rounding errors scale with
+		template<class T>
+		FlockingSums Magnitudes(const AgentStoreT<T>& store, const std::vector<int>& neighbors, const Vector2D& pos)
+		{
+			FlockingSums magnitudes;
+
+			for (int n : neighbors)
+			{
+				magnitudes.m_dPosX += std::fabs(store.PosX()[n]);
+				magnitudes.m_dPosY += std::fabs(store.PosY()[n]);
+				magnitudes.m_dHeadingX += std::fabs(store.HeadingX()[n]);
+				magnitudes.m_dHeadingY += std::fabs(store.HeadingY()[n]);
+
+				const double length = Vec2DDistance(pos, store.Pos(n));
+
+				if (length > 0.0)
+				{
+					magnitudes.m_dSeparationX += 1.0 / length;
+					magnitudes.m_dSeparationY += 1.0 / length;
+				}
+			}
+
+			return magnitudes;
+		}
+
+		void CompareSum(double kernel, double scalar, double magnitude, double tolerance)
+		{
+			const double allowed = tolerance * magnitude;
+			const double error = std::fabs(kernel - scalar);
+
+			if (allowed > 0.0)
+			{
+				m_dWorst = std::max(m_dWorst, error / allowed);
+			}
+
+			if (error > allowed)
+			{
+				++m_iFailures;
+			}
+		}
+
+		template<class T>
+		void Compare(const char* what, size_t length, const FlockingSums& kernel, const FlockingSums& scalar, const FlockingSums& magnitudes)
+		{
+			const int failuresBefore = m_iFailures;
+
+			CompareSum(kernel.m_dPosX, scalar.m_dPosX, magnitudes.m_dPosX, Tolerance<T>());
+			CompareSum(kernel.m_dPosY, scalar.m_dPosY, magnitudes.m_dPosY, Tolerance<T>());
+			CompareSum(kernel.m_dHeadingX, scalar.m_dHeadingX, magnitudes.m_dHeadingX, Tolerance<T>());
+			CompareSum(kernel.m_dHeadingY, scalar.m_dHeadingY, magnitudes.m_dHeadingY, Tolerance<T>());
+			CompareSum(kernel.m_dSeparationX, scalar.m_dSeparationX, magnitudes.m_dSeparationX, Tolerance<T>());
+			CompareSum(kernel.m_dSeparationY, scalar.m_dSeparationY, magnitudes.m_dSeparationY, Tolerance<T>());
+
+			if (kernel.m_iCount != scalar.m_iCount)
+			{
+				++m_iFailures;
+			}
+
+			if (m_iFailures > failuresBefore && failuresBefore < 10)
+			{
+				std::cerr << what << " (" << (sizeof(T) == sizeof(float) ? "float" : "double") << ", length " << length
+					<< ") disagrees with the scalar kernel: count " << kernel.m_iCount << " vs " << scalar.m_iCount
+					<< ", separation " << kernel.m_dSeparationX << ", " << kernel.m_dSeparationY
+					<< " vs " << scalar.m_dSeparationX << ", " << scalar.m_dSeparationY << std::endl;
+			}
+
+			++m_iCases;
+		}
+
+		// AccumulateFlocking against AccumulateFlockingScalar, over neighbor
+		// lists of every length up to MaxLength, repeats included
+		template<class T>
+		void CheckNeighborLists()
+		{
+			AgentStoreT<T> store;
+			Fill(store, 64);
+
+			for (int length = 0; length <= MaxLength; ++length)
+			{
+				for (int trial = 0; trial < 8; ++trial)
+				{
+					std::vector<int> neighbors;
+
+					for (int i = 0; i < length; ++i)
+					{
+						neighbors.push_back(Index((int)store.Size()));
+					}
+
+					// Half the time stand exactly where one of the neighbors is
+					const Vector2D pos = (length > 0 && trial % 2 == 0)
+						? store.Pos(neighbors[Index(length)])
+						: Vector2D(Uniform(0.0, WorldSize), Uniform(0.0, WorldSize));
+
+					FlockingSums kernel;
+					AccumulateFlocking(store, neighbors.data(), neighbors.size(), pos, kernel);
+
+					FlockingSums scalar;
+					AccumulateFlockingScalar(store, neighbors.data(), neighbors.size(), pos, scalar);
+
+					Compare<T>("AccumulateFlocking", length, kernel, scalar, Magnitudes(store, neighbors, pos));
+				}
+			}
+		}
+
+		// AccumulateFlockingInRange against AccumulateFlockingScalar given the
+		// neighbors it should have found, over stores of every size up to
+		// MaxLength
+		template<class T>
+		void CheckInRange()
+		{
+			for (int size = 1; size <= MaxLength; ++size)
+			{
+				AgentStoreT<T> store;
+				Fill(store, size);
+
+				for (int trial = 0; trial < 8; ++trial)
+				{
+					const size_t self = Index(size);
+					const int exclude = trial % 2 == 0 ? -1 : Index(size);
+
+					// The same test as the kernel, in the same precision
+					const T x = store.PosX()[self];
+					const T y = store.PosY()[self];
+
+					std::vector<int> neighbors;
+
+					for (int n = 0; n < size; ++n)
+					{
+						if (n == (int)self || n == exclude) continue;
+
+						const T toX = x - store.PosX()[n];
+						const T toY = y - store.PosY()[n];
+						const T range = (T)ViewDistance + store.BRadius()[n];
+
+						if (toX * toX + toY * toY < range * range)
+						{
+							neighbors.push_back(n);
+						}
+					}
+
+					FlockingSums kernel;
+					AccumulateFlockingInRange(store, self, exclude, ViewDistance, kernel);
+
+					FlockingSums scalar;
+					AccumulateFlockingScalar(store, neighbors.data(), neighbors.size(), store.Pos(self), scalar);
+
+					Compare<T>("AccumulateFlockingInRange", size, kernel, scalar, Magnitudes(store, neighbors, store.Pos(self)));
+				}
+			}
+		}
+	};
+}
+
+int main()
+{
+	Checker checker;
+
+	checker.CheckNeighborLists<float>();
+	checker.CheckNeighborLists<double>();
+	checker.CheckInRange<float>();
+	checker.CheckInRange<double>();
+
+	std::cout << "kernels: " << FlockingKernelName()
+		<< " cases: " << checker.m_iCases
+		<< " failures: " << checker.m_iFailures
+		<< " worst error: " << checker.m_dWorst << " of tolerance"
+		<< std::endl;
+
+	return checker.m_iFailures == 0 ? 0 : 1;
+}
@@ -0,0 +1,214 @@
+#include "Public/AgentStore.h"
+#include "Public/FlockingKernels.h"
+
+#include <algorithm>
+#include <cmath>
+#include <iostream>
+#include <random>
+#include <vector>
+
+//--------------------------- Flocking precision test --------------------------
+// Checks that the float agent store steers the same as the double one.
+//
+// A snapshot of agents is put in a store of each precision, and every agent's
+// flocking force is worked out from both, through the same kernels and
+// finishing functions the steering behaviors use. The two must agree to
+// within Tolerance, relative to the size of the forces involved.
+//
+// Only a single step is compared. Whole runs diverge however small the
+// difference, since the simulation is chaotic.
+//------------------------------------------------------------------------------
+
+namespace
+{
+	const int NumAgents = 500;
+	const double WorldSize = 500.0;
+
+	// As in params.ini
+	const double ViewDistance = 50.0;
+	const double BRadius = 3.0;
+	const double MaxSpeed = 150.0;
+	const double SeparationWeight = 1.0;
+	const double AlignmentWeight = 1.0;
+	const double CohesionWeight = 2.0;
+
+	// Agents closer than this are pushed apart by separation long before the
+	// simulation gets there, and would only measure how badly 1 / distance
+	// amplifies rounding
+	const double MinSpacing = 1.0;
+
+	// No two agents are within this of the view range, so rounding can't
+	// change whether they are neighbors
+	const double BoundaryMargin = 1e-3;
+
+	const double Tolerance = 1e-4;
+
+	struct Snapshot
+	{
+		std::vector<Vector2D> m_pos;
+		std::vector<Vector2D> m_velocity;
+		std::vector<Vector2D> m_heading;
+	};
+
+	// Places the agents at random, keeping clear of MinSpacing and of the view
+	// range boundary
+	Snapshot MakeSnapshot(unsigned int seed)
+	{
+		std::mt19937 rng(seed);
+		std::uniform_real_distribution<double> coord(0.0, WorldSize);
+		std::uniform_real_distribution<double> angle(0.0, 6.283185307179586);
+		std::uniform_real_distribution<double> speed(0.0, MaxSpeed);
+
+		const double range = ViewDistance + BRadius;
+
+		Snapshot snapshot;
+
+		while ((int)snapshot.m_pos.size() < NumAgents)
+		{
+			const Vector2D pos(coord(rng), coord(rng));
+
+			bool clear = true;
+
+			for (const Vector2D& other : snapshot.m_pos)
+			{
+				const double distance = Vec2DDistance(pos, other);
+
+				if (distance < MinSpacing || std::fabs(distance - range) < BoundaryMargin)
+				{
+					clear = false;
+					break;
+				}
+			}
+
+			if (!clear) continue;
+
+			const double a = angle(rng);
+			const Vector2D heading(std::cos(a), std::sin(a));
+
+			snapshot.m_pos.push_back(pos);
+			snapshot.m_heading.push_back(heading);
+			snapshot.m_velocity.push_back(heading * speed(rng));
+		}
+
+		return snapshot;
+	}
+
+	template<class T>
+	void Fill(AgentStoreT<T>& store, const Snapshot& snapshot)
+	{
+		store.Resize(snapshot.m_pos.size());
+
+		for (size_t i = 0; i < snapshot.m_pos.size(); ++i)
+		{
+			store.StoreFlockingState(i, snapshot.m_pos[i], snapshot.m_heading[i], BRadius);
+		}
+	}
+
+	// The weighted flocking force, and the sum of the sizes of its parts as
+	// the scale errors are measured against
+	struct Force
+	{
+		Vector2D m_vForce;
+		double m_dScale;
+		int m_iCount;
+	};
+
+	Force Finish(const FlockingSums& sums, const Snapshot& snapshot, size_t a)
+	{
+		const Vector2D separation = FlockingSeparation(sums) * SeparationWeight;
+		const Vector2D alignment = FlockingAlignment(sums, snapshot.m_heading[a]) * AlignmentWeight;
+		const Vector2D cohesion = FlockingCohesion(sums, snapshot.m_pos[a], snapshot.m_velocity[a], MaxSpeed) * CohesionWeight;
+
+		Force force;
+		force.m_vForce = separation + alignment + cohesion;
+		force.m_dScale = separation.Length() + alignment.Length() + cohesion.Length();
+		force.m_iCount = sums.m_iCount;
+
+		return force;
+	}
+
+	template<class T>
+	Force InRangeForce(const AgentStoreT<T>& store, const Snapshot& snapshot, size_t a)
+	{
+		FlockingSums sums;
+		AccumulateFlockingInRange(store, a, -1, ViewDistance, sums);
+
+		return Finish(sums, snapshot, a);
+	}
+
+	template<class T>
+	Force NeighborListForce(const AgentStoreT<T>& store, const Snapshot& snapshot, size_t a, const std::vector<int>& neighbors)
+	{
+		FlockingSums sums;
+		AccumulateFlocking(store, neighbors.data(), neighbors.size(), snapshot.m_pos[a], sums);
+
+		return Finish(sums, snapshot, a);
+	}
+
+	// Returns the error of single relative to reference, or a negative value if
+	// they didn't even find the same neighbors
+	double RelativeError(const Force& reference, const Force& single)
+	{
+		if (reference.m_iCount != single.m_iCount) return -1.0;
+
+		const double error = Vec2DDistance(reference.m_vForce, single.m_vForce);
+
+		return reference.m_dScale > 0.0 ? error / reference.m_dScale : error;
+	}
+}
+
+int main()
+{
+	const Snapshot snapshot = MakeSnapshot(20240611);
+
+	AgentStoreT<double> doubles;
+	AgentStoreT<float> floats;
+
+	Fill(doubles, snapshot);
+	Fill(floats, snapshot);
+
+	const double range = ViewDistance + BRadius;
+
+	double worst = 0.0;
+	int failures = 0;
+
+	for (size_t a = 0; a < snapshot.m_pos.size(); ++a)
+	{
+		std::vector<int> neighbors;
+
+		for (size_t n = 0; n < snapshot.m_pos.size(); ++n)
+		{
+			if (n != a && Vec2DDistanceSq(snapshot.m_pos[a], snapshot.m_pos[n]) < range * range)
+			{
+				neighbors.push_back((int)n);
+			}
+		}
+
+		const double errors[] =
+		{
+			RelativeError(InRangeForce(doubles, snapshot, a), InRangeForce(floats, snapshot, a)),
+			RelativeError(NeighborListForce(doubles, snapshot, a, neighbors), NeighborListForce(floats, snapshot, a, neighbors))
+		};
+
+		for (double error : errors)
+		{
+			if (error < 0.0 || error > Tolerance)
+			{
+				if (failures++ < 10)
+				{
+					std::cerr << "agent " << a << ": float force off by " << error << " of its size" << std::endl;
+				}
+			}
+
+			worst = std::max(worst, error);
+		}
+	}
+
+	std::cout << "agents: " << snapshot.m_pos.size()
+		<< " kernels: " << FlockingKernelName()
+		<< " worst relative error: " << worst
+		<< " tolerance: " << Tolerance
+		<< std::endl;
+
+	return failures == 0 ? 0 : 1;
+}